@@ -0,0 +1,18 @@
+//
+//  AlignedAllocator.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "AlignedAllocator.hpp"
+
+namespace GE
+{
+namespace Core
+{
+
+template class TAlignedAllocator<std::byte, CacheLineSize>;
+
+}   // End of namespace Core
+}   // End of namespace GE
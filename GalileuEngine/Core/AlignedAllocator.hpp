@@ -0,0 +1,80 @@
+//
+//  AlignedAllocator.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// STD library includes.
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace GE
+{
+namespace Core
+{
+
+/** The size of a cache line on the platforms the engine targets. */
+constexpr size_t CacheLineSize = 64;
+
+/**
+ * A standard allocator returning memory aligned to TAlignment bytes, e.g. so that arrays of 16-byte vectors never straddle cache lines.
+ *
+ * @tparam T The type of the elements.
+ * @tparam TAlignment The alignment, a power of two at least alignof(T).
+ */
+template<typename T, size_t TAlignment>
+class TAlignedAllocator
+{
+public:
+    static_assert((TAlignment & (TAlignment - 1)) == 0, "The alignment must be a power of two.");
+    static_assert(TAlignment >= alignof(T), "The alignment cannot be weaker than the type's.");
+    
+    using value_type = T;
+    
+    template<typename TOther>
+    struct rebind
+    {
+        using other = TAlignedAllocator<TOther, TAlignment>;
+    };
+    
+public:
+    TAlignedAllocator() = default;
+    
+    template<typename TOther>
+    TAlignedAllocator(const TAlignedAllocator<TOther, TAlignment>&) {}
+    
+    /**
+     * Allocates room for the given number of elements, without constructing them.
+     *
+     * @param count The number of elements.
+     */
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{TAlignment}));
+    }
+    
+    /**
+     * Frees memory returned by allocate().
+     *
+     * @param elements The first element.
+     * @param count The number of elements given to allocate().
+     */
+    void deallocate(T* elements, size_t count)
+    {
+        ::operator delete(elements, count * sizeof(T), std::align_val_t{TAlignment});
+    }
+    
+    template<typename TOther>
+    bool operator==(const TAlignedAllocator<TOther, TAlignment>&) const { return true; }
+};
+
+/** A std::vector whose elements begin on a cache line. */
+template<typename T>
+using TCacheAlignedVector = std::vector<T, TAlignedAllocator<T, CacheLineSize>>;
+
+}   // End of namespace Core
+}   // End of namespace GE
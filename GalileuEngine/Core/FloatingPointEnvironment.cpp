@@ -0,0 +1,102 @@
+//
+//  FloatingPointEnvironment.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "FloatingPointEnvironment.hpp"
+
+// STD library includes.
+#if defined(__SSE2__)
+    #include <immintrin.h>
+#elif !defined(__aarch64__)
+    #include <cfenv>
+#endif
+
+namespace GE
+{
+namespace Core
+{
+
+namespace
+{
+
+#if defined(__SSE2__)
+/** The MXCSR bits that are not status flags: DAZ, the exception masks, the rounding mode and FTZ. */
+constexpr uint64_t ControlMask = 0xFFC0;
+
+/** The MXCSR control bits at startup: every exception masked, round to nearest. */
+constexpr uint64_t DefaultControl = 0x1F80;
+#elif defined(__aarch64__)
+/** FPCR holds no status flag. Zero is round to nearest, denormals kept, no trap. */
+constexpr uint64_t DefaultControl = 0;
+#else
+constexpr uint64_t DefaultControl = FE_TONEAREST;
+#endif
+
+uint64_t readControl()
+{
+#if defined(__SSE2__)
+    return _mm_getcsr() & ControlMask;
+#elif defined(__aarch64__)
+    uint64_t control;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(control));
+    return control;
+#else
+    return static_cast<uint64_t>(std::fegetround());
+#endif
+}
+
+void writeControl(uint64_t control)
+{
+#if defined(__SSE2__)
+    // Keep the status flags.
+    _mm_setcsr(static_cast<unsigned>((_mm_getcsr() & ~ControlMask) | control));
+#elif defined(__aarch64__)
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(control));
+#else
+    std::fesetround(static_cast<int>(control));
+#endif
+}
+
+}   // End of anonymous namespace
+
+FFloatingPointEnvironment FFloatingPointEnvironment::get()
+{
+    FFloatingPointEnvironment environment;
+    environment.Control = readControl();
+    return environment;
+}
+
+FFloatingPointEnvironment FFloatingPointEnvironment::getDefault()
+{
+    FFloatingPointEnvironment environment;
+    environment.Control = DefaultControl;
+    return environment;
+}
+
+void FFloatingPointEnvironment::set() const
+{
+    writeControl(Control);
+}
+
+FScopedFloatingPointEnvironment::FScopedFloatingPointEnvironment(const FFloatingPointEnvironment& environment)
+    : PreviousEnvironment{FFloatingPointEnvironment::get()}, IsChanged{!(environment == PreviousEnvironment)}
+{
+    if (IsChanged)
+    {
+        environment.set();
+    }
+}
+
+FScopedFloatingPointEnvironment::~FScopedFloatingPointEnvironment()
+{
+    if (IsChanged)
+    {
+        PreviousEnvironment.set();
+    }
+}
+
+}   // End of namespace Core
+}   // End of namespace GE
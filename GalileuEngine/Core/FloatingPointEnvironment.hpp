@@ -0,0 +1,67 @@
+//
+//  FloatingPointEnvironment.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// STD library includes.
+#include <cstdint>
+
+namespace GE
+{
+namespace Core
+{
+
+/**
+ * The per-thread settings changing the results of floating-point operations: the rounding mode and, where the hardware has them,
+ * the flushing of denormal results and inputs to zero (FTZ/DAZ on x86, FZ on ARM). Status flags, i.e. the exceptions raised so far, are not part of it.
+ * Each thread has its own, so the job system hands the scheduling thread's one to its jobs, see FJobSystem::run().
+ */
+class FFloatingPointEnvironment
+{
+public:
+    /** Returns the environment of the calling thread. */
+    static FFloatingPointEnvironment get();
+    
+    /** Returns the environment threads start with: round to nearest, denormals kept, every exception masked. */
+    static FFloatingPointEnvironment getDefault();
+    
+    /** Makes this environment the calling thread's one. */
+    void set() const;
+    
+    bool operator==(const FFloatingPointEnvironment&) const = default;
+    
+private:
+    /** Stores the control bits of the register holding the environment: MXCSR on x86, FPCR on ARM64, the rounding mode elsewhere. */
+    uint64_t Control = 0;
+};
+
+/**
+ * Sets a floating-point environment on the calling thread for its lifetime, then restores the previous one.
+ */
+class FScopedFloatingPointEnvironment
+{
+public:
+    /**
+     * @param environment The environment to set until this object is destroyed.
+     */
+    explicit FScopedFloatingPointEnvironment(const FFloatingPointEnvironment& environment);
+    
+    ~FScopedFloatingPointEnvironment();
+    
+    FScopedFloatingPointEnvironment(const FScopedFloatingPointEnvironment&) = delete;
+    FScopedFloatingPointEnvironment& operator=(const FScopedFloatingPointEnvironment&) = delete;
+    
+private:
+    /** Stores the environment to restore. */
+    const FFloatingPointEnvironment PreviousEnvironment;
+    
+    /** Indicates whether the environment had to be changed. */
+    const bool IsChanged;
+};
+
+}   // End of namespace Core
+}   // End of namespace GE
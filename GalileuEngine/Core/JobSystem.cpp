@@ -0,0 +1,315 @@
+//
+//  JobSystem.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "JobSystem.hpp"
+
+// GE includes.
+#include "UtilMacros.hpp"
+
+// STD library includes.
+#include <utility>
+
+namespace GE
+{
+namespace Core
+{
+
+namespace
+{
+
+/** Stores the system the calling thread is a worker of, if any. */
+thread_local const FJobSystem* CurrentJobSystem = nullptr;
+
+/** Stores the calling worker's index inside CurrentJobSystem. */
+thread_local size_t CurrentWorkerIndex = 0;
+
+/** Stores the job the calling thread is running, if any, so it becomes the parent of new jobs. */
+thread_local void* CurrentJob = nullptr;
+
+/** Stores the system CurrentJob belongs to. */
+thread_local const FJobSystem* CurrentJobOwner = nullptr;
+
+}   // End of anonymous namespace
+
+FJobSystem::FJobSystem(unsigned numberOfWorkers)
+{
+    for (unsigned queueIndex = 0; queueIndex <= numberOfWorkers; ++queueIndex)
+    {
+        Queues.push_back(std::make_unique<FJobQueue>());
+    }
+    
+    for (unsigned workerIndex = 0; workerIndex < numberOfWorkers; ++workerIndex)
+    {
+        Workers.emplace_back(&FJobSystem::runWorker, this, workerIndex);
+    }
+}
+
+FJobSystem::~FJobSystem()
+{
+    // Jobs might still be queued when there are no workers.
+    while (FJob* job = pop())
+    {
+        execute(job);
+    }
+    
+    {
+        std::lock_guard lock{SleepMutex};
+        IsStopping = true;
+    }
+    WakeCondition.notify_all();
+    
+    for (std::thread& worker : Workers)
+    {
+        worker.join();
+    }
+}
+
+unsigned FJobSystem::getNumberOfWorkers() const
+{
+    return static_cast<unsigned>(Workers.size());
+}
+
+void FJobSystem::run(FJobFunction function, FJobCounter* counter)
+{
+    FJob* const parent = (CurrentJobOwner == this) ? static_cast<FJob*>(CurrentJob) : nullptr;
+    FJob* const job = new FJob{ .Function = std::move(function), .Parent = parent, .Counter = counter, .Environment = FFloatingPointEnvironment::get(), .NumberOfUnfinishedJobs = 1 };
+    
+    if (parent != nullptr)
+    {
+        parent->NumberOfUnfinishedJobs.fetch_add(1);
+    }
+    
+    if (counter != nullptr)
+    {
+        counter->NumberOfUnfinishedJobs.fetch_add(1);
+    }
+    
+    push(job);
+}
+
+void FJobSystem::wait(FJobCounter& counter)
+{
+    while (!counter.isDone())
+    {
+        if (FJob* job = pop())
+        {
+            execute(job);
+        }
+        else
+        {
+            // The remaining jobs are running on other threads.
+            std::this_thread::yield();
+        }
+    }
+    
+    if (counter.HasException.load(std::memory_order_relaxed))
+    {
+        counter.HasException = false;
+        std::rethrow_exception(std::exchange(counter.Exception, nullptr));
+    }
+}
+
+void FJobSystem::parallelFor(size_t count, size_t grainSize, const FRangeTask& task)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    
+    // A few chunks per thread balance the load when chunks take different times.
+    constexpr size_t numberOfChunksPerThread = 4;
+    const size_t numberOfThreads = getNumberOfWorkers() + 1;
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t numberOfGrains = (count + grainSize - 1) / grainSize;
+    const size_t numberOfGrainsPerChunk = std::max<size_t>(1, numberOfGrains / (numberOfThreads * numberOfChunksPerThread));
+    const size_t chunkSize = numberOfGrainsPerChunk * grainSize;
+    
+    // Not worth creating jobs?
+    if (Workers.empty() || (chunkSize >= count))
+    {
+        task(0, count);
+        return;
+    }
+    
+    FJobCounter counter;
+    for (size_t begin = 0; begin < count; begin += chunkSize)
+    {
+        const size_t end = std::min(begin + chunkSize, count);
+        run([&task, begin, end]{ task(begin, end); }, &counter);
+    }
+    wait(counter);
+}
+
+void FJobSystem::runWorker(unsigned workerIndex)
+{
+    CurrentJobSystem = this;
+    CurrentWorkerIndex = workerIndex;
+    
+    while (true)
+    {
+        if (FJob* job = pop())
+        {
+            execute(job);
+            continue;
+        }
+        
+        std::unique_lock lock{SleepMutex};
+        NumberOfSleepingWorkers.fetch_add(1);
+        WakeCondition.wait(lock, [this]{ return IsStopping || (NumberOfQueuedJobs.load() > 0); });
+        NumberOfSleepingWorkers.fetch_sub(1);
+        
+        if (IsStopping && (NumberOfQueuedJobs.load() == 0))
+        {
+            return;
+        }
+    }
+}
+
+void FJobSystem::push(FJob* job)
+{
+    FJobQueue& queue = *Queues[getQueueIndex()];
+    {
+        std::lock_guard lock{queue.Mutex};
+        queue.Jobs.push_back(job);
+    }
+    NumberOfQueuedJobs.fetch_add(1);
+    
+    // A worker checks for jobs after announcing it is going to sleep, so either it sees this job or it is seen here.
+    if (NumberOfSleepingWorkers.load() > 0)
+    {
+        {
+            // Do not notify between the worker checking for jobs and actually sleeping.
+            std::lock_guard lock{SleepMutex};
+        }
+        WakeCondition.notify_one();
+    }
+}
+
+FJobSystem::FJob* FJobSystem::pop()
+{
+    if (NumberOfQueuedJobs.load() == 0)
+    {
+        return nullptr;
+    }
+    
+    const size_t ownQueueIndex = getQueueIndex();
+    const size_t sharedQueueIndex = Queues.size() - 1;
+    
+    const auto tryPop = [this](size_t queueIndex, bool isBack) -> FJob*
+    {
+        FJobQueue& queue = *Queues[queueIndex];
+        std::lock_guard lock{queue.Mutex};
+        if (queue.Jobs.empty())
+        {
+            return nullptr;
+        }
+        
+        FJob* job = nullptr;
+        if (isBack)
+        {
+            job = queue.Jobs.back();
+            queue.Jobs.pop_back();
+        }
+        else
+        {
+            job = queue.Jobs.front();
+            queue.Jobs.pop_front();
+        }
+        NumberOfQueuedJobs.fetch_sub(1);
+        return job;
+    };
+    
+    // Own jobs first, the most recent one.
+    if (FJob* job = tryPop(ownQueueIndex, ownQueueIndex != sharedQueueIndex))
+    {
+        return job;
+    }
+    
+    // Then the shared ones, the oldest one.
+    if (ownQueueIndex != sharedQueueIndex)
+    {
+        if (FJob* job = tryPop(sharedQueueIndex, false))
+        {
+            return job;
+        }
+    }
+    
+    // Then steal the oldest job of another worker, starting by the next one.
+    const size_t numberOfWorkers = Workers.size();
+    for (size_t offset = 1; offset <= numberOfWorkers; ++offset)
+    {
+        const size_t queueIndex = (ownQueueIndex + offset) % (numberOfWorkers + 1);
+        if (queueIndex != sharedQueueIndex)
+        {
+            if (FJob* job = tryPop(queueIndex, false))
+            {
+                return job;
+            }
+        }
+    }
+    
+    return nullptr;
+}
+
+void FJobSystem::execute(FJob* job)
+{
+    void* const previousJob = CurrentJob;
+    const FJobSystem* const previousJobOwner = CurrentJobOwner;
+    CurrentJob = job;
+    CurrentJobOwner = this;
+    try
+    {
+        const FScopedFloatingPointEnvironment scopedEnvironment{job->Environment};
+        job->Function();
+    }
+    catch (...)
+    {
+        // Hand it to the closest counter. The first exception wins, the others are dropped.
+        for (FJob* owner = job; owner != nullptr; owner = owner->Parent)
+        {
+            if (owner->Counter != nullptr)
+            {
+                if (!owner->Counter->HasException.exchange(true))
+                {
+                    owner->Counter->Exception = std::current_exception();
+                }
+                break;
+            }
+        }
+    }
+    CurrentJob = previousJob;
+    CurrentJobOwner = previousJobOwner;
+    
+    finish(job);
+}
+
+void FJobSystem::finish(FJob* job)
+{
+    while ((job != nullptr) && (job->NumberOfUnfinishedJobs.fetch_sub(1) == 1))
+    {
+        FJob* const parent = job->Parent;
+        FJobCounter* const counter = job->Counter;
+        
+        // Destroy the function before signalling, since it may capture objects owned by the waiting thread.
+        delete job;
+        
+        if (counter != nullptr)
+        {
+            counter->NumberOfUnfinishedJobs.fetch_sub(1, std::memory_order_release);
+        }
+        
+        job = parent;
+    }
+}
+
+size_t FJobSystem::getQueueIndex() const
+{
+    return (CurrentJobSystem == this) ? CurrentWorkerIndex : Queues.size() - 1;
+}
+
+}   // End of namespace Core
+}   // End of namespace GE
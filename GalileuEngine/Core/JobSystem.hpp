@@ -0,0 +1,186 @@
+//
+//  JobSystem.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "FloatingPointEnvironment.hpp"
+
+// STD library includes.
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+namespace GE
+{
+namespace Core
+{
+
+/**
+ * Counts the jobs that are not finished yet among the ones it has been given to. See FJobSystem::run() and FJobSystem::wait().
+ * It also keeps the first exception thrown by these jobs or their children, for wait() to rethrow.
+ */
+class FJobCounter
+{
+public:
+    FJobCounter() = default;
+    FJobCounter(const FJobCounter&) = delete;
+    FJobCounter& operator=(const FJobCounter&) = delete;
+    
+    /** Checks whether all the jobs this counter has been given to are finished. */
+    bool isDone() const { return NumberOfUnfinishedJobs.load(std::memory_order_acquire) == 0; }
+    
+private:
+    friend class FJobSystem;
+    
+    std::atomic<uint32_t> NumberOfUnfinishedJobs{0};
+    
+    /** Indicates whether Exception has been claimed by a failing job. */
+    std::atomic<bool> HasException{false};
+    
+    /** Stores the first exception thrown. It is written before the job finishes, so it is visible once the counter is done. */
+    std::exception_ptr Exception;
+};
+
+/**
+ * The engine's task scheduler. It runs jobs, i.e. small functions, on a set of persistent worker threads.
+ *
+ * Each worker owns a double-ended queue: it pushes and pops its own jobs at the back (most recent first, which is cache friendly), while idle workers steal the oldest jobs from the front of the other queues.
+ * Jobs created by threads that are not workers go to a shared queue.
+ * A job created while another job is running becomes its child: the parent is not finished until all its children are.
+ * Threads waiting for a counter run pending jobs meanwhile, so waiting from inside a job does not block a worker.
+ * Hence jobs must be short: a job that never returns, e.g. a game loop, belongs on its own thread, or it could take over any waiting thread.
+ * An exception thrown by a job is rethrown by wait() for the closest counter among the job and its ancestors, and dropped if there is none.
+ * Jobs run with the floating-point environment of the thread that scheduled them, so their results do not depend on which thread runs them.
+ */
+class FJobSystem
+{
+public:
+    /** The signature of a job. */
+    using FJobFunction = std::function<void()>;
+    
+    /** The signature of a parallelFor() task: it processes the elements in the range [begin, end). */
+    using FRangeTask = std::function<void(size_t begin, size_t end)>;
+    
+public:
+    /**
+     * Spawns the worker threads.
+     *
+     * @param numberOfWorkers The number of worker threads. It can be zero, then jobs only run when some thread waits for them. By default, one per hardware thread but the calling one, and at least one.
+     */
+    explicit FJobSystem(unsigned numberOfWorkers = std::max(2u, std::thread::hardware_concurrency()) - 1);
+    
+    /**
+     * Runs the remaining jobs, then stops and joins the worker threads.
+     */
+    ~FJobSystem();
+    
+    FJobSystem(const FJobSystem&) = delete;
+    FJobSystem& operator=(const FJobSystem&) = delete;
+    
+    /** Returns the number of worker threads. */
+    unsigned getNumberOfWorkers() const;
+    
+    /**
+     * Schedules a job. When called from a running job, the new job becomes a child of it.
+     * The job runs with the calling thread's floating-point environment, e.g. its rounding mode and denormal flushing.
+     *
+     * @param function The job.
+     * @param counter If not null, it counts this job until it, and all its children, are finished. It must outlive the job.
+     */
+    void run(FJobFunction function, FJobCounter* counter = nullptr);
+    
+    /**
+     * Returns once the counter reaches zero, running pending jobs in the meantime.
+     * Then, if one of its jobs has thrown, it rethrows the first exception, which the counter no longer keeps.
+     *
+     * @param counter The counter to wait for.
+     */
+    void wait(FJobCounter& counter);
+    
+    /**
+     * Splits the range [0, count) in chunks, runs the task for each one of them as a job, then waits for all of them.
+     *
+     * @param count The number of elements.
+     * @param grainSize Chunk boundaries are multiples of it (except for the last one), e.g. the SIMD batch size.
+     * @param task The task to run for each chunk.
+     */
+    void parallelFor(size_t count, size_t grainSize, const FRangeTask& task);
+    
+private:
+    struct FJob
+    {
+        FJobFunction Function;
+        
+        /** The job that was running when this one was created, if any. */
+        FJob* Parent;
+        
+        FJobCounter* Counter;
+        
+        /** The floating-point environment of the thread that created the job. */
+        FFloatingPointEnvironment Environment;
+        
+        /** Stores one for the job itself plus one per unfinished child. */
+        std::atomic<uint32_t> NumberOfUnfinishedJobs;
+    };
+    
+    /** A queue of jobs. Its owner uses the back, thieves use the front. */
+    struct FJobQueue
+    {
+        std::mutex Mutex;
+        std::deque<FJob*> Jobs;
+    };
+    
+private:
+    /** The loop run by each worker thread. */
+    void runWorker(unsigned workerIndex);
+    
+    /** Adds a job to the calling worker's queue, or to the shared one. */
+    void push(FJob* job);
+    
+    /** Takes a job from the calling worker's queue, otherwise from the shared one, otherwise steals one. Returns null if there is none. */
+    FJob* pop();
+    
+    /** Runs a job, then finishes it, even if it throws. */
+    void execute(FJob* job);
+    
+    /** Accounts for the end of the job itself or one of its children. The last one deletes the job and signals its counter and parent. */
+    void finish(FJob* job);
+    
+    /** Returns the index of the calling worker's queue, or the shared queue's one if the caller is not a worker of this system. */
+    size_t getQueueIndex() const;
+    
+private:
+    /** Stores one queue per worker, followed by the shared one. */
+    std::vector<std::unique_ptr<FJobQueue>> Queues;
+    
+    std::vector<std::thread> Workers;
+    
+    /** Stores the number of jobs waiting in the queues. */
+    std::atomic<size_t> NumberOfQueuedJobs{0};
+    
+    /** Stores the number of workers sleeping (or about to) because there was no job. */
+    std::atomic<unsigned> NumberOfSleepingWorkers{0};
+    
+    std::mutex SleepMutex;
+    std::condition_variable WakeCondition;
+    
+    /** Indicates whether workers should return. */
+    std::atomic<bool> IsStopping{false};
+};
+
+}   // End of namespace Core
+}   // End of namespace GE
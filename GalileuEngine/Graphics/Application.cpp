@@ -222,6 +222,39 @@ void FApplication::run()
     {
         std::cerr << "Crash -- Vulkan application has launched an exception\n - " << exception.what() << std::endl;
     }
+    
+    // In case of an early exception, the texture file job might still be running, or its pixels might be unused.
+    waitForJobs(TextureFileCounter);
+    if (TextureFile.Pixels != nullptr)
+    {
+        stbi_image_free(TextureFile.Pixels);
+        TextureFile.Pixels = nullptr;
+    }
+}
+
+FApplication::FApplication(Core::FJobSystem* jobSystem)
+    : JobSystem{jobSystem}
+{
+}
+
+void FApplication::runJob(std::function<void()> job, Core::FJobCounter& counter)
+{
+    if (JobSystem != nullptr)
+    {
+        JobSystem->run(std::move(job), &counter);
+    }
+    else
+    {
+        job();
+    }
+}
+
+void FApplication::waitForJobs(Core::FJobCounter& counter)
+{
+    if (JobSystem != nullptr)
+    {
+        JobSystem->wait(counter);
+    }
 }
 
 void FApplication::initWindow()
@@ -244,6 +277,9 @@ void FApplication::initWindow()
 
 void FApplication::initVulkan()
 {
+    // Decode the texture file in the background while the other Vulkan objects are created.
+    runJob([this]{ loadTextureFile(); }, TextureFileCounter);
+    
     createInstance();
     setupDebugMessenger();
     createSurface();
@@ -964,16 +1000,28 @@ void FApplication::createGraphicsPipeline()
         {DefaultSourceFragmentShaderName, shaderc_fragment_shader, VK_SHADER_STAGE_FRAGMENT_BIT},
     };
     
+    // Read and compile the shaders concurrently, since compiling is slow. Exceptions are rethrown by waitForJobs().
+    std::vector<std::vector<uint32_t>> spirvCodes(shaders.size());
+    Core::FJobCounter shaderCounter;
+    for (size_t shaderIndex = 0; shaderIndex < shaders.size(); ++shaderIndex)
+    {
+        runJob([&, shaderIndex]
+        {
+            const FShaderInfo& shaderInfo = shaders[shaderIndex];
+            const std::string shaderCode = readFile(DefaultSourceShaderFolder + shaderInfo.shaderName);
+            spirvCodes[shaderIndex] = compileShader(shaderCode, shaderInfo);
+        }, shaderCounter);
+    }
+    waitForJobs(shaderCounter);
+    
     std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
-    for (const FShaderInfo& shaderInfo: shaders)
+    for (size_t shaderIndex = 0; shaderIndex < shaders.size(); ++shaderIndex)
     {
-        const std::string shaderCode = readFile(DefaultSourceShaderFolder + shaderInfo.shaderName);
-
         VkPipelineShaderStageCreateInfo shaderStage =
         {
             .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .stage = shaderInfo.stage,
-            .module = createShaderModule(compileShader(shaderCode, shaderInfo)),
+            .stage = shaders[shaderIndex].stage,
+            .module = createShaderModule(spirvCodes[shaderIndex]),
             .pName = "main",
         };
         
@@ -1359,20 +1407,24 @@ void FApplication::transitionImageLayout(VkImage image, VkFormat format, VkImage
     });
 }
 
-void FApplication::createTextureImage()
+void FApplication::loadTextureFile()
 {
-    // Load the texture file:
-    int outTextureWidth;
-    int outTextureHeight;
-    int outTextureChannels;
     const std::string pathname = DefaultTextureFolder + DefaultTextureName;
-    stbi_uc* pixels = stbi_load(pathname.c_str(), &outTextureWidth, &outTextureHeight, &outTextureChannels, STBI_rgb_alpha);
+    TextureFile.Pixels = stbi_load(pathname.c_str(), &TextureFile.Width, &TextureFile.Height, &TextureFile.Channels, STBI_rgb_alpha);
+}
+
+void FApplication::createTextureImage()
+{
+    // Wait for the texture file, which has been loading since initVulkan() started:
+    waitForJobs(TextureFileCounter);
+    stbi_uc* pixels = TextureFile.Pixels;
+    TextureFile.Pixels = nullptr;
     if (pixels == nullptr)
     {
         throw std::runtime_error("Failed to texture file!");
     }
-    const int textureWidth = outTextureWidth;
-    const int textureHeight = outTextureHeight;
+    const int textureWidth = TextureFile.Width;
+    const int textureHeight = TextureFile.Height;
     constexpr int numBytesPerPixels = 4;        // Number depends on STBI_rgb_alpha: R + G + A + Alpha.
     const VkDeviceSize imageSize = textureWidth * textureHeight * numBytesPerPixels;
     
@@ -9,6 +9,7 @@
 
 // Project-wise includes.
 #include "UtilMacros.hpp"
+#include "JobSystem.hpp"
 
 // GLFW includes.
 #define VK_USE_PLATFORM_MACOS_MVK
@@ -45,6 +46,13 @@ concept CCallableWithVkCommandBuffer = requires(TFunctional functional, VkComman
 class FApplication
 {
 public:     // Exposed API.
+    /**
+     * The constructor.
+     *
+     * @param jobSystem The job system used to load assets in the background. Without one, they are loaded by the calling thread.
+     */
+    explicit FApplication(Core::FJobSystem* jobSystem = nullptr);
+    
     /** The function to be called in order to show the rendering window. */
     void run();
     
@@ -175,6 +183,15 @@ private:    // Internal API.
     /** A helper function useful for changing image layout.  */
     void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
     
+    /** Runs the job on the job system, or right away if there is none. */
+    void runJob(std::function<void()> job, Core::FJobCounter& counter);
+    
+    /** Waits for the jobs given to the counter, if there is a job system, and rethrows the first exception they threw. */
+    void waitForJobs(Core::FJobCounter& counter);
+    
+    /** Decodes the texture file into TextureFile. It runs as a job, so it must not throw. */
+    void loadTextureFile();
+    
     /** Create the texture image example. */
     void createTextureImage();
     
@@ -278,6 +295,22 @@ private:    // Static const data.
     
 private:    // Private data
     bool IsValidationLayerOn = TRUE_IF_GE_BUILD_DEBUG;
+    
+    /** The job system used to load assets, if any. */
+    Core::FJobSystem* JobSystem;
+    
+    /** The decoded texture file, filled in by loadTextureFile(). */
+    struct FTextureFile
+    {
+        unsigned char* Pixels = nullptr;
+        int Width = 0;
+        int Height = 0;
+        int Channels = 0;
+    } TextureFile;
+    
+    /** Counts the job running loadTextureFile(). */
+    Core::FJobCounter TextureFileCounter;
+    
     GLFWwindow* Window;
     VkSurfaceKHR Surface;
     
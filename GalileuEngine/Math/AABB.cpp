@@ -0,0 +1,8 @@
+//
+//  AABB.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "AABB.hpp"
@@ -0,0 +1,102 @@
+//
+//  AABB.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Precision.hpp"
+#include "Math.hpp"
+#include "Vector3.hpp"
+#include "UtilMacros.hpp"
+
+// STD library includes.
+#include <algorithm>
+
+namespace GE
+{
+namespace Math
+{
+
+/**
+ * An axis-aligned bounding box.
+ */
+class FAABB
+{
+public:
+    /** Stores the corner with the smallest coordinates. */
+    FVector3 Min;
+    
+    /** Stores the corner with the largest coordinates. */
+    FVector3 Max;
+    
+public:
+    /**
+     * Default constructor (no initialization).
+     */
+    FORCE_INLINE FAABB() {}
+    
+    /**
+     * Constructor using the two corners.
+     *
+     * @param min The corner with the smallest coordinates.
+     * @param max The corner with the largest coordinates.
+     */
+    FORCE_INLINE FAABB(const FVector3& min, const FVector3& max) : Min(min), Max(max) {}
+    
+    /**
+     * Creates the box that bounds a sphere.
+     *
+     * @param center The center of the sphere.
+     * @param radius The radius of the sphere.
+     */
+    FORCE_INLINE static FAABB makeFromSphere(const FVector3& center, FReal radius)
+    {
+        const FVector3 extent{radius};
+        return FAABB{center - extent, center + extent};
+    }
+    
+    /** Returns the smallest box containing both boxes. */
+    FORCE_INLINE static FAABB merge(const FAABB& first, const FAABB& second)
+    {
+        return FAABB{
+            FVector3{std::min(first.Min.X, second.Min.X), std::min(first.Min.Y, second.Min.Y), std::min(first.Min.Z, second.Min.Z)},
+            FVector3{std::max(first.Max.X, second.Max.X), std::max(first.Max.Y, second.Max.Y), std::max(first.Max.Z, second.Max.Z)}};
+    }
+    
+    /** Returns this box grown by the given margin on every side. */
+    FORCE_INLINE FAABB fatten(FReal margin) const
+    {
+        const FVector3 extent{margin};
+        return FAABB{Min - extent, Max + extent};
+    }
+    
+    /** Returns whether this box and the given one overlap. Touching boxes overlap. */
+    FORCE_INLINE bool overlaps(const FAABB& box) const
+    {
+        return (Min.X <= box.Max.X) && (box.Min.X <= Max.X)
+            && (Min.Y <= box.Max.Y) && (box.Min.Y <= Max.Y)
+            && (Min.Z <= box.Max.Z) && (box.Min.Z <= Max.Z);
+    }
+    
+    /** Returns whether the given box is inside this one. */
+    FORCE_INLINE bool contains(const FAABB& box) const
+    {
+        return (Min.X <= box.Min.X) && (box.Max.X <= Max.X)
+            && (Min.Y <= box.Min.Y) && (box.Max.Y <= Max.Y)
+            && (Min.Z <= box.Min.Z) && (box.Max.Z <= Max.Z);
+    }
+    
+    /** Returns the area of the box's surface, the usual cost metric of bounding volume hierarchies. */
+    FORCE_INLINE FReal getSurfaceArea() const
+    {
+        const FVector3 size = Max - Min;
+        return 2 * (size.X*size.Y + size.Y*size.Z + size.Z*size.X);
+    }
+};
+
+}   // End of namespace Math
+}   // End of namespace GE
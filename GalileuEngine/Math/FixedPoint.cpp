@@ -0,0 +1,26 @@
+//
+//  FixedPoint.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "FixedPoint.hpp"
+
+namespace GE
+{
+namespace Math
+{
+
+template class TFixedPoint<int64_t, 32>;
+template class TFixedPoint<int32_t, 16>;
+
+static_assert(sizeof(FFixed64) == sizeof(int64_t) && sizeof(FFixed32) == sizeof(int32_t), "Fixed-point numbers must be their raw integer.");
+static_assert(std::is_trivially_copyable_v<FFixed64>, "Fixed-point numbers must be copied like floats.");
+static_assert((sqrt(FFixed64{2.25}) == FFixed64{1.5}) && (sqrt(FFixed32{-1}) == FFixed32{0}), "sqrt() must be exact on perfect squares.");
+static_assert((floor(FFixed64{-0.25}) == FFixed64{-1}) && (abs(FFixed64{-3}) == FFixed64{3}), "floor() and abs() must round down and drop the sign.");
+static_assert((FFixed64{1} / FFixed64{0} == std::numeric_limits<FFixed64>::max()) && (FFixed64{-1} / FFixed64{0} == std::numeric_limits<FFixed64>::lowest()), "Dividing by zero must saturate.");
+static_assert((FFixed64{50000} * FFixed64{-50000} == std::numeric_limits<FFixed64>::lowest()) && (FFixed64{1e5} / FFixed64{1e-5} == std::numeric_limits<FFixed64>::max()), "Products and quotients out of range must saturate.");
+
+}   // End of namespace Math
+}   // End of namespace GE
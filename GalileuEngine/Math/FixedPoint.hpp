@@ -0,0 +1,432 @@
+//
+//  FixedPoint.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "UtilMacros.hpp"
+
+// STD library includes.
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+namespace GE
+{
+namespace Math
+{
+
+/**
+ * A signed Q-format fixed-point number: an integer counting units of 2^-FractionalBits, e.g. Q32.32 with an int64_t and 32 fractional bits.
+ * Every operation is integer arithmetic, so results are bit-identical whatever the compiler, its flags and the platform,
+ * unlike floating-point ones, which contraction, fast-math or x87 registers can change. See GE_FIXED_PRECISION.
+ *
+ * Products round to nearest and quotients truncate towards zero, both saturating to max() or lowest() when out of range, as dividing by zero does.
+ * Sums wrap around on overflow, the way two's complement integers do. There is neither infinity nor NaN: sqrt() of a negative number returns zero.
+ * Squares overflow from about sqrt(max()), e.g. 46341 in Q32.32, and vanish below sqrt(epsilon()): TVector3::magnitude() rescales before squaring.
+ * Arithmetic types convert implicitly, rounding to nearest and saturating, so that literals and mixed expressions read as with float.
+ *
+ * @tparam TStorage The signed integer holding the number.
+ * @tparam FractionalBits The number of bits after the binary point.
+ */
+template<std::signed_integral TStorage, unsigned FractionalBits>
+class TFixedPoint
+{
+    static_assert((FractionalBits > 0) && (FractionalBits < 8*sizeof(TStorage) - 1), "There must be both integer and fractional bits.");
+    
+public:
+    /** The signed integer holding the number. */
+    using FStorage = TStorage;
+    
+    /** A signed integer twice as wide as FStorage, holding products before they are rounded. */
+    using FWideStorage = std::conditional_t<(sizeof(TStorage) < sizeof(int64_t)), int64_t, __int128>;
+    
+    /** The unsigned counterparts, in which sums wrap around instead of being undefined. */
+    using FUnsignedStorage = std::make_unsigned_t<FStorage>;
+    using FUnsignedWideStorage = std::make_unsigned_t<FWideStorage>;
+    
+    /** The number of bits after the binary point. */
+    static constexpr unsigned NumberOfFractionalBits = FractionalBits;
+    
+    /** The raw value of one. */
+    static constexpr FStorage OneRaw = FStorage{1} << FractionalBits;
+    
+public:
+    /**
+     * Default constructor (no initialization).
+     */
+    TFixedPoint() = default;
+    
+    /**
+     * Constructor converting an integer. It must fit in the integer bits.
+     */
+    template<std::integral TInteger>
+    FORCE_INLINE constexpr TFixedPoint(TInteger value) : Raw(static_cast<FStorage>(static_cast<FUnsignedStorage>(value) << FractionalBits)) {}
+    
+    /**
+     * Constructor converting a floating point number, rounded to nearest. Out of range values saturate and NaN becomes zero.
+     */
+    template<std::floating_point TFloat>
+    FORCE_INLINE constexpr TFixedPoint(TFloat value) : Raw(roundToRaw(static_cast<double>(value))) {}
+    
+    /**
+     * Returns the number whose raw value is given.
+     *
+     * @param raw The number of units of 2^-FractionalBits.
+     */
+    FORCE_INLINE static constexpr TFixedPoint fromRaw(FStorage raw)
+    {
+        TFixedPoint result;
+        result.Raw = raw;
+        return result;
+    }
+    
+    /** Returns the number of units of 2^-FractionalBits. */
+    FORCE_INLINE constexpr FStorage getRaw() const { return Raw; }
+    
+    /** Converts to a floating point number, e.g. for rendering. */
+    template<std::floating_point TFloat>
+    FORCE_INLINE constexpr explicit operator TFloat() const { return static_cast<TFloat>(static_cast<double>(Raw) / OneRaw); }
+    
+    /** Converts to an integer, truncating towards zero. */
+    template<std::integral TInteger>
+    FORCE_INLINE constexpr explicit operator TInteger() const { return static_cast<TInteger>(Raw / OneRaw); }
+    
+    FORCE_INLINE constexpr TFixedPoint& operator+=(TFixedPoint rhs) { Raw = static_cast<FStorage>(static_cast<FUnsignedStorage>(Raw) + static_cast<FUnsignedStorage>(rhs.Raw)); return *this; }
+    FORCE_INLINE constexpr TFixedPoint& operator-=(TFixedPoint rhs) { Raw = static_cast<FStorage>(static_cast<FUnsignedStorage>(Raw) - static_cast<FUnsignedStorage>(rhs.Raw)); return *this; }
+    FORCE_INLINE constexpr TFixedPoint& operator*=(TFixedPoint rhs) { return *this = *this * rhs; }
+    FORCE_INLINE constexpr TFixedPoint& operator/=(TFixedPoint rhs) { return *this = *this / rhs; }
+    
+    FORCE_INLINE friend constexpr TFixedPoint operator+(TFixedPoint lhs, TFixedPoint rhs) { return lhs += rhs; }
+    FORCE_INLINE friend constexpr TFixedPoint operator-(TFixedPoint lhs, TFixedPoint rhs) { return lhs -= rhs; }
+    FORCE_INLINE friend constexpr TFixedPoint operator-(TFixedPoint value) { return fromRaw(static_cast<FStorage>(FUnsignedStorage{0} - static_cast<FUnsignedStorage>(value.Raw))); }
+    FORCE_INLINE friend constexpr TFixedPoint operator+(TFixedPoint value) { return value; }
+    
+    FORCE_INLINE friend constexpr TFixedPoint operator*(TFixedPoint lhs, TFixedPoint rhs)
+    {
+        const FWideStorage product = static_cast<FWideStorage>(lhs.Raw) * rhs.Raw;
+        return fromRaw(saturateToRaw((product + (FWideStorage{1} << (FractionalBits - 1))) >> FractionalBits));
+    }
+    
+    FORCE_INLINE friend constexpr TFixedPoint operator/(TFixedPoint lhs, TFixedPoint rhs)
+    {
+        if (rhs.Raw == 0)
+        {
+            return (lhs.Raw >= 0) ? fromRaw(std::numeric_limits<FStorage>::max()) : fromRaw(std::numeric_limits<FStorage>::lowest());
+        }
+        return fromRaw(saturateToRaw(static_cast<FWideStorage>(static_cast<FUnsignedWideStorage>(static_cast<FWideStorage>(lhs.Raw)) << FractionalBits) / rhs.Raw));
+    }
+    
+    friend constexpr bool operator==(const TFixedPoint&, const TFixedPoint&) = default;
+    friend constexpr auto operator<=>(const TFixedPoint&, const TFixedPoint&) = default;
+    
+    friend std::ostream& operator<<(std::ostream& stream, TFixedPoint value)
+    {
+        return stream << static_cast<double>(value);
+    }
+    
+private:
+    /**
+     * Converts a wide raw value, e.g. a product, to a raw value, saturating to max() or lowest() when it is out of range.
+     */
+    FORCE_INLINE static constexpr FStorage saturateToRaw(FWideStorage raw)
+    {
+        if (raw > std::numeric_limits<FStorage>::max())
+        {
+            return std::numeric_limits<FStorage>::max();
+        }
+        if (raw < std::numeric_limits<FStorage>::lowest())
+        {
+            return std::numeric_limits<FStorage>::lowest();
+        }
+        return static_cast<FStorage>(raw);
+    }
+    
+    /**
+     * Converts a floating point number to a raw value, rounded to nearest and saturated.
+     * Scaling by a power of two and splitting off the integer part are exact, so it does not depend on the floating-point environment either.
+     */
+    static constexpr FStorage roundToRaw(double value)
+    {
+        const double scaled = value * OneRaw;
+        if (!(scaled == scaled))
+        {
+            return 0;
+        }
+        if (scaled >= static_cast<double>(std::numeric_limits<FStorage>::max()))
+        {
+            return std::numeric_limits<FStorage>::max();
+        }
+        if (scaled <= static_cast<double>(std::numeric_limits<FStorage>::lowest()))
+        {
+            return std::numeric_limits<FStorage>::lowest();
+        }
+        
+        const FStorage integerPart = static_cast<FStorage>(scaled);
+        const double fractionalPart = scaled - static_cast<double>(integerPart);
+        if (fractionalPart >= 0.5)
+        {
+            return integerPart + 1;
+        }
+        if (fractionalPart <= -0.5)
+        {
+            return integerPart - 1;
+        }
+        return integerPart;
+    }
+    
+private:
+    FStorage Raw;
+};
+
+/** Q32.32: an integer range of +-2^31 with a resolution of 2^-32, about 2.3e-10. It is FReal when GE_FIXED_PRECISION is set. */
+using FFixed64 = TFixedPoint<int64_t, 32>;
+
+/** Q16.16: an integer range of +-32768 with a resolution of 2^-16, about 1.5e-5, for small scenes and storage. */
+using FFixed32 = TFixedPoint<int32_t, 16>;
+
+/**
+ * Returns the number of bits needed to write an unsigned integer, including unsigned __int128 which std::bit_width() does not take.
+ */
+template<typename TUnsigned>
+FORCE_INLINE constexpr unsigned getBitWidth(TUnsigned value)
+{
+    if constexpr (sizeof(TUnsigned) > sizeof(uint64_t))
+    {
+        const uint64_t high = static_cast<uint64_t>(value >> 64);
+        return (high != 0) ? 64 + std::bit_width(high) : std::bit_width(static_cast<uint64_t>(value));
+    }
+    else
+    {
+        return std::bit_width(value);
+    }
+}
+
+/** Checks whether a type is an instance of TFixedPoint. */
+template<typename T>
+struct TIsFixedPoint : std::false_type {};
+
+template<std::signed_integral TStorage, unsigned FractionalBits>
+struct TIsFixedPoint<TFixedPoint<TStorage, FractionalBits>> : std::true_type {};
+
+template<typename T>
+concept FixedPoint = TIsFixedPoint<T>::value;
+
+/**
+ * Returns the square root, correctly rounded to nearest, computed digit by digit: it is exact integer arithmetic, so it is the same everywhere.
+ * Negative arguments return zero.
+ */
+template<FixedPoint TArg>
+constexpr TArg sqrt(TArg arg)
+{
+    using FUnsignedWideStorage = typename TArg::FUnsignedWideStorage;
+    if (arg.getRaw() <= 0)
+    {
+        return TArg::fromRaw(0);
+    }
+    
+    // sqrt(raw / 2^F) * 2^F = sqrt(raw * 2^F).
+    FUnsignedWideStorage remainder = static_cast<FUnsignedWideStorage>(arg.getRaw()) << TArg::NumberOfFractionalBits;
+    FUnsignedWideStorage root = 0;
+    for (FUnsignedWideStorage bit = FUnsignedWideStorage{1} << ((getBitWidth(remainder) - 1) & ~1u); bit != 0; bit >>= 2)
+    {
+        if (remainder >= root + bit)
+        {
+            remainder -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+    }
+    
+    // The remainder is raw * 2^F - root^2: round up when it exceeds root, i.e. when the root is closer to root + 1.
+    if (remainder > root)
+    {
+        ++root;
+    }
+    return TArg::fromRaw(static_cast<typename TArg::FStorage>(root));
+}
+
+/**
+ * Returns the absolute value. lowest() has none, and stays itself.
+ */
+template<FixedPoint TArg>
+FORCE_INLINE constexpr TArg abs(TArg arg)
+{
+    return (arg.getRaw() < 0) ? -arg : arg;
+}
+
+/**
+ * Returns the largest integer not greater than the argument.
+ */
+template<FixedPoint TArg>
+FORCE_INLINE constexpr TArg floor(TArg arg)
+{
+    // Clearing the fractional bits of a two's complement number rounds it down.
+    return TArg::fromRaw(arg.getRaw() & ~(TArg::OneRaw - 1));
+}
+
+/**
+ * Returns 1 / sqrt(arg). There is no faster estimate to refine, so every ENormalization takes this path.
+ */
+template<FixedPoint TArg>
+FORCE_INLINE constexpr TArg inverseSqrt(TArg arg)
+{
+    return TArg{1} / sqrt(arg);
+}
+
+template<FixedPoint TArg>
+FORCE_INLINE constexpr TArg fastInverseSqrt(TArg arg)
+{
+    return inverseSqrt(arg);
+}
+
+/**
+ * Returns the base 2 logarithm of a positive number, bit by bit: the mantissa is squared once per fractional bit, each square above 2 yielding a one.
+ * Non-positive arguments return lowest().
+ */
+template<FixedPoint TArg>
+constexpr TArg log2(TArg arg)
+{
+    using FStorage = typename TArg::FStorage;
+    using FWideStorage = typename TArg::FWideStorage;
+    constexpr unsigned F = TArg::NumberOfFractionalBits;
+    
+    if (arg.getRaw() <= 0)
+    {
+        return TArg::fromRaw(std::numeric_limits<FStorage>::lowest());
+    }
+    
+    // arg = 2^exponent * mantissa, the mantissa being in [1, 2).
+    const int exponent = static_cast<int>(std::bit_width(static_cast<std::make_unsigned_t<FStorage>>(arg.getRaw()))) - 1 - static_cast<int>(F);
+    FWideStorage mantissa = (exponent >= 0) ? (FWideStorage{arg.getRaw()} >> exponent) : (FWideStorage{arg.getRaw()} << -exponent);
+    
+    FStorage result = static_cast<FStorage>(exponent) * TArg::OneRaw;
+    for (FStorage bit = TArg::OneRaw >> 1; bit != 0; bit >>= 1)
+    {
+        mantissa = (mantissa * mantissa) >> F;
+        if (mantissa >= (FWideStorage{2} << F))
+        {
+            mantissa >>= 1;
+            result += bit;
+        }
+    }
+    return TArg::fromRaw(result);
+}
+
+/**
+ * Returns 2 to the given power: the integer part is a shift, the fractional one the product of 2^(2^-i) for each of its bits set.
+ * Powers too large saturate to max().
+ */
+template<FixedPoint TArg>
+constexpr TArg exp2(TArg arg)
+{
+    using FStorage = typename TArg::FStorage;
+    constexpr unsigned F = TArg::NumberOfFractionalBits;
+    
+    // The roots of two, 2^(2^-i) for i in [1, F], each the square root of the previous one.
+    constexpr auto roots = []
+    {
+        struct { TArg Values[F]; } table{};
+        TArg root{2};
+        for (unsigned index = 0; index < F; ++index)
+        {
+            root = sqrt(root);
+            table.Values[index] = root;
+        }
+        return table;
+    }();
+    
+    const FStorage integerPart = arg.getRaw() >> F;
+    const FStorage fractionalPart = arg.getRaw() & (TArg::OneRaw - 1);
+    TArg result{1};
+    for (unsigned index = 0; index < F; ++index)
+    {
+        if (fractionalPart & (FStorage{1} << (F - 1 - index)))
+        {
+            result *= roots.Values[index];
+        }
+    }
+    
+    // result is in [1, 2), so it keeps its value shifted by up to the number of integer bits minus two.
+    constexpr FStorage maxShift = 8*sizeof(FStorage) - F - 2;
+    if (integerPart > maxShift)
+    {
+        return TArg::fromRaw(std::numeric_limits<FStorage>::max());
+    }
+    if (integerPart >= 0)
+    {
+        return TArg::fromRaw(result.getRaw() << integerPart);
+    }
+    if (integerPart < -static_cast<FStorage>(F + 1))
+    {
+        return TArg::fromRaw(0);
+    }
+    
+    // Round to nearest.
+    const unsigned shift = static_cast<unsigned>(-integerPart);
+    return TArg::fromRaw((result.getRaw() + (FStorage{1} << (shift - 1))) >> shift);
+}
+
+/**
+ * Returns base^exponent as 2^(exponent log2(base)), e.g. damping^deltaTime. The base must be positive, or zero with a positive exponent.
+ */
+template<FixedPoint TArg>
+constexpr TArg pow(TArg base, TArg exponent)
+{
+    if (base.getRaw() <= 0)
+    {
+        return TArg::fromRaw(0);
+    }
+    if (base == TArg{1})
+    {
+        return base;
+    }
+    return exp2(exponent * log2(base));
+}
+
+}   // End of namespace Math
+}   // End of namespace GE
+
+namespace std
+{
+
+template<std::signed_integral TStorage, unsigned FractionalBits>
+class numeric_limits<GE::Math::TFixedPoint<TStorage, FractionalBits>>
+{
+    using FFixedPoint = GE::Math::TFixedPoint<TStorage, FractionalBits>;
+    
+public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = true;
+    static constexpr bool has_infinity = false;
+    static constexpr bool has_quiet_NaN = false;
+    static constexpr bool has_signaling_NaN = false;
+    static constexpr bool is_bounded = true;
+    static constexpr bool is_modulo = true;
+    static constexpr int radix = 2;
+    static constexpr int digits = std::numeric_limits<TStorage>::digits;
+    
+    /** The smallest positive value, like float's min() is its smallest positive normal value. */
+    static constexpr FFixedPoint min() noexcept { return FFixedPoint::fromRaw(1); }
+    static constexpr FFixedPoint max() noexcept { return FFixedPoint::fromRaw(std::numeric_limits<TStorage>::max()); }
+    static constexpr FFixedPoint lowest() noexcept { return FFixedPoint::fromRaw(std::numeric_limits<TStorage>::lowest()); }
+    static constexpr FFixedPoint epsilon() noexcept { return FFixedPoint::fromRaw(1); }
+    static constexpr FFixedPoint round_error() noexcept { return FFixedPoint::fromRaw(FFixedPoint::OneRaw >> 1); }
+    static constexpr FFixedPoint infinity() noexcept { return max(); }
+    static constexpr FFixedPoint quiet_NaN() noexcept { return FFixedPoint::fromRaw(0); }
+    static constexpr FFixedPoint denorm_min() noexcept { return min(); }
+};
+
+}   // End of namespace std
@@ -9,13 +9,23 @@
 
 
 #include "Precision.hpp"
+#include "FixedPoint.hpp"
+#include "UtilMacros.hpp"
 
 // STD library includes.
 #include <cmath>
+#include <concepts>
+#include <limits>
+
+#if defined(__SSE2__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
 
 // BEG - basic concepts
 template<typename T>
-concept Arithmetic = std::is_arithmetic_v<T>;
+concept Arithmetic = std::is_arithmetic_v<T> || GE::Math::FixedPoint<T>;
 // END - basic concepts
 
 namespace GE
@@ -35,6 +45,86 @@ TArg abs(TArg arg)
     return std::abs(arg);
 }
 
+template<Arithmetic TArg>
+TArg floor(TArg arg)
+{
+    return std::floor(arg);
+}
+
+/**
+ * How accurately inverse square roots are computed, e.g. to normalize vectors.
+ */
+enum class ENormalization
+{
+    /** A correctly rounded square root, then a division. */
+    Exact,
+    
+    /**
+     * The hardware estimate of the inverse square root, refined by Newton steps. The relative error stays below 3e-7 in single precision and 1e-13 in double precision.
+     * It shortens the latency of the square root and the division, and raises their throughput where they are slow: measure before opting in.
+     */
+    Fast
+};
+
+/**
+ * Returns 1 / sqrt(arg), correctly rounded except for the division's rounding.
+ */
+template<std::floating_point TArg>
+FORCE_INLINE TArg inverseSqrt(TArg arg)
+{
+    return TArg(1) / std::sqrt(arg);
+}
+
+/**
+ * Refines an estimate of 1 / sqrt(x) with Newton steps, each one roughly doubling its number of correct bits.
+ * It works on scalars as well as on packets.
+ *
+ * @param x The argument.
+ * @param estimate The estimate of 1 / sqrt(x).
+ */
+template<unsigned NumberOfSteps, typename TArg>
+FORCE_INLINE TArg refineInverseSqrt(const TArg& x, TArg estimate)
+{
+    const TArg halfX = x * (FReal) 0.5;
+    for (unsigned step = 0; step < NumberOfSteps; ++step)
+    {
+        estimate = estimate * ((FReal) 1.5 - halfX * estimate * estimate);
+    }
+    return estimate;
+}
+
+/**
+ * Returns 1 / sqrt(arg) with the accuracy of ENormalization::Fast. The argument must be positive and finite.
+ * The estimate is single precision: one Newton step refines SSE's 12 bits, two NEON's 8 bits, and double precision takes one more.
+ * Arguments out of float's normal range, and builds with neither SSE2 nor NEON, take the exact path.
+ */
+template<std::floating_point TArg>
+FORCE_INLINE TArg fastInverseSqrt(TArg arg)
+{
+#if defined(__SSE2__) || (defined(__ARM_NEON) && defined(__aarch64__))
+    const bool isInFloatRange = (sizeof(TArg) > sizeof(float)) ? (arg >= std::numeric_limits<float>::min()) && (arg <= std::numeric_limits<float>::max())
+                                                               : (arg >= std::numeric_limits<float>::min());
+    if (isInFloatRange)
+    {
+#if defined(__SSE2__)
+        const float estimate = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(static_cast<float>(arg))));
+        constexpr unsigned NumberOfSteps = (sizeof(TArg) > sizeof(float)) ? 2 : 1;
+#else
+        const float estimate = vrsqrtes_f32(static_cast<float>(arg));
+        constexpr unsigned NumberOfSteps = (sizeof(TArg) > sizeof(float)) ? 3 : 2;
+#endif
+        return refineInverseSqrt<NumberOfSteps>(arg, static_cast<TArg>(estimate));
+    }
+#endif
+    return inverseSqrt(arg);
+}
+
+template<Arithmetic TArg>
+TArg pow(TArg base, TArg exponent)
+{
+    return std::pow(base, exponent);
+}
+
 constexpr FReal Max_number = std::numeric_limits<FReal>::max();
 constexpr FReal Small_number = (FReal) 1.e-8;
 constexpr FReal Kinda_Small_number = (FReal) 1.e-4;
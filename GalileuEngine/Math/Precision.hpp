@@ -8,6 +8,9 @@
 #pragma once
 
 // GE includes.
+#include "FixedPoint.hpp"
+
+// STD library includes.
 #include <type_traits>
 
 namespace GE
@@ -15,8 +18,54 @@ namespace GE
 namespace Math
 {
 
+// The precision is chosen at build time, by defining one of these to 1, e.g. in the preprocessor macros of the build settings:
+// - GE_DOUBLE_PRECISION: everything is computed in double precision.
+// - GE_MIXED_PRECISION: positions are stored in double precision, so they keep their accuracy far from the origin,
+//   while velocities, forces and everything else stay in single precision. Position differences are computed before being narrowed.
+// - GE_FIXED_PRECISION: everything is computed in Q32.32 fixed point, see TFixedPoint. It is integer arithmetic, so the simulation is bit-identical
+//   across compilers, flags and platforms, e.g. for lockstep sessions between different builds, at the cost of speed and range. Packets are scalar.
+// By default, everything is computed in single precision.
+#if !defined(GE_DOUBLE_PRECISION)
+    #define GE_DOUBLE_PRECISION 0
+#endif
+
+#if !defined(GE_MIXED_PRECISION)
+    #define GE_MIXED_PRECISION 0
+#endif
+
+#if !defined(GE_FIXED_PRECISION)
+    #define GE_FIXED_PRECISION 0
+#endif
+
+#if (GE_DOUBLE_PRECISION + GE_MIXED_PRECISION + GE_FIXED_PRECISION) > 1
+    #error "GE_DOUBLE_PRECISION, GE_MIXED_PRECISION and GE_FIXED_PRECISION are exclusive."
+#endif
+
+#if GE_DOUBLE_PRECISION
+using FReal = double;
+#elif GE_FIXED_PRECISION
+using FReal = FFixed64;
+#else
 using FReal = float;
-static_assert(std::is_floating_point_v<FReal>, "FReal must be a floating point type.");
+#endif
+static_assert(std::is_floating_point_v<FReal> || TIsFixedPoint<FReal>::value, "FReal must be a floating point or a fixed-point type.");
+
+/** The name of FReal, e.g. for logs. */
+#if GE_DOUBLE_PRECISION
+constexpr const char* RealName = "double";
+#elif GE_FIXED_PRECISION
+constexpr const char* RealName = "Q32.32 fixed point";
+#else
+constexpr const char* RealName = "float";
+#endif
+
+/** The type of the components of positions. */
+#if GE_MIXED_PRECISION
+using FPositionReal = double;
+#else
+using FPositionReal = FReal;
+#endif
+static_assert(sizeof(FPositionReal) >= sizeof(FReal), "Positions must be at least as precise as FReal.");
 
 }   // End of namespace Math
 }   // End of namespace GE
@@ -0,0 +1,30 @@
+//
+//  SimdReal.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "SimdReal.hpp"
+
+namespace GE
+{
+namespace Math
+{
+
+static_assert(FRealN::NumberOfLanes * sizeof(FReal) == sizeof(FSimdBackend::FRegister), "A packet must fill its register.");
+static_assert(FSimdBackend::AllMaskBits + 1 == (1u << FRealN::NumberOfLanes), "A mask must have one bit per lane.");
+
+const char* getInstructionSetName(ESimdInstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+        case ESimdInstructionSet::SSE2: return "SSE2";
+        case ESimdInstructionSet::AVX2: return "AVX2";
+        case ESimdInstructionSet::NEON: return "NEON";
+        default: return "scalar";
+    }
+}
+
+}   // End of namespace Math
+}   // End of namespace GE
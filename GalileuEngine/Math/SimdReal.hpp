@@ -0,0 +1,599 @@
+//
+//  SimdReal.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Precision.hpp"
+#include "Math.hpp"
+#include "UtilMacros.hpp"
+
+// STD library includes.
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
+namespace GE
+{
+namespace Math
+{
+
+/** The instruction sets packets can be compiled for. */
+enum class ESimdInstructionSet
+{
+    Scalar,
+    SSE2,
+    AVX2,
+    NEON,
+};
+
+/**
+ * Returns the name of an instruction set, e.g. for logs.
+ *
+ * @param instructionSet The instruction set.
+ */
+const char* getInstructionSetName(ESimdInstructionSet instructionSet);
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+/**
+ * Loads 4 consecutive 3D vectors, x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3, into one register per component, transposing them with shuffles.
+ */
+FORCE_INLINE void loadInterleaved128(const float* values, __m128& x, __m128& y, __m128& z)
+{
+    const __m128 first = _mm_loadu_ps(values);
+    const __m128 second = _mm_loadu_ps(values + 4);
+    const __m128 third = _mm_loadu_ps(values + 8);
+    const __m128 xy23 = _mm_shuffle_ps(second, third, _MM_SHUFFLE(2, 1, 3, 2));
+    const __m128 yz01 = _mm_shuffle_ps(first, second, _MM_SHUFFLE(1, 0, 2, 1));
+    x = _mm_shuffle_ps(first, xy23, _MM_SHUFFLE(2, 0, 3, 0));
+    y = _mm_shuffle_ps(yz01, xy23, _MM_SHUFFLE(3, 1, 2, 0));
+    z = _mm_shuffle_ps(yz01, third, _MM_SHUFFLE(3, 0, 3, 1));
+}
+
+/**
+ * Stores one register per component as 4 consecutive 3D vectors, the inverse of loadInterleaved128().
+ */
+FORCE_INLINE void storeInterleaved128(float* values, __m128 x, __m128 y, __m128 z)
+{
+    const __m128 x02y02 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m128 z02x13 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+    const __m128 y13z13 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+    _mm_storeu_ps(values, _mm_shuffle_ps(x02y02, z02x13, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(values + 4, _mm_shuffle_ps(y13z13, x02y02, _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm_storeu_ps(values + 8, _mm_shuffle_ps(z02x13, y13z13, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+/**
+ * Loads 2 consecutive 3D vectors, x0 y0 | z0 x1 | y1 z1, into one register per component.
+ */
+FORCE_INLINE void loadInterleaved128(const double* values, __m128d& x, __m128d& y, __m128d& z)
+{
+    const __m128d first = _mm_loadu_pd(values);
+    const __m128d second = _mm_loadu_pd(values + 2);
+    const __m128d third = _mm_loadu_pd(values + 4);
+    x = _mm_shuffle_pd(first, second, 2);
+    y = _mm_shuffle_pd(first, third, 1);
+    z = _mm_shuffle_pd(second, third, 2);
+}
+
+/**
+ * Stores one register per component as 2 consecutive 3D vectors, the inverse of loadInterleaved128().
+ */
+FORCE_INLINE void storeInterleaved128(double* values, __m128d x, __m128d y, __m128d z)
+{
+    _mm_storeu_pd(values, _mm_shuffle_pd(x, y, 0));
+    _mm_storeu_pd(values + 2, _mm_shuffle_pd(z, x, 2));
+    _mm_storeu_pd(values + 4, _mm_shuffle_pd(y, z, 3));
+}
+
+#endif
+
+/**
+ * The instructions packets are made of, for FReal and the instruction set chosen at compile time.
+ * It is the only place that knows about intrinsics: FRealN, FMaskN and FVector3xN are written once against it.
+ * inverseSqrtEstimate() takes NumberOfNewtonSteps steps to reach the accuracy of ENormalization::Fast; x86 has no double estimate, so it converts to float and back.
+ * loadInterleaved() and storeInterleaved() move NumberOfLanes consecutive 3D vectors, transposed with shuffles on x86, and with vld3q and vst3q on NEON.
+ * Fixed-point reals have no such instructions, so they always take the scalar backend.
+ */
+struct FSimdBackend
+{
+#if defined(__AVX2__) && GE_DOUBLE_PRECISION
+    using FRegister = __m256d;
+    using FMaskRegister = __m256d;
+    static constexpr ESimdInstructionSet InstructionSet = ESimdInstructionSet::AVX2;
+    static constexpr size_t NumberOfLanes = 4;
+    static constexpr unsigned NumberOfNewtonSteps = 2;
+    
+    static FORCE_INLINE FRegister load(const FReal* values) { return _mm256_loadu_pd(values); }
+    static FORCE_INLINE void store(FReal* values, FRegister a) { _mm256_storeu_pd(values, a); }
+    static FORCE_INLINE FRegister set(FReal value) { return _mm256_set1_pd(value); }
+    static FORCE_INLINE FRegister add(FRegister a, FRegister b) { return _mm256_add_pd(a, b); }
+    static FORCE_INLINE FRegister subtract(FRegister a, FRegister b) { return _mm256_sub_pd(a, b); }
+    static FORCE_INLINE FRegister multiply(FRegister a, FRegister b) { return _mm256_mul_pd(a, b); }
+    static FORCE_INLINE FRegister divide(FRegister a, FRegister b) { return _mm256_div_pd(a, b); }
+    static FORCE_INLINE FRegister sqrt(FRegister a) { return _mm256_sqrt_pd(a); }
+    static FORCE_INLINE FRegister inverseSqrtEstimate(FRegister a) { return _mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(a))); }
+    static FORCE_INLINE FRegister min(FRegister a, FRegister b) { return _mm256_min_pd(a, b); }
+    static FORCE_INLINE FRegister max(FRegister a, FRegister b) { return _mm256_max_pd(a, b); }
+    static FORCE_INLINE FMaskRegister greater(FRegister a, FRegister b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+    static FORCE_INLINE FMaskRegister greaterEqual(FRegister a, FRegister b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+    static FORCE_INLINE FMaskRegister equal(FRegister a, FRegister b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ); }
+    static FORCE_INLINE FMaskRegister maskAnd(FMaskRegister a, FMaskRegister b) { return _mm256_and_pd(a, b); }
+    static FORCE_INLINE FMaskRegister maskOr(FMaskRegister a, FMaskRegister b) { return _mm256_or_pd(a, b); }
+    static FORCE_INLINE FMaskRegister maskNot(FMaskRegister a) { return _mm256_xor_pd(a, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))); }
+    static FORCE_INLINE FRegister select(FMaskRegister mask, FRegister ifTrue, FRegister ifFalse) { return _mm256_blendv_pd(ifFalse, ifTrue, mask); }
+    static FORCE_INLINE unsigned getMaskBits(FMaskRegister mask) { return static_cast<unsigned>(_mm256_movemask_pd(mask)); }
+    
+    static FORCE_INLINE void loadInterleaved(const FReal* values, FRegister& x, FRegister& y, FRegister& z)
+    {
+        // Each half of the registers holds 2 vectors, laid out as in loadInterleaved128(), so the in-lane shuffles transpose both at once.
+        const __m256d first = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(values)), _mm_loadu_pd(values + 6), 1);
+        const __m256d second = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(values + 2)), _mm_loadu_pd(values + 8), 1);
+        const __m256d third = _mm256_insertf128_pd(_mm256_castpd128_pd256(_mm_loadu_pd(values + 4)), _mm_loadu_pd(values + 10), 1);
+        x = _mm256_shuffle_pd(first, second, 0b1010);
+        y = _mm256_shuffle_pd(first, third, 0b0101);
+        z = _mm256_shuffle_pd(second, third, 0b1010);
+    }
+    static FORCE_INLINE void storeInterleaved(FReal* values, FRegister x, FRegister y, FRegister z)
+    {
+        const __m256d first = _mm256_shuffle_pd(x, y, 0b0000);
+        const __m256d second = _mm256_shuffle_pd(z, x, 0b1010);
+        const __m256d third = _mm256_shuffle_pd(y, z, 0b1111);
+        _mm_storeu_pd(values, _mm256_castpd256_pd128(first));
+        _mm_storeu_pd(values + 2, _mm256_castpd256_pd128(second));
+        _mm_storeu_pd(values + 4, _mm256_castpd256_pd128(third));
+        _mm_storeu_pd(values + 6, _mm256_extractf128_pd(first, 1));
+        _mm_storeu_pd(values + 8, _mm256_extractf128_pd(second, 1));
+        _mm_storeu_pd(values + 10, _mm256_extractf128_pd(third, 1));
+    }
+    
+#elif defined(__AVX2__) && !GE_FIXED_PRECISION
+    using FRegister = __m256;
+    using FMaskRegister = __m256;
+    static constexpr ESimdInstructionSet InstructionSet = ESimdInstructionSet::AVX2;
+    static constexpr size_t NumberOfLanes = 8;
+    static constexpr unsigned NumberOfNewtonSteps = 1;
+    
+    static FORCE_INLINE FRegister load(const FReal* values) { return _mm256_loadu_ps(values); }
+    static FORCE_INLINE void store(FReal* values, FRegister a) { _mm256_storeu_ps(values, a); }
+    static FORCE_INLINE FRegister set(FReal value) { return _mm256_set1_ps(value); }
+    static FORCE_INLINE FRegister add(FRegister a, FRegister b) { return _mm256_add_ps(a, b); }
+    static FORCE_INLINE FRegister subtract(FRegister a, FRegister b) { return _mm256_sub_ps(a, b); }
+    static FORCE_INLINE FRegister multiply(FRegister a, FRegister b) { return _mm256_mul_ps(a, b); }
+    static FORCE_INLINE FRegister divide(FRegister a, FRegister b) { return _mm256_div_ps(a, b); }
+    static FORCE_INLINE FRegister sqrt(FRegister a) { return _mm256_sqrt_ps(a); }
+    static FORCE_INLINE FRegister inverseSqrtEstimate(FRegister a) { return _mm256_rsqrt_ps(a); }
+    static FORCE_INLINE FRegister min(FRegister a, FRegister b) { return _mm256_min_ps(a, b); }
+    static FORCE_INLINE FRegister max(FRegister a, FRegister b) { return _mm256_max_ps(a, b); }
+    static FORCE_INLINE FMaskRegister greater(FRegister a, FRegister b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static FORCE_INLINE FMaskRegister greaterEqual(FRegister a, FRegister b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    static FORCE_INLINE FMaskRegister equal(FRegister a, FRegister b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    static FORCE_INLINE FMaskRegister maskAnd(FMaskRegister a, FMaskRegister b) { return _mm256_and_ps(a, b); }
+    static FORCE_INLINE FMaskRegister maskOr(FMaskRegister a, FMaskRegister b) { return _mm256_or_ps(a, b); }
+    static FORCE_INLINE FMaskRegister maskNot(FMaskRegister a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+    static FORCE_INLINE FRegister select(FMaskRegister mask, FRegister ifTrue, FRegister ifFalse) { return _mm256_blendv_ps(ifFalse, ifTrue, mask); }
+    static FORCE_INLINE unsigned getMaskBits(FMaskRegister mask) { return static_cast<unsigned>(_mm256_movemask_ps(mask)); }
+    
+    static FORCE_INLINE void loadInterleaved(const FReal* values, FRegister& x, FRegister& y, FRegister& z)
+    {
+        // Each half of the registers holds 4 vectors, laid out as in loadInterleaved128(), so the in-lane shuffles transpose both at once.
+        const __m256 first = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(values)), _mm_loadu_ps(values + 12), 1);
+        const __m256 second = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(values + 4)), _mm_loadu_ps(values + 16), 1);
+        const __m256 third = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(values + 8)), _mm_loadu_ps(values + 20), 1);
+        const __m256 xy23 = _mm256_shuffle_ps(second, third, _MM_SHUFFLE(2, 1, 3, 2));
+        const __m256 yz01 = _mm256_shuffle_ps(first, second, _MM_SHUFFLE(1, 0, 2, 1));
+        x = _mm256_shuffle_ps(first, xy23, _MM_SHUFFLE(2, 0, 3, 0));
+        y = _mm256_shuffle_ps(yz01, xy23, _MM_SHUFFLE(3, 1, 2, 0));
+        z = _mm256_shuffle_ps(yz01, third, _MM_SHUFFLE(3, 0, 3, 1));
+    }
+    static FORCE_INLINE void storeInterleaved(FReal* values, FRegister x, FRegister y, FRegister z)
+    {
+        const __m256 x02y02 = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 z02x13 = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256 y13z13 = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+        const __m256 first = _mm256_shuffle_ps(x02y02, z02x13, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m256 second = _mm256_shuffle_ps(y13z13, x02y02, _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256 third = _mm256_shuffle_ps(z02x13, y13z13, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(values, _mm256_castps256_ps128(first));
+        _mm_storeu_ps(values + 4, _mm256_castps256_ps128(second));
+        _mm_storeu_ps(values + 8, _mm256_castps256_ps128(third));
+        _mm_storeu_ps(values + 12, _mm256_extractf128_ps(first, 1));
+        _mm_storeu_ps(values + 16, _mm256_extractf128_ps(second, 1));
+        _mm_storeu_ps(values + 20, _mm256_extractf128_ps(third, 1));
+    }
+    
+#elif defined(__SSE2__) && GE_DOUBLE_PRECISION
+    using FRegister = __m128d;
+    using FMaskRegister = __m128d;
+    static constexpr ESimdInstructionSet InstructionSet = ESimdInstructionSet::SSE2;
+    static constexpr size_t NumberOfLanes = 2;
+    static constexpr unsigned NumberOfNewtonSteps = 2;
+    
+    static FORCE_INLINE FRegister load(const FReal* values) { return _mm_loadu_pd(values); }
+    static FORCE_INLINE void store(FReal* values, FRegister a) { _mm_storeu_pd(values, a); }
+    static FORCE_INLINE FRegister set(FReal value) { return _mm_set1_pd(value); }
+    static FORCE_INLINE FRegister add(FRegister a, FRegister b) { return _mm_add_pd(a, b); }
+    static FORCE_INLINE FRegister subtract(FRegister a, FRegister b) { return _mm_sub_pd(a, b); }
+    static FORCE_INLINE FRegister multiply(FRegister a, FRegister b) { return _mm_mul_pd(a, b); }
+    static FORCE_INLINE FRegister divide(FRegister a, FRegister b) { return _mm_div_pd(a, b); }
+    static FORCE_INLINE FRegister sqrt(FRegister a) { return _mm_sqrt_pd(a); }
+    static FORCE_INLINE FRegister inverseSqrtEstimate(FRegister a) { return _mm_cvtps_pd(_mm_rsqrt_ps(_mm_cvtpd_ps(a))); }
+    static FORCE_INLINE FRegister min(FRegister a, FRegister b) { return _mm_min_pd(a, b); }
+    static FORCE_INLINE FRegister max(FRegister a, FRegister b) { return _mm_max_pd(a, b); }
+    static FORCE_INLINE FMaskRegister greater(FRegister a, FRegister b) { return _mm_cmpgt_pd(a, b); }
+    static FORCE_INLINE FMaskRegister greaterEqual(FRegister a, FRegister b) { return _mm_cmpge_pd(a, b); }
+    static FORCE_INLINE FMaskRegister equal(FRegister a, FRegister b) { return _mm_cmpeq_pd(a, b); }
+    static FORCE_INLINE FMaskRegister maskAnd(FMaskRegister a, FMaskRegister b) { return _mm_and_pd(a, b); }
+    static FORCE_INLINE FMaskRegister maskOr(FMaskRegister a, FMaskRegister b) { return _mm_or_pd(a, b); }
+    static FORCE_INLINE FMaskRegister maskNot(FMaskRegister a) { return _mm_xor_pd(a, _mm_castsi128_pd(_mm_set1_epi32(-1))); }
+    static FORCE_INLINE FRegister select(FMaskRegister mask, FRegister ifTrue, FRegister ifFalse) { return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, ifFalse)); }
+    static FORCE_INLINE unsigned getMaskBits(FMaskRegister mask) { return static_cast<unsigned>(_mm_movemask_pd(mask)); }
+    
+    static FORCE_INLINE void loadInterleaved(const FReal* values, FRegister& x, FRegister& y, FRegister& z) { loadInterleaved128(values, x, y, z); }
+    static FORCE_INLINE void storeInterleaved(FReal* values, FRegister x, FRegister y, FRegister z) { storeInterleaved128(values, x, y, z); }
+    
+#elif defined(__SSE2__) && !GE_FIXED_PRECISION
+    using FRegister = __m128;
+    using FMaskRegister = __m128;
+    static constexpr ESimdInstructionSet InstructionSet = ESimdInstructionSet::SSE2;
+    static constexpr size_t NumberOfLanes = 4;
+    static constexpr unsigned NumberOfNewtonSteps = 1;
+    
+    static FORCE_INLINE FRegister load(const FReal* values) { return _mm_loadu_ps(values); }
+    static FORCE_INLINE void store(FReal* values, FRegister a) { _mm_storeu_ps(values, a); }
+    static FORCE_INLINE FRegister set(FReal value) { return _mm_set1_ps(value); }
+    static FORCE_INLINE FRegister add(FRegister a, FRegister b) { return _mm_add_ps(a, b); }
+    static FORCE_INLINE FRegister subtract(FRegister a, FRegister b) { return _mm_sub_ps(a, b); }
+    static FORCE_INLINE FRegister multiply(FRegister a, FRegister b) { return _mm_mul_ps(a, b); }
+    static FORCE_INLINE FRegister divide(FRegister a, FRegister b) { return _mm_div_ps(a, b); }
+    static FORCE_INLINE FRegister sqrt(FRegister a) { return _mm_sqrt_ps(a); }
+    static FORCE_INLINE FRegister inverseSqrtEstimate(FRegister a) { return _mm_rsqrt_ps(a); }
+    static FORCE_INLINE FRegister min(FRegister a, FRegister b) { return _mm_min_ps(a, b); }
+    static FORCE_INLINE FRegister max(FRegister a, FRegister b) { return _mm_max_ps(a, b); }
+    static FORCE_INLINE FMaskRegister greater(FRegister a, FRegister b) { return _mm_cmpgt_ps(a, b); }
+    static FORCE_INLINE FMaskRegister greaterEqual(FRegister a, FRegister b) { return _mm_cmpge_ps(a, b); }
+    static FORCE_INLINE FMaskRegister equal(FRegister a, FRegister b) { return _mm_cmpeq_ps(a, b); }
+    static FORCE_INLINE FMaskRegister maskAnd(FMaskRegister a, FMaskRegister b) { return _mm_and_ps(a, b); }
+    static FORCE_INLINE FMaskRegister maskOr(FMaskRegister a, FMaskRegister b) { return _mm_or_ps(a, b); }
+    static FORCE_INLINE FMaskRegister maskNot(FMaskRegister a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+    static FORCE_INLINE FRegister select(FMaskRegister mask, FRegister ifTrue, FRegister ifFalse) { return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse)); }
+    static FORCE_INLINE unsigned getMaskBits(FMaskRegister mask) { return static_cast<unsigned>(_mm_movemask_ps(mask)); }
+    
+    static FORCE_INLINE void loadInterleaved(const FReal* values, FRegister& x, FRegister& y, FRegister& z) { loadInterleaved128(values, x, y, z); }
+    static FORCE_INLINE void storeInterleaved(FReal* values, FRegister x, FRegister y, FRegister z) { storeInterleaved128(values, x, y, z); }
+    
+#elif defined(__ARM_NEON) && defined(__aarch64__) && GE_DOUBLE_PRECISION
+    using FRegister = float64x2_t;
+    using FMaskRegister = uint64x2_t;
+    static constexpr ESimdInstructionSet InstructionSet = ESimdInstructionSet::NEON;
+    static constexpr size_t NumberOfLanes = 2;
+    static constexpr unsigned NumberOfNewtonSteps = 3;
+    
+    static FORCE_INLINE FRegister load(const FReal* values) { return vld1q_f64(values); }
+    static FORCE_INLINE void store(FReal* values, FRegister a) { vst1q_f64(values, a); }
+    static FORCE_INLINE FRegister set(FReal value) { return vdupq_n_f64(value); }
+    static FORCE_INLINE FRegister add(FRegister a, FRegister b) { return vaddq_f64(a, b); }
+    static FORCE_INLINE FRegister subtract(FRegister a, FRegister b) { return vsubq_f64(a, b); }
+    static FORCE_INLINE FRegister multiply(FRegister a, FRegister b) { return vmulq_f64(a, b); }
+    static FORCE_INLINE FRegister divide(FRegister a, FRegister b) { return vdivq_f64(a, b); }
+    static FORCE_INLINE FRegister sqrt(FRegister a) { return vsqrtq_f64(a); }
+    static FORCE_INLINE FRegister inverseSqrtEstimate(FRegister a) { return vrsqrteq_f64(a); }
+    static FORCE_INLINE FRegister min(FRegister a, FRegister b) { return vminq_f64(a, b); }
+    static FORCE_INLINE FRegister max(FRegister a, FRegister b) { return vmaxq_f64(a, b); }
+    static FORCE_INLINE FMaskRegister greater(FRegister a, FRegister b) { return vcgtq_f64(a, b); }
+    static FORCE_INLINE FMaskRegister greaterEqual(FRegister a, FRegister b) { return vcgeq_f64(a, b); }
+    static FORCE_INLINE FMaskRegister equal(FRegister a, FRegister b) { return vceqq_f64(a, b); }
+    static FORCE_INLINE FMaskRegister maskAnd(FMaskRegister a, FMaskRegister b) { return vandq_u64(a, b); }
+    static FORCE_INLINE FMaskRegister maskOr(FMaskRegister a, FMaskRegister b) { return vorrq_u64(a, b); }
+    static FORCE_INLINE FMaskRegister maskNot(FMaskRegister a) { return veorq_u64(a, vdupq_n_u64(~uint64_t{0})); }
+    static FORCE_INLINE FRegister select(FMaskRegister mask, FRegister ifTrue, FRegister ifFalse) { return vbslq_f64(mask, ifTrue, ifFalse); }
+    static FORCE_INLINE unsigned getMaskBits(FMaskRegister mask)
+    {
+        return static_cast<unsigned>((vgetq_lane_u64(mask, 0) >> 63) | ((vgetq_lane_u64(mask, 1) >> 63) << 1));
+    }
+    
+    static FORCE_INLINE void loadInterleaved(const FReal* values, FRegister& x, FRegister& y, FRegister& z)
+    {
+        const float64x2x3_t vectors = vld3q_f64(values);
+        x = vectors.val[0];
+        y = vectors.val[1];
+        z = vectors.val[2];
+    }
+    static FORCE_INLINE void storeInterleaved(FReal* values, FRegister x, FRegister y, FRegister z) { vst3q_f64(values, float64x2x3_t{{x, y, z}}); }
+    
+#elif defined(__ARM_NEON) && defined(__aarch64__) && !GE_FIXED_PRECISION
+    using FRegister = float32x4_t;
+    using FMaskRegister = uint32x4_t;
+    static constexpr ESimdInstructionSet InstructionSet = ESimdInstructionSet::NEON;
+    static constexpr size_t NumberOfLanes = 4;
+    static constexpr unsigned NumberOfNewtonSteps = 2;
+    
+    static FORCE_INLINE FRegister load(const FReal* values) { return vld1q_f32(values); }
+    static FORCE_INLINE void store(FReal* values, FRegister a) { vst1q_f32(values, a); }
+    static FORCE_INLINE FRegister set(FReal value) { return vdupq_n_f32(value); }
+    static FORCE_INLINE FRegister add(FRegister a, FRegister b) { return vaddq_f32(a, b); }
+    static FORCE_INLINE FRegister subtract(FRegister a, FRegister b) { return vsubq_f32(a, b); }
+    static FORCE_INLINE FRegister multiply(FRegister a, FRegister b) { return vmulq_f32(a, b); }
+    static FORCE_INLINE FRegister divide(FRegister a, FRegister b) { return vdivq_f32(a, b); }
+    static FORCE_INLINE FRegister sqrt(FRegister a) { return vsqrtq_f32(a); }
+    static FORCE_INLINE FRegister inverseSqrtEstimate(FRegister a) { return vrsqrteq_f32(a); }
+    static FORCE_INLINE FRegister min(FRegister a, FRegister b) { return vminq_f32(a, b); }
+    static FORCE_INLINE FRegister max(FRegister a, FRegister b) { return vmaxq_f32(a, b); }
+    static FORCE_INLINE FMaskRegister greater(FRegister a, FRegister b) { return vcgtq_f32(a, b); }
+    static FORCE_INLINE FMaskRegister greaterEqual(FRegister a, FRegister b) { return vcgeq_f32(a, b); }
+    static FORCE_INLINE FMaskRegister equal(FRegister a, FRegister b) { return vceqq_f32(a, b); }
+    static FORCE_INLINE FMaskRegister maskAnd(FMaskRegister a, FMaskRegister b) { return vandq_u32(a, b); }
+    static FORCE_INLINE FMaskRegister maskOr(FMaskRegister a, FMaskRegister b) { return vorrq_u32(a, b); }
+    static FORCE_INLINE FMaskRegister maskNot(FMaskRegister a) { return vmvnq_u32(a); }
+    static FORCE_INLINE FRegister select(FMaskRegister mask, FRegister ifTrue, FRegister ifFalse) { return vbslq_f32(mask, ifTrue, ifFalse); }
+    static FORCE_INLINE unsigned getMaskBits(FMaskRegister mask)
+    {
+        // Each lane keeps its own bit, then the lanes are summed.
+        const int32_t shifts[4] = {0, 1, 2, 3};
+        return vaddvq_u32(vshlq_u32(vshrq_n_u32(mask, 31), vld1q_s32(shifts)));
+    }
+    
+    static FORCE_INLINE void loadInterleaved(const FReal* values, FRegister& x, FRegister& y, FRegister& z)
+    {
+        const float32x4x3_t vectors = vld3q_f32(values);
+        x = vectors.val[0];
+        y = vectors.val[1];
+        z = vectors.val[2];
+    }
+    static FORCE_INLINE void storeInterleaved(FReal* values, FRegister x, FRegister y, FRegister z) { vst3q_f32(values, float32x4x3_t{{x, y, z}}); }
+    
+#else
+    using FRegister = FReal;
+    using FMaskRegister = bool;
+    static constexpr ESimdInstructionSet InstructionSet = ESimdInstructionSet::Scalar;
+    static constexpr size_t NumberOfLanes = 1;
+    static constexpr unsigned NumberOfNewtonSteps = 0;
+    
+    static FORCE_INLINE FRegister load(const FReal* values) { return *values; }
+    static FORCE_INLINE void store(FReal* values, FRegister a) { *values = a; }
+    static FORCE_INLINE FRegister set(FReal value) { return value; }
+    static FORCE_INLINE FRegister add(FRegister a, FRegister b) { return a + b; }
+    static FORCE_INLINE FRegister subtract(FRegister a, FRegister b) { return a - b; }
+    static FORCE_INLINE FRegister multiply(FRegister a, FRegister b) { return a * b; }
+    static FORCE_INLINE FRegister divide(FRegister a, FRegister b) { return a / b; }
+    static FORCE_INLINE FRegister sqrt(FRegister a) { return Math::sqrt(a); }
+    static FORCE_INLINE FRegister inverseSqrtEstimate(FRegister a) { return Math::inverseSqrt(a); }
+    static FORCE_INLINE FRegister min(FRegister a, FRegister b) { return (a < b) ? a : b; }
+    static FORCE_INLINE FRegister max(FRegister a, FRegister b) { return (a > b) ? a : b; }
+    static FORCE_INLINE FMaskRegister greater(FRegister a, FRegister b) { return a > b; }
+    static FORCE_INLINE FMaskRegister greaterEqual(FRegister a, FRegister b) { return a >= b; }
+    static FORCE_INLINE FMaskRegister equal(FRegister a, FRegister b) { return a == b; }
+    static FORCE_INLINE FMaskRegister maskAnd(FMaskRegister a, FMaskRegister b) { return a && b; }
+    static FORCE_INLINE FMaskRegister maskOr(FMaskRegister a, FMaskRegister b) { return a || b; }
+    static FORCE_INLINE FMaskRegister maskNot(FMaskRegister a) { return !a; }
+    static FORCE_INLINE FRegister select(FMaskRegister mask, FRegister ifTrue, FRegister ifFalse) { return mask ? ifTrue : ifFalse; }
+    static FORCE_INLINE unsigned getMaskBits(FMaskRegister mask) { return mask ? 1u : 0u; }
+    
+    static FORCE_INLINE void loadInterleaved(const FReal* values, FRegister& x, FRegister& y, FRegister& z) { x = values[0]; y = values[1]; z = values[2]; }
+    static FORCE_INLINE void storeInterleaved(FReal* values, FRegister x, FRegister y, FRegister z) { values[0] = x; values[1] = y; values[2] = z; }
+    
+#endif
+    
+    /** The value of getMaskBits() when every lane is set. */
+    static constexpr unsigned AllMaskBits = (1u << NumberOfLanes) - 1;
+};
+
+/**
+ * A packet of FSimdBackend::NumberOfLanes booleans, the result of comparing FRealN packets.
+ */
+class FMaskN
+{
+public:
+    FORCE_INLINE explicit FMaskN(FSimdBackend::FMaskRegister mask) : Mask(mask) {}
+    
+    /** Returns whether any lane is set. */
+    FORCE_INLINE bool isAnySet() const { return FSimdBackend::getMaskBits(Mask) != 0; }
+    
+    /** Returns whether every lane is set. */
+    FORCE_INLINE bool isAllSet() const { return FSimdBackend::getMaskBits(Mask) == FSimdBackend::AllMaskBits; }
+    
+    /** Returns one bit per lane, the first lane being the lowest bit. */
+    FORCE_INLINE unsigned getBits() const { return FSimdBackend::getMaskBits(Mask); }
+    
+    FORCE_INLINE friend FMaskN operator&(const FMaskN& lhs, const FMaskN& rhs) { return FMaskN{FSimdBackend::maskAnd(lhs.Mask, rhs.Mask)}; }
+    FORCE_INLINE friend FMaskN operator|(const FMaskN& lhs, const FMaskN& rhs) { return FMaskN{FSimdBackend::maskOr(lhs.Mask, rhs.Mask)}; }
+    FORCE_INLINE friend FMaskN operator~(const FMaskN& mask) { return FMaskN{FSimdBackend::maskNot(mask.Mask)}; }
+    
+public:
+    FSimdBackend::FMaskRegister Mask;
+};
+
+/**
+ * A packet of FSimdBackend::NumberOfLanes reals, processed by one instruction per operation.
+ * Scalars convert implicitly to packets holding them in every lane.
+ */
+class FRealN
+{
+public:
+    /** The number of reals in a packet. */
+    static constexpr size_t NumberOfLanes = FSimdBackend::NumberOfLanes;
+    
+public:
+    /**
+     * Default constructor (no initialization).
+     */
+    FORCE_INLINE FRealN() {}
+    
+    /**
+     * Constructor setting every lane to the same value.
+     *
+     * @param value The value of every lane.
+     */
+    FORCE_INLINE FRealN(FReal value) : Value(FSimdBackend::set(value)) {}
+    
+    /**
+     * Loads NumberOfLanes consecutive reals, with no alignment requirement.
+     *
+     * @param values The first real.
+     */
+    FORCE_INLINE static FRealN load(const FReal* values)
+    {
+        FRealN result;
+        result.Value = FSimdBackend::load(values);
+        return result;
+    }
+    
+    /**
+     * Stores the lanes to NumberOfLanes consecutive reals, with no alignment requirement.
+     *
+     * @param values The first real.
+     */
+    FORCE_INLINE void store(FReal* values) const
+    {
+        FSimdBackend::store(values, Value);
+    }
+    
+    /**
+     * Loads fewer than NumberOfLanes consecutive reals, e.g. at the end of an array; the remaining lanes are zero.
+     *
+     * @param values The first real.
+     * @param count The number of reals to load.
+     */
+    FORCE_INLINE static FRealN loadPartial(const FReal* values, size_t count)
+    {
+        FReal lanes[NumberOfLanes] = {};
+        for (size_t lane = 0; lane < count; ++lane)
+        {
+            lanes[lane] = values[lane];
+        }
+        return load(lanes);
+    }
+    
+    /**
+     * Stores the first lanes to fewer than NumberOfLanes consecutive reals, e.g. at the end of an array.
+     *
+     * @param values The first real.
+     * @param count The number of reals to store.
+     */
+    FORCE_INLINE void storePartial(FReal* values, size_t count) const
+    {
+        FReal lanes[NumberOfLanes];
+        store(lanes);
+        for (size_t lane = 0; lane < count; ++lane)
+        {
+            values[lane] = lanes[lane];
+        }
+    }
+    
+    /**
+     * Returns one of the lanes. It is slow: packets are meant to be stored as a whole.
+     *
+     * @param lane The index of the lane.
+     */
+    FORCE_INLINE FReal getLane(size_t lane) const
+    {
+        FReal lanes[NumberOfLanes];
+        store(lanes);
+        return lanes[lane];
+    }
+    
+    /**
+     * Stores the lanes whose mask is set, leaving the other reals unchanged.
+     *
+     * @param values The first real. All NumberOfLanes reals must be readable and writable.
+     * @param mask The lanes to store.
+     */
+    FORCE_INLINE void storeMasked(FReal* values, const FMaskN& mask) const
+    {
+        FSimdBackend::store(values, FSimdBackend::select(mask.Mask, Value, FSimdBackend::load(values)));
+    }
+    
+    /**
+     * Returns, lane by lane, ifTrue where the mask is set and ifFalse elsewhere.
+     */
+    FORCE_INLINE static FRealN select(const FMaskN& mask, const FRealN& ifTrue, const FRealN& ifFalse)
+    {
+        FRealN result;
+        result.Value = FSimdBackend::select(mask.Mask, ifTrue.Value, ifFalse.Value);
+        return result;
+    }
+    
+    FORCE_INLINE FRealN& operator+=(const FRealN& rhs) { Value = FSimdBackend::add(Value, rhs.Value); return *this; }
+    FORCE_INLINE FRealN& operator-=(const FRealN& rhs) { Value = FSimdBackend::subtract(Value, rhs.Value); return *this; }
+    FORCE_INLINE FRealN& operator*=(const FRealN& rhs) { Value = FSimdBackend::multiply(Value, rhs.Value); return *this; }
+    FORCE_INLINE FRealN& operator/=(const FRealN& rhs) { Value = FSimdBackend::divide(Value, rhs.Value); return *this; }
+    
+    FORCE_INLINE friend FRealN operator+(FRealN lhs, const FRealN& rhs) { return lhs += rhs; }
+    FORCE_INLINE friend FRealN operator-(FRealN lhs, const FRealN& rhs) { return lhs -= rhs; }
+    FORCE_INLINE friend FRealN operator*(FRealN lhs, const FRealN& rhs) { return lhs *= rhs; }
+    FORCE_INLINE friend FRealN operator/(FRealN lhs, const FRealN& rhs) { return lhs /= rhs; }
+    FORCE_INLINE friend FRealN operator-(const FRealN& value) { return FRealN{Zero} - value; }
+    
+    FORCE_INLINE friend FMaskN operator>(const FRealN& lhs, const FRealN& rhs) { return FMaskN{FSimdBackend::greater(lhs.Value, rhs.Value)}; }
+    FORCE_INLINE friend FMaskN operator>=(const FRealN& lhs, const FRealN& rhs) { return FMaskN{FSimdBackend::greaterEqual(lhs.Value, rhs.Value)}; }
+    FORCE_INLINE friend FMaskN operator<(const FRealN& lhs, const FRealN& rhs) { return FMaskN{FSimdBackend::greater(rhs.Value, lhs.Value)}; }
+    FORCE_INLINE friend FMaskN operator<=(const FRealN& lhs, const FRealN& rhs) { return FMaskN{FSimdBackend::greaterEqual(rhs.Value, lhs.Value)}; }
+    FORCE_INLINE friend FMaskN operator==(const FRealN& lhs, const FRealN& rhs) { return FMaskN{FSimdBackend::equal(lhs.Value, rhs.Value)}; }
+    
+public:
+    FSimdBackend::FRegister Value;
+};
+
+FORCE_INLINE FRealN sqrt(const FRealN& value)
+{
+    FRealN result;
+    result.Value = FSimdBackend::sqrt(value.Value);
+    return result;
+}
+
+/**
+ * Returns 1 / sqrt(value) in each lane, see Math::inverseSqrt().
+ */
+FORCE_INLINE FRealN inverseSqrt(const FRealN& value)
+{
+    return FRealN{One} / sqrt(value);
+}
+
+/**
+ * Returns 1 / sqrt(value) in each lane, see Math::fastInverseSqrt(). The lanes must be positive and finite.
+ * If any lane is out of float's normal range, the whole packet takes the exact path.
+ */
+FORCE_INLINE FRealN fastInverseSqrt(const FRealN& value)
+{
+    FMaskN isInRange = (value >= (FReal) std::numeric_limits<float>::min());
+    if constexpr (sizeof(FReal) > sizeof(float))
+    {
+        isInRange = isInRange & (value <= (FReal) std::numeric_limits<float>::max());
+    }
+    if (!isInRange.isAllSet())
+    {
+        return inverseSqrt(value);
+    }
+    
+    FRealN estimate;
+    estimate.Value = FSimdBackend::inverseSqrtEstimate(value.Value);
+    return refineInverseSqrt<FSimdBackend::NumberOfNewtonSteps>(value, estimate);
+}
+
+FORCE_INLINE FRealN min(const FRealN& lhs, const FRealN& rhs)
+{
+    FRealN result;
+    result.Value = FSimdBackend::min(lhs.Value, rhs.Value);
+    return result;
+}
+
+FORCE_INLINE FRealN max(const FRealN& lhs, const FRealN& rhs)
+{
+    FRealN result;
+    result.Value = FSimdBackend::max(lhs.Value, rhs.Value);
+    return result;
+}
+
+}   // End of namespace Math
+}   // End of namespace GE
@@ -12,7 +12,15 @@ namespace GE
 namespace Math
 {
 
-const FVector3 FVector3::ZeroVector{0,0,0};
+template class TVector3<FReal>;
+template class TVector3<FReal, true>;
+#if GE_MIXED_PRECISION
+template class TVector3<FPositionReal>;
+template class TVector3<FPositionReal, true>;
+#endif
+
+static_assert(sizeof(FVector3) == 3 * sizeof(FReal), "Packed vectors must not be padded.");
+static_assert(sizeof(FAlignedVector3) == 4 * sizeof(FReal) && alignof(FAlignedVector3) == 4 * sizeof(FReal), "Padded vectors must be aligned to their size.");
 
 }   // End of namespace Math
 }   // End of namespace GE
@@ -12,45 +12,64 @@
 #include "Math.hpp"
 #include "UtilMacros.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <type_traits>
 
 namespace GE
 {
 namespace Math
 {
 
-class FVector3
+/** The padding of vectors that are not padded: it takes no room. */
+struct FNoVector3Padding
+{
+};
+
+/**
+ * A vector of 3 components. Use FVector3, or FPositionVector3 for positions: they differ in mixed precision builds, see Precision.hpp.
+ * Vectors of a wider type convert implicitly from narrower ones, while the opposite conversion must be explicit.
+ *
+ * Padded vectors have a fourth component, W, always zero, and are aligned to their size: 16 bytes in single precision, 32 in double.
+ * Arrays of them never straddle cache lines and each vector loads into a single SIMD register, at the cost of a third more memory.
+ * See FAlignedVector3. Padded and packed vectors of the same precision convert implicitly into each other.
+ */
+template<Arithmetic TReal, bool IsPadded = false>
+class alignas(IsPadded ? 4 * sizeof(TReal) : alignof(TReal)) TVector3
 {
 public:
     /** A zero vector (0,0,0) */
-    static const FVector3 ZeroVector;
+    static const TVector3 ZeroVector;
     
 public:
     union
     {
         struct
         {
-            FReal X;
-            FReal Y;
-            FReal Z;
+            TReal X;
+            TReal Y;
+            TReal Z;
         };
         
         [[deprecated("For internal use only.")]]
-        FReal XYZ[3];
+        TReal XYZ[3];
     };
+    
+    /** The fourth component of padded vectors, always zero; an empty member otherwise. */
+    [[no_unique_address]] std::conditional_t<IsPadded, TReal, FNoVector3Padding> W{};
 
 public:
     /** 
      * Default constructor (no initialization).
      */
-    FORCE_INLINE FVector3() {}
+    FORCE_INLINE TVector3() {}
 
     /** 
      * Constructor initializing all components to a single value.
      *
      * @param InV Value to set all components to.
      */
-    FORCE_INLINE explicit FVector3(FReal InV) : X(InV), Y(InV), Z(InV) {}
+    FORCE_INLINE explicit TVector3(TReal InV) : X(InV), Y(InV), Z(InV) {}
     
     /**
      * Constructor using initial values for each component.
@@ -59,7 +78,16 @@ public:
      * @param InY Value to set Y component to.
      * @param InZ Value to set Z component to.
      */
-    FORCE_INLINE FVector3(FReal InX, FReal InY, FReal InZ) : X(InX), Y(InY), Z(InZ) {}
+    FORCE_INLINE TVector3(TReal InX, TReal InY, TReal InZ) : X(InX), Y(InY), Z(InZ) {}
+    
+    /**
+     * Constructor converting a vector of another precision or padding. It is explicit when some precision may be lost.
+     *
+     * @param vector The vector to convert.
+     */
+    template<Arithmetic TOther, bool IsOtherPadded>
+    FORCE_INLINE explicit(sizeof(TOther) > sizeof(TReal)) TVector3(const TVector3<TOther, IsOtherPadded>& vector)
+        : X(static_cast<TReal>(vector.X)), Y(static_cast<TReal>(vector.Y)), Z(static_cast<TReal>(vector.Z)) {}
     
     /**
      * Multiply all components of the vector by -one.
@@ -84,30 +112,69 @@ public:
      *
      * @return The magnitude.
      */
-    FORCE_INLINE FReal magnitude() const
+    FORCE_INLINE TReal magnitude() const
     {
-        return Math::sqrt(X*X + Y*Y + Z*Z);
+        if constexpr (FixedPoint<TReal>)
+        {
+            TReal largest;
+            const TReal rescaledSquareMagnitude = getRescaledSquareMagnitude(largest);
+            return largest * Math::sqrt(rescaledSquareMagnitude);
+        }
+        else
+        {
+            return Math::sqrt(X*X + Y*Y + Z*Z);
+        }
     }
     
     /**
-     * Returns the squared magnitude of this vector.
+     * Returns the squared magnitude of this vector. In fixed point, it saturates to max() when out of range.
      *
      * @return The squared magnitude.
      */
-    FORCE_INLINE FReal squareMagnitude() const
+    FORCE_INLINE TReal squareMagnitude() const
     {
-        return X*X + Y*Y + Z*Z;
+        if constexpr (FixedPoint<TReal>)
+        {
+            TReal largest;
+            const TReal rescaledSquareMagnitude = getRescaledSquareMagnitude(largest);
+            return (largest * largest) * rescaledSquareMagnitude;
+        }
+        else
+        {
+            return X*X + Y*Y + Z*Z;
+        }
     }
     
     /**
      * Turns a non-zero vector into a vector of unit length.
+     *
+     * @param accuracy How accurately, see ENormalization. Hot paths may opt in to ENormalization::Fast.
      */
-    FORCE_INLINE void normalize()
+    FORCE_INLINE void normalize(ENormalization accuracy = ENormalization::Exact)
     {
-        FReal m = magnitude();
+        // In fixed point, the fast path is not faster, and the squared magnitude may be out of range.
+        if ((accuracy == ENormalization::Fast) && !FixedPoint<TReal>)
+        {
+            const TReal squareM = squareMagnitude();
+            if (squareM > 0)
+            {
+                (*this) *= Math::fastInverseSqrt(squareM);
+            }
+            return;
+        }
+        
+        TReal m = magnitude();
         if (m > 0)
         {
-            (*this) *= Math::One / m;
+            // In fixed point, the reciprocal of a large magnitude keeps few significant bits, so divide instead.
+            if constexpr (FixedPoint<TReal>)
+            {
+                (*this) = (*this) / m;
+            }
+            else
+            {
+                (*this) *= Math::One / m;
+            }
         }
     }
     
@@ -117,7 +184,7 @@ public:
      * @param vector The vector to add this vector to.
      * @return Copy of the result after addition.
      */
-    FORCE_INLINE FVector3 operator+=(const FVector3& vector)
+    FORCE_INLINE TVector3 operator+=(const TVector3& vector)
     {
         X += vector.X;
         Y += vector.Y;
@@ -131,7 +198,7 @@ public:
      * @param vector The vector to add this vector to.
      * @return Copy of the result after subtraction.
      */
-    FORCE_INLINE FVector3 operator-=(const FVector3& vector)
+    FORCE_INLINE TVector3 operator-=(const TVector3& vector)
     {
         X -= vector.X;
         Y -= vector.Y;
@@ -146,7 +213,7 @@ public:
      * @return Copy of the vector after scaling.
      */
     template <Arithmetic TArg>
-    FORCE_INLINE FVector3 operator*=(const TArg scale)
+    FORCE_INLINE TVector3 operator*=(const TArg scale)
     {
         X *= scale;
         Y *= scale;
@@ -160,9 +227,9 @@ public:
      * @param vector The vector to add this vector to.
      * @return Copy of the result after addition
      */
-    FORCE_INLINE FVector3 operator+(const FVector3& vector) const
+    FORCE_INLINE TVector3 operator+(const TVector3& vector) const
     {
-        return FVector3(X + vector.X, Y + vector.Y, Z + vector.Z);
+        return TVector3(X + vector.X, Y + vector.Y, Z + vector.Z);
     }
     
     /**
@@ -171,9 +238,9 @@ public:
      * @param vector The vector to add this vector to.
      * @return Copy of the result after subtraction
      */
-    FORCE_INLINE FVector3 operator-(const FVector3& vector) const
+    FORCE_INLINE TVector3 operator-(const TVector3& vector) const
     {
-        return FVector3(X - vector.X, Y - vector.Y, Z - vector.Z);
+        return TVector3(X - vector.X, Y - vector.Y, Z - vector.Z);
     }
     
     /**
@@ -183,9 +250,9 @@ public:
      * @return Copy of the vector after scaling.
      */
     template <Arithmetic TArg>
-    FORCE_INLINE FVector3 operator*(const TArg scale) const
+    FORCE_INLINE TVector3 operator*(const TArg scale) const
     {
-        return FVector3(X*scale, Y*scale, Z*scale);
+        return TVector3(X*scale, Y*scale, Z*scale);
     }
     
     /**
@@ -194,9 +261,9 @@ public:
      * @param vector The given vector to multiply with.
      * @return A copy of the result.
      */
-    FORCE_INLINE FVector3 operator^(const FVector3& vector) const
+    FORCE_INLINE TVector3 operator^(const TVector3& vector) const
     {
-        return FVector3(Y*vector.Z - Z*vector.Y, Z*vector.X - X*vector.Z, X*vector.Y - Y*vector.X);
+        return TVector3(Y*vector.Z - Z*vector.Y, Z*vector.X - X*vector.Z, X*vector.Y - Y*vector.X);
     }
     
     /**
@@ -206,9 +273,9 @@ public:
      * @return Copy of the vector after subdivision.
      */
     template <Arithmetic TArg>
-    FORCE_INLINE FVector3 operator/(const TArg scale) const
+    FORCE_INLINE TVector3 operator/(const TArg scale) const
     {
-        return FVector3(X/scale, Y/scale, Z/scale);
+        return TVector3(X/scale, Y/scale, Z/scale);
     }
     
     /**
@@ -217,7 +284,7 @@ public:
      * @param vector The other vector.
      * @return The result of the dot product.
      */
-    FORCE_INLINE FReal operator|(const FVector3& vector) const
+    FORCE_INLINE TReal operator|(const TVector3& vector) const
     {
         return X*vector.X + Y*vector.Y + Z*vector.Z;
     }
@@ -227,7 +294,7 @@ public:
      *
      * @param vector The other vector.
      */
-    FORCE_INLINE void operator^=(const FVector3& vector)
+    FORCE_INLINE void operator^=(const TVector3& vector)
     {
         *this = crossProduct(vector);
     }
@@ -238,7 +305,7 @@ public:
      * @param vector The other vector.
      * @return The result of the dot product.
      */
-    FORCE_INLINE FReal dotProduct(const FVector3& vector) const
+    FORCE_INLINE TReal dotProduct(const TVector3& vector) const
     {
         return *this | vector;
     }
@@ -249,9 +316,9 @@ public:
      * @param vector The given vector to multiply with.
      * @return A copy of the result.
      */
-    FORCE_INLINE FVector3 componentProduct(const FVector3& vector) const
+    FORCE_INLINE TVector3 componentProduct(const TVector3& vector) const
     {
-        return FVector3(X*vector.X, Y*vector.Y, Z*vector.Z);
+        return TVector3(X*vector.X, Y*vector.Y, Z*vector.Z);
     }
     
     /**
@@ -260,7 +327,7 @@ public:
      * @param vector The given vector to multiply with.
      * @return A copy of the result.
      */
-    FORCE_INLINE FVector3 crossProduct(const FVector3& vector) const
+    FORCE_INLINE TVector3 crossProduct(const TVector3& vector) const
     {
         return *this ^ vector;
     }
@@ -270,7 +337,7 @@ public:
      *
      * @param vector The given vector to multiply with.
      */
-    FORCE_INLINE void componentProductUpdate(const FVector3& vector)
+    FORCE_INLINE void componentProductUpdate(const TVector3& vector)
     {
         X *= vector.X;
         Y *= vector.Y;
@@ -284,7 +351,7 @@ public:
      * @param scale The scale.
      */
     template <Arithmetic TArg>
-    FORCE_INLINE void addScaledVector(const TArg scale, const FVector3& vector)
+    FORCE_INLINE void addScaledVector(const TArg scale, const TVector3& vector)
     {
         X += vector.X * scale;
         Y += vector.Y * scale;
@@ -300,7 +367,7 @@ public:
      * @param yAxis The input basis' y axis, and upon return the orthonormal basis' y axis.
      * @param zAxis Any vector, and upon return the orthonormal basis' z axis.
      */
-    FORCE_INLINE static void makeOrthonormalBasis(FVector3* xAxis, FVector3* yAxis, FVector3* zAxis)
+    FORCE_INLINE static void makeOrthonormalBasis(TVector3* xAxis, TVector3* yAxis, TVector3* zAxis)
     {
         xAxis->normalize();
         (*zAxis) = (*xAxis) ^ (*yAxis);
@@ -313,12 +380,48 @@ public:
     }
     
 private:
-    friend std::ostream& operator<<(std::ostream& ostream, const FVector3& vector)
+    /**
+     * Returns the squared magnitude of this vector divided by the square of its largest component, in [1, 3], or zero for a zero vector.
+     * Fixed-point squares overflow from about sqrt(max()) and vanish below sqrt(epsilon()), so the components are rescaled before squaring.
+     *
+     * @param largest Upon return, the largest absolute value of the components.
+     */
+    FORCE_INLINE TReal getRescaledSquareMagnitude(TReal& largest) const
+    {
+        largest = std::max({Math::abs(X), Math::abs(Y), Math::abs(Z)});
+        if (largest == Zero)
+        {
+            return Zero;
+        }
+        
+        const TReal x = X / largest;
+        const TReal y = Y / largest;
+        const TReal z = Z / largest;
+        return x*x + y*y + z*z;
+    }
+    
+    friend std::ostream& operator<<(std::ostream& ostream, const TVector3& vector)
     {
         ostream << "[" << vector.X << "," << vector.Y << "," << vector.Z << "]";
         return ostream;
     }
-};  // End of class FVector3
+};  // End of class TVector3
+
+template<Arithmetic TReal, bool IsPadded>
+const TVector3<TReal, IsPadded> TVector3<TReal, IsPadded>::ZeroVector{0, 0, 0};
+
+/** The vector type of the engine. */
+using FVector3 = TVector3<FReal>;
+
+/** The vector type of positions. */
+using FPositionVector3 = TVector3<FPositionReal>;
+
+/** The padded vector type, for arrays that SIMD code walks through one vector at a time. */
+using FAlignedVector3 = TVector3<FReal, true>;
+
+/** The padded vector type of positions. */
+using FAlignedPositionVector3 = TVector3<FPositionReal, true>;
+
 
 }   // End of namespace Math
 }   // End of namespace GE
@@ -0,0 +1,55 @@
+//
+//  Vector3xN.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "Vector3xN.hpp"
+
+namespace GE
+{
+namespace Math
+{
+
+static_assert(sizeof(FVector3xN) == 3 * sizeof(FRealN), "The components of a packet must not be padded.");
+
+namespace
+{
+
+template<ENormalization Accuracy>
+void normalizeAll(std::span<FVector3> vectors)
+{
+    size_t index = 0;
+    for (; index + FVector3xN::NumberOfLanes <= vectors.size(); index += FVector3xN::NumberOfLanes)
+    {
+        FVector3xN packet = FVector3xN::gather(&vectors[index]);
+        packet.normalize(Accuracy);
+        packet.scatter(&vectors[index]);
+    }
+    
+    // The remaining vectors go through the same arithmetic, one per packet.
+    for (; index < vectors.size(); ++index)
+    {
+        FVector3xN packet{vectors[index]};
+        packet.normalize(Accuracy);
+        vectors[index] = packet.getLane(0);
+    }
+}
+
+}   // End of anonymous namespace
+
+void normalize(std::span<FVector3> vectors, ENormalization accuracy)
+{
+    if (accuracy == ENormalization::Fast)
+    {
+        normalizeAll<ENormalization::Fast>(vectors);
+    }
+    else
+    {
+        normalizeAll<ENormalization::Exact>(vectors);
+    }
+}
+
+}   // End of namespace Math
+}   // End of namespace GE
@@ -0,0 +1,327 @@
+//
+//  Vector3xN.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Precision.hpp"
+#include "Math.hpp"
+#include "SimdReal.hpp"
+#include "UtilMacros.hpp"
+#include "Vector3.hpp"
+
+// STD library includes.
+#include <cstddef>
+#include <span>
+
+namespace GE
+{
+namespace Math
+{
+
+/**
+ * A packet of FRealN::NumberOfLanes vectors, their X, Y and Z components stored in separate SIMD registers.
+ * It has the operators of FVector3, each processing all the lanes at once, so batch kernels are written once against it
+ * and compile to SSE2, AVX2, NEON or plain scalars, see FSimdBackend. Where FVector3 would branch, lanes are selected with masks.
+ */
+class FVector3xN
+{
+public:
+    /** The number of vectors in a packet. */
+    static constexpr size_t NumberOfLanes = FRealN::NumberOfLanes;
+    
+    static_assert(sizeof(FVector3) == 3 * sizeof(FReal), "gather() and scatter() read arrays of FVector3 as flat FReal arrays.");
+    
+public:
+    FRealN X;
+    FRealN Y;
+    FRealN Z;
+    
+public:
+    /**
+     * Default constructor (no initialization).
+     */
+    FORCE_INLINE FVector3xN() {}
+    
+    /**
+     * Constructor using initial values for each component.
+     *
+     * @param InX Value to set X component to.
+     * @param InY Value to set Y component to.
+     * @param InZ Value to set Z component to.
+     */
+    FORCE_INLINE FVector3xN(const FRealN& InX, const FRealN& InY, const FRealN& InZ) : X(InX), Y(InY), Z(InZ) {}
+    
+    /**
+     * Constructor setting every lane to the same vector.
+     *
+     * @param vector The vector of every lane.
+     */
+    FORCE_INLINE explicit FVector3xN(const FVector3& vector) : X(vector.X), Y(vector.Y), Z(vector.Z) {}
+    
+    /**
+     * Loads NumberOfLanes vectors from a structure of arrays.
+     *
+     * @param xs The first X component.
+     * @param ys The first Y component.
+     * @param zs The first Z component.
+     */
+    FORCE_INLINE static FVector3xN load(const FReal* xs, const FReal* ys, const FReal* zs)
+    {
+        return FVector3xN{FRealN::load(xs), FRealN::load(ys), FRealN::load(zs)};
+    }
+    
+    /**
+     * Loads fewer than NumberOfLanes vectors from a structure of arrays; the remaining lanes are zero.
+     *
+     * @param count The number of vectors to load.
+     */
+    FORCE_INLINE static FVector3xN loadPartial(const FReal* xs, const FReal* ys, const FReal* zs, size_t count)
+    {
+        return FVector3xN{FRealN::loadPartial(xs, count), FRealN::loadPartial(ys, count), FRealN::loadPartial(zs, count)};
+    }
+    
+    /**
+     * Loads NumberOfLanes consecutive FVector3, transposing them in registers, see FSimdBackend::loadInterleaved().
+     *
+     * @param vectors The first vector.
+     */
+    FORCE_INLINE static FVector3xN gather(const FVector3* vectors)
+    {
+        FVector3xN packet;
+        FSimdBackend::loadInterleaved(reinterpret_cast<const FReal*>(vectors), packet.X.Value, packet.Y.Value, packet.Z.Value);
+        return packet;
+    }
+    
+    /**
+     * Stores the lanes to a structure of arrays.
+     *
+     * @param xs The first X component.
+     * @param ys The first Y component.
+     * @param zs The first Z component.
+     */
+    FORCE_INLINE void store(FReal* xs, FReal* ys, FReal* zs) const
+    {
+        X.store(xs);
+        Y.store(ys);
+        Z.store(zs);
+    }
+    
+    /**
+     * Stores the first lanes to a structure of arrays holding fewer than NumberOfLanes vectors.
+     *
+     * @param count The number of vectors to store.
+     */
+    FORCE_INLINE void storePartial(FReal* xs, FReal* ys, FReal* zs, size_t count) const
+    {
+        X.storePartial(xs, count);
+        Y.storePartial(ys, count);
+        Z.storePartial(zs, count);
+    }
+    
+    /**
+     * Stores the lanes whose mask is set to a structure of arrays, leaving the other vectors unchanged.
+     *
+     * @param mask The lanes to store.
+     */
+    FORCE_INLINE void storeMasked(FReal* xs, FReal* ys, FReal* zs, const FMaskN& mask) const
+    {
+        X.storeMasked(xs, mask);
+        Y.storeMasked(ys, mask);
+        Z.storeMasked(zs, mask);
+    }
+    
+    /**
+     * Stores the lanes to NumberOfLanes consecutive FVector3, transposing them in registers, see FSimdBackend::storeInterleaved().
+     *
+     * @param vectors The first vector.
+     */
+    FORCE_INLINE void scatter(FVector3* vectors) const
+    {
+        FSimdBackend::storeInterleaved(reinterpret_cast<FReal*>(vectors), X.Value, Y.Value, Z.Value);
+    }
+    
+    /**
+     * Stores the first lanes to fewer than NumberOfLanes consecutive FVector3. The components are moved one by one.
+     *
+     * @param vectors The first vector.
+     * @param count The number of vectors to store.
+     */
+    FORCE_INLINE void scatterPartial(FVector3* vectors, size_t count) const
+    {
+        FReal xs[NumberOfLanes];
+        FReal ys[NumberOfLanes];
+        FReal zs[NumberOfLanes];
+        store(xs, ys, zs);
+        for (size_t lane = 0; lane < count; ++lane)
+        {
+            vectors[lane] = FVector3{xs[lane], ys[lane], zs[lane]};
+        }
+    }
+    
+    /**
+     * Returns one of the lanes. It is slow: packets are meant to be stored as a whole.
+     *
+     * @param lane The index of the lane.
+     */
+    FORCE_INLINE FVector3 getLane(size_t lane) const
+    {
+        return FVector3{X.getLane(lane), Y.getLane(lane), Z.getLane(lane)};
+    }
+    
+    /**
+     * Returns, lane by lane, ifTrue where the mask is set and ifFalse elsewhere.
+     */
+    FORCE_INLINE static FVector3xN select(const FMaskN& mask, const FVector3xN& ifTrue, const FVector3xN& ifFalse)
+    {
+        return FVector3xN{FRealN::select(mask, ifTrue.X, ifFalse.X), FRealN::select(mask, ifTrue.Y, ifFalse.Y), FRealN::select(mask, ifTrue.Z, ifFalse.Z)};
+    }
+    
+    /**
+     * Returns the magnitude of each lane.
+     */
+    FORCE_INLINE FRealN magnitude() const
+    {
+        return Math::sqrt(squareMagnitude());
+    }
+    
+    /**
+     * Returns the squared magnitude of each lane.
+     */
+    FORCE_INLINE FRealN squareMagnitude() const
+    {
+        return X*X + Y*Y + Z*Z;
+    }
+    
+    /**
+     * Turns the non-zero lanes into vectors of unit length. Zero lanes are left unchanged.
+     *
+     * @param accuracy How accurately, see ENormalization.
+     */
+    FORCE_INLINE void normalize(ENormalization accuracy = ENormalization::Exact)
+    {
+        if (accuracy == ENormalization::Fast)
+        {
+            const FRealN squareM = squareMagnitude();
+            const FMaskN isNonZero = squareM > Zero;
+            (*this) *= FRealN::select(isNonZero, fastInverseSqrt(FRealN::select(isNonZero, squareM, One)), One);
+            return;
+        }
+        
+        const FRealN m = magnitude();
+        const FMaskN isNonZero = m > Zero;
+        const FRealN inverseMagnitude = FRealN::select(isNonZero, One / FRealN::select(isNonZero, m, One), One);
+        (*this) *= inverseMagnitude;
+    }
+    
+    FORCE_INLINE FVector3xN& operator+=(const FVector3xN& vector)
+    {
+        X += vector.X;
+        Y += vector.Y;
+        Z += vector.Z;
+        return *this;
+    }
+    
+    FORCE_INLINE FVector3xN& operator-=(const FVector3xN& vector)
+    {
+        X -= vector.X;
+        Y -= vector.Y;
+        Z -= vector.Z;
+        return *this;
+    }
+    
+    /**
+     * Scales each lane, by the same scale or by its own.
+     */
+    FORCE_INLINE FVector3xN& operator*=(const FRealN& scale)
+    {
+        X *= scale;
+        Y *= scale;
+        Z *= scale;
+        return *this;
+    }
+    
+    FORCE_INLINE FVector3xN operator+(const FVector3xN& vector) const
+    {
+        return FVector3xN{X + vector.X, Y + vector.Y, Z + vector.Z};
+    }
+    
+    FORCE_INLINE FVector3xN operator-(const FVector3xN& vector) const
+    {
+        return FVector3xN{X - vector.X, Y - vector.Y, Z - vector.Z};
+    }
+    
+    FORCE_INLINE FVector3xN operator*(const FRealN& scale) const
+    {
+        return FVector3xN{X*scale, Y*scale, Z*scale};
+    }
+    
+    FORCE_INLINE FVector3xN operator/(const FRealN& scale) const
+    {
+        return FVector3xN{X/scale, Y/scale, Z/scale};
+    }
+    
+    /**
+     * Calculates the cross product of each lane with the same lane of the given packet.
+     */
+    FORCE_INLINE FVector3xN operator^(const FVector3xN& vector) const
+    {
+        return FVector3xN{Y*vector.Z - Z*vector.Y, Z*vector.X - X*vector.Z, X*vector.Y - Y*vector.X};
+    }
+    
+    /**
+     * Calculates the dot product of each lane with the same lane of the given packet.
+     */
+    FORCE_INLINE FRealN operator|(const FVector3xN& vector) const
+    {
+        return X*vector.X + Y*vector.Y + Z*vector.Z;
+    }
+    
+    /**
+     * Gets the component-wise product of each lane with the same lane of the given packet.
+     */
+    FORCE_INLINE FVector3xN componentProduct(const FVector3xN& vector) const
+    {
+        return FVector3xN{X*vector.X, Y*vector.Y, Z*vector.Z};
+    }
+    
+    /**
+     * Scales the given packet, then add it to this one.
+     *
+     * @param scale The scale, the same for every lane or one per lane.
+     * @param vector The packet to be scaled, then added to this one.
+     */
+    FORCE_INLINE void addScaledVector(const FRealN& scale, const FVector3xN& vector)
+    {
+        X += vector.X * scale;
+        Y += vector.Y * scale;
+        Z += vector.Z * scale;
+    }
+    
+    /**
+     * Scales the given packet, then add it to the lanes of this one whose mask is set.
+     *
+     * @param scale The scale, the same for every lane or one per lane.
+     * @param vector The packet to be scaled, then added to this one.
+     * @param mask The lanes to update.
+     */
+    FORCE_INLINE void addScaledVector(const FRealN& scale, const FVector3xN& vector, const FMaskN& mask)
+    {
+        *this = select(mask, *this + vector * scale, *this);
+    }
+};  // End of class FVector3xN
+
+/**
+ * Turns the non-zero vectors of an array into vectors of unit length, a packet at a time. Zero vectors are left unchanged.
+ *
+ * @param vectors The vectors.
+ * @param accuracy How accurately, see ENormalization.
+ */
+void normalize(std::span<FVector3> vectors, ENormalization accuracy = ENormalization::Exact);
+
+}   // End of namespace Math
+}   // End of namespace GE
@@ -0,0 +1,66 @@
+//
+//  ParticleAABBTreeCollider.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "ParticleAABBTreeCollider.hpp"
+
+// GE includes.
+#include "ParticleContact.hpp"
+
+namespace GE
+{
+namespace Physics
+{
+
+void FParticleAABBTreeCollider::setMargin(FReal margin)
+{
+    CHECK(margin >= Math::Zero)
+    
+    Tree.Margin = margin;
+}
+
+const FDynamicAABBTree& FParticleAABBTreeCollider::getTree() const
+{
+    return Tree;
+}
+
+unsigned FParticleAABBTreeCollider::addContactsImplementation(std::span<FParticleContact> particleContacts) const
+{
+    gatherParticles();
+    updateTree();
+    
+    unsigned numberOfContacts = 0;
+    Tree.forEachOverlappingPair([&](uint32_t firstIndex, uint32_t secondIndex)
+    {
+        testPair(firstIndex, secondIndex, particleContacts, numberOfContacts);
+    });
+    
+    return numberOfContacts;
+}
+
+void FParticleAABBTreeCollider::updateTree() const
+{
+    const size_t numberOfParticles = Particles.size();
+    if (numberOfParticles < Proxies.size())
+    {
+        // Particles were removed, start over.
+        Tree.clear();
+        Proxies.clear();
+    }
+    
+    for (size_t index = 0; index < Proxies.size(); ++index)
+    {
+        Tree.move(Proxies[index], FAABB::makeFromSphere(FVector3{Positions[index]}, getBroadphaseRadius(index)));
+    }
+    
+    for (size_t index = Proxies.size(); index < numberOfParticles; ++index)
+    {
+        Proxies.push_back(Tree.insert(FAABB::makeFromSphere(FVector3{Positions[index]}, getBroadphaseRadius(index)), static_cast<uint32_t>(index)));
+    }
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
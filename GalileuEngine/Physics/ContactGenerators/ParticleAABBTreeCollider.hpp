@@ -0,0 +1,60 @@
+//
+//  ParticleAABBTreeCollider.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Math.hpp"
+#include "DynamicAABBTree.hpp"
+#include "ParticleCollider.hpp"
+
+// STD library includes.
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace GE
+{
+namespace Physics
+{
+using Math::FReal;
+
+/**
+ * A particle collider whose broadphase is a @ref FDynamicAABBTree of the particles' bounding boxes.
+ * Particles that move less than the tree's margin cost a single containment test per frame.
+ * The tree can also be queried directly, its user data being the particle's index in the order they were added.
+ */
+class FParticleAABBTreeCollider : public FParticleCollider
+{
+public:
+    /**
+     * Sets how much the particles' boxes are fattened by. See @ref FDynamicAABBTree::Margin.
+     *
+     * @param margin The margin, ideally about the distance particles move in a few frames.
+     */
+    void setMargin(FReal margin);
+    
+    /** Returns the tree, as of the last call to addContacts(). */
+    const FDynamicAABBTree& getTree() const;
+    
+private:
+    /** See @ref FParticleContactGenerator::addContacts. */
+    virtual unsigned addContactsImplementation(std::span<FParticleContact> particleContacts) const override;
+    
+    /** Moves each particle's box in the tree, inserting the particles added since the last call. */
+    void updateTree() const;
+    
+private:
+    /** Stores the particles' boxes. */
+    mutable FDynamicAABBTree Tree;
+    
+    /** Stores the tree proxy of each particle. */
+    mutable std::vector<uint32_t> Proxies;
+};
+
+}   // End of namespace Physics
+}   // End of namespace GE
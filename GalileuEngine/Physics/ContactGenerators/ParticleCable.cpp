@@ -33,8 +33,9 @@ unsigned FParticleCable::addContactsImplementation(std::span<FParticleContact> p
     contact.Particles[0] = Particles[0];
     contact.Particles[1] = Particles[1];
     
-    FVector3 normal = Particles[0]->getPosition() - Particles[0]->getPosition();
-    normal.normalize();
+    // It points from the first particle towards the second one: contacts move the first particle along their normal.
+    FVector3 normal{Particles[1]->getPosition() - Particles[0]->getPosition()};
+    normal.normalize(Normalization);
     contact.ContactNormal = normal;
     
     contact.PenetrationDepth = length - MaxLength;
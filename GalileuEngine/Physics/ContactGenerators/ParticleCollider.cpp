@@ -0,0 +1,91 @@
+//
+//  ParticleCollider.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "ParticleCollider.hpp"
+
+// GE includes.
+#include "ParticleContact.hpp"
+
+// STD library includes.
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+namespace GE
+{
+namespace Physics
+{
+
+void FParticleCollider::add(FParticle* particle, FReal radius)
+{
+    CHECK(particle != nullptr)
+    CHECK(radius >= Math::Zero)
+    
+    Particles.push_back(particle);
+    Radii.push_back(radius);
+}
+
+void FParticleCollider::clear()
+{
+    Particles.clear();
+    Radii.clear();
+}
+
+size_t FParticleCollider::size() const
+{
+    return Particles.size();
+}
+
+unsigned FParticleCollider::getNumberOfOverflowedContacts() const
+{
+    return NumberOfOverflowedContacts;
+}
+
+unsigned FParticleCollider::getMaxNumberOfContactsImplementation() const
+{
+    const uint64_t numberOfParticles = Particles.size();
+    const uint64_t numberOfPairs = (numberOfParticles * (numberOfParticles - 1)) / 2;
+    return static_cast<unsigned>(std::min<uint64_t>(numberOfPairs, UINT_MAX));
+}
+
+void FParticleCollider::gatherParticles() const
+{
+    const size_t numberOfParticles = Particles.size();
+    Positions.resize(numberOfParticles);
+    InverseMasses.resize(numberOfParticles);
+    for (size_t index = 0; index < numberOfParticles; ++index)
+    {
+        Particles[index]->getPosition(&Positions[index]);
+        InverseMasses[index] = Particles[index]->getInverseMass();
+    }
+    
+    NumberOfOverflowedContacts = 0;
+}
+
+void FParticleCollider::addContact(size_t firstIndex, size_t secondIndex, const FVector3& delta, FReal squareDistance, FParticleContact& contact) const
+{
+    contact.Particles[0] = Particles[firstIndex];
+    contact.Particles[1] = Particles[secondIndex];
+    contact.RestitutionCoefficient = RestitutionCoefficient;
+    
+    // The normal points from the second particle towards the first one.
+    const FReal distance = Math::sqrt(squareDistance);
+    if (distance > Math::Small_number)
+    {
+        contact.ContactNormal = delta * (Math::One / distance);
+    }
+    else
+    {
+        // Coincident centers: any direction will do.
+        contact.ContactNormal = FVector3{Math::Zero, Math::One, Math::Zero};
+    }
+    
+    contact.PenetrationDepth = Radii[firstIndex] + Radii[secondIndex] - distance;
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
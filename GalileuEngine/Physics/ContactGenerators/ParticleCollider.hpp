@@ -0,0 +1,147 @@
+//
+//  ParticleCollider.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Math.hpp"
+#include "Vector3.hpp"
+#include "Particle.hpp"
+#include "ParticleContactGenerator.hpp"
+
+// STD library includes.
+#include <span>
+#include <vector>
+
+namespace GE
+{
+namespace Physics
+{
+using Math::FReal;
+using Math::FVector3;
+using Math::FPositionVector3;
+
+/**
+ * This class generates a contact for each pair of its particles that interpenetrate, seeing particles as spheres, or that are closer than ContactMargin.
+ * Testing all pairs costs O(n²), so derived classes implement a broadphase that finds the candidate pairs, which are then tested by testPair().
+ */
+class FParticleCollider : public FParticleContactGenerator
+{
+public:
+    /** Stores the bounciness of the collisions. */
+    FReal RestitutionCoefficient = Math::One;
+    
+    /**
+     * Stores how far apart particles may be and still get a contact, with a negative penetration depth.
+     * Resolved contacts leave particles just touching, so a margin keeps resting contacts alive from frame to frame.
+     */
+    FReal ContactMargin = Math::Zero;
+    
+public:
+    /**
+     * Adds a particle to collide with the other ones.
+     *
+     * @param particle The particle. It must outlive this collider, or be removed before.
+     * @param radius The particle's radius.
+     */
+    void add(FParticle* particle, FReal radius);
+    
+    /**
+     * Removes all the particles at once.
+     */
+    void clear();
+    
+    /** Returns the number of particles. */
+    size_t size() const;
+    
+    /** Returns the number of contacts the last call to addContacts() could not report because the array was full. */
+    unsigned getNumberOfOverflowedContacts() const;
+    
+protected:
+    /**
+     * Copies the positions and inverse masses of the particles into contiguous arrays, and resets the overflow counter.
+     * To be called at the beginning of addContactsImplementation().
+     */
+    void gatherParticles() const;
+    
+    /**
+     * Generates a contact if the given particles interpenetrate. Pairs of immovable particles are skipped.
+     *
+     * @param firstIndex The index of the first particle.
+     * @param secondIndex The index of the second particle.
+     * @param particleContacts The array to be filled in.
+     * @param numberOfContacts The number of array elements already used, incremented if a contact is generated.
+     */
+    FORCE_INLINE void testPair(size_t firstIndex, size_t secondIndex, std::span<FParticleContact> particleContacts, unsigned& numberOfContacts) const
+    {
+        const FVector3 delta{Positions[firstIndex] - Positions[secondIndex]};
+        const FReal radiusSum = Radii[firstIndex] + Radii[secondIndex] + ContactMargin;
+        const FReal squareDistance = delta.squareMagnitude();
+        if (squareDistance < radiusSum*radiusSum)
+        {
+            reportPair(firstIndex, secondIndex, delta, squareDistance, particleContacts, numberOfContacts);
+        }
+    }
+    
+    /**
+     * Generates the contact of a pair of particles already known to interpenetrate, for broadphases testing the distances themselves. Pairs of immovable particles are skipped.
+     *
+     * @param firstIndex The index of the first particle.
+     * @param secondIndex The index of the second particle.
+     * @param delta The position of the first particle minus the position of the second one.
+     * @param squareDistance The square magnitude of delta.
+     * @param particleContacts The array to be filled in.
+     * @param numberOfContacts The number of array elements already used, incremented if a contact is generated.
+     */
+    FORCE_INLINE void reportPair(size_t firstIndex, size_t secondIndex, const FVector3& delta, FReal squareDistance, std::span<FParticleContact> particleContacts, unsigned& numberOfContacts) const
+    {
+        if ((InverseMasses[firstIndex] <= Math::Zero) && (InverseMasses[secondIndex] <= Math::Zero))
+        {
+            return;
+        }
+        
+        if (numberOfContacts >= particleContacts.size())
+        {
+            ++NumberOfOverflowedContacts;
+            return;
+        }
+        
+        addContact(firstIndex, secondIndex, delta, squareDistance, particleContacts[numberOfContacts++]);
+    }
+    
+    /** Returns the radius of a particle grown by half the contact margin, the one broadphases must use. */
+    FORCE_INLINE FReal getBroadphaseRadius(size_t index) const
+    {
+        return Radii[index] + ContactMargin / 2;
+    }
+    
+private:
+    /** See @ref FParticleContactGenerator::getMaxNumberOfContacts. Every pair of particles, at most. */
+    virtual unsigned getMaxNumberOfContactsImplementation() const override;
+    
+    /** Fills in the contact of an interpenetrating pair. See testPair(). */
+    void addContact(size_t firstIndex, size_t secondIndex, const FVector3& delta, FReal squareDistance, FParticleContact& contact) const;
+    
+protected:
+    /** Stores the particles. */
+    std::vector<FParticle*> Particles;
+    
+    /** Stores the radius of each particle. */
+    std::vector<FReal> Radii;
+    
+    /** Stores the position of each particle, gathered by gatherParticles(). */
+    mutable std::vector<FPositionVector3> Positions;
+    
+    /** Stores the inverse mass of each particle, gathered by gatherParticles(). */
+    mutable std::vector<FReal> InverseMasses;
+    
+    /** Stores the number of contacts that did not fit in the array. */
+    mutable unsigned NumberOfOverflowedContacts = 0;
+};
+
+}   // End of namespace Physics
+}   // End of namespace GE
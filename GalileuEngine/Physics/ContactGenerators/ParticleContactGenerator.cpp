@@ -11,6 +11,9 @@
 #include "Math.hpp"
 #include "ParticleContact.hpp"
 
+// STD library includes.
+#include <climits>
+
 namespace GE
 {
 namespace Physics
@@ -23,5 +26,15 @@ unsigned FParticleContactGenerator::addContacts(std::span<FParticleContact> part
     return addContactsImplementation(particleContacts);
 }
 
+unsigned FParticleContactGenerator::getMaxNumberOfContacts() const
+{
+    return getMaxNumberOfContactsImplementation();
+}
+
+unsigned FParticleContactGenerator::getMaxNumberOfContactsImplementation() const
+{
+    return UINT_MAX;
+}
+
 }   // End of namespace Physics
 }   // End of namespace GE
@@ -25,15 +25,26 @@ class FParticleContactGenerator
 public:
     /**
      * Generates new contacts and fills in an array with those.
+     * Given the same particles and a large enough array, it must generate the same contacts in the same order,
+     * as a generator that filled the array may be run again with a larger one.
      *
      * @param particleContacts The array to be filled in. There must be size for at least one element.
      * @return The number of array elements actually used.
      */
     unsigned addContacts(std::span<FParticleContact> particleContacts) const;
     
+    /**
+     * Returns an upper bound on the number of contacts addContacts() may generate, so arrays can be sized up front.
+     * UINT_MAX means unknown.
+     */
+    unsigned getMaxNumberOfContacts() const;
+    
 private:
     /** See @ref addContacts. */
     virtual unsigned addContactsImplementation(std::span<FParticleContact> particleContacts) const = 0;
+    
+    /** See @ref getMaxNumberOfContacts. Unknown by default. */
+    virtual unsigned getMaxNumberOfContactsImplementation() const;
 };
 
 }   // End of namespace Physics
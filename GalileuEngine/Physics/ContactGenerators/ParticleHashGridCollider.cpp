@@ -0,0 +1,215 @@
+//
+//  ParticleHashGridCollider.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "ParticleHashGridCollider.hpp"
+
+// GE includes.
+#include "ParticleContact.hpp"
+
+// STD library includes.
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace GE
+{
+namespace Physics
+{
+
+unsigned FParticleHashGridCollider::addContactsImplementation(std::span<FParticleContact> particleContacts) const
+{
+    gatherParticles();
+    
+    const size_t numberOfParticles = Particles.size();
+    if (numberOfParticles < 2)
+    {
+        return 0;
+    }
+    
+    FReal cellSize = CellSize;
+    if (cellSize <= Math::Zero)
+    {
+        cellSize = 2 * *std::max_element(Radii.begin(), Radii.end()) + ContactMargin;
+    }
+    if (cellSize <= Math::Zero)
+    {
+        return 0;   // Only points, which never interpenetrate.
+    }
+    
+    buildGrid(Math::One / cellSize);
+    
+    // The neighbouring cells after a cell in key order are the next one along X, and the three cells along X centered on
+    // the cells at these offsets: {dy, dz} = {1, 0}, {-1, 1}, {0, 1} and {1, 1}. Each pair of neighbouring cells is visited once, from the first of the two.
+    // The cells are visited in key order, so the keys of their neighbours only grow: each row keeps a cursor into the sorted cells.
+    const uint64_t rowOffsets[4] = {RowStride, SliceStride - RowStride, SliceStride, SliceStride + RowStride};
+    uint32_t rowCursors[4] = {0, 0, 0, 0};
+    
+    unsigned numberOfContacts = 0;
+    const uint32_t numberOfCells = static_cast<uint32_t>(CellBegins.size() - 1);
+    for (uint32_t cell = 0; cell < numberOfCells; ++cell)
+    {
+        const uint64_t key = CellKeys[cell];
+        const uint32_t begin = CellBegins[cell];
+        const uint32_t end = CellBegins[cell + 1];
+        
+        // The own cell: each pair is tested once, from the particle sorted first.
+        for (uint32_t first = begin; first + 1 < end; ++first)
+        {
+            for (uint32_t second = first + 1; second < end; ++second)
+            {
+                testSortedPair(first, second, particleContacts, numberOfContacts);
+            }
+        }
+        
+        if (CellKeys[cell + 1] == key + 1)
+        {
+            testCells(begin, end, end, CellBegins[cell + 2], particleContacts, numberOfContacts);
+        }
+        
+        for (unsigned row = 0; row < 4; ++row)
+        {
+            // The padding keeps the cells at dx = -1 and dx = +1 in the same row. Their particles are contiguous, from the first cell at or after
+            // rowBegin to the first one after rowBegin + 2. The cursor moves by a cell or two most of the time, and most rows hold none of the
+            // three cells in sparse scenes: conditional increments, then a single test, avoid mispredicting either.
+            const uint64_t rowBegin = key + rowOffsets[row] - 1;
+            uint32_t& rowCursor = rowCursors[row];
+            rowCursor += (CellKeys[rowCursor] < rowBegin);
+            rowCursor += (CellKeys[rowCursor] < rowBegin);
+            rowCursor += (CellKeys[rowCursor] < rowBegin);
+            while (CellKeys[rowCursor] < rowBegin)
+            {
+                ++rowCursor;
+            }
+            if (CellKeys[rowCursor] <= rowBegin + 2)
+            {
+                uint32_t rowEnd = rowCursor + 1;
+                rowEnd += (CellKeys[rowEnd] <= rowBegin + 2);
+                rowEnd += (CellKeys[rowEnd] <= rowBegin + 2);
+                testCells(begin, end, CellBegins[rowCursor], CellBegins[rowEnd], particleContacts, numberOfContacts);
+            }
+        }
+    }
+    
+    return numberOfContacts;
+}
+
+void FParticleHashGridCollider::buildGrid(FReal inverseCellSize) const
+{
+    const uint32_t numberOfParticles = static_cast<uint32_t>(Particles.size());
+    
+    // The bounding box of the particles.
+    FPositionVector3 minPosition = Positions[0];
+    FPositionVector3 maxPosition = Positions[0];
+    for (const FPositionVector3& position : Positions)
+    {
+        minPosition.X = std::min(minPosition.X, position.X);
+        minPosition.Y = std::min(minPosition.Y, position.Y);
+        minPosition.Z = std::min(minPosition.Z, position.Z);
+        maxPosition.X = std::max(maxPosition.X, position.X);
+        maxPosition.Y = std::max(maxPosition.Y, position.Y);
+        maxPosition.Z = std::max(maxPosition.Z, position.Z);
+    }
+    
+    // Cells are numbered from 1 and one more is left past the last, so that the cells before and after a cell along X or Y are never in another row or slice.
+    // The keys leave room for the particle indices in their low bits. Worlds too wide for that get coarser cells, which only add candidate pairs.
+    NumberOfIndexBits = static_cast<unsigned>(std::bit_width(numberOfParticles - 1));
+    const double maxNumberOfCells = std::ldexp(1.0, 64 - static_cast<int>(NumberOfIndexBits));
+    const FVector3 extent{maxPosition - minPosition};
+    FVector3 maxOffset = extent * inverseCellSize;
+    while ((static_cast<double>(maxOffset.X) + 3) * (static_cast<double>(maxOffset.Y) + 3) * (static_cast<double>(maxOffset.Z) + 3) > maxNumberOfCells)
+    {
+        inverseCellSize = inverseCellSize / 2;
+        maxOffset = extent * inverseCellSize;
+    }
+    RowStride = static_cast<uint64_t>(maxOffset.X) + 3;
+    SliceStride = RowStride * (static_cast<uint64_t>(maxOffset.Y) + 3);
+    const auto computeKey = [this](const FVector3& offset)
+    {
+        return (static_cast<uint64_t>(offset.Z) + 1) * SliceStride + (static_cast<uint64_t>(offset.Y) + 1) * RowStride + static_cast<uint64_t>(offset.X) + 1;
+    };
+    
+    SortKeys.resize(numberOfParticles);
+    Spheres.resize(numberOfParticles);
+    for (uint32_t index = 0; index < numberOfParticles; ++index)
+    {
+        SortKeys[index] = (computeKey(FVector3{Positions[index] - minPosition} * inverseCellSize) << NumberOfIndexBits) | index;
+        Spheres[index] = FSphere{Positions[index], Radii[index]};
+    }
+    
+    sortByKey(computeKey(maxOffset));
+    
+    // Gather what the pair tests read, and find where each cell begins.
+    const uint64_t indexMask = (uint64_t{1} << NumberOfIndexBits) - 1;
+    SortedIndices.resize(numberOfParticles);
+    SortedSpheres.resize(numberOfParticles);
+    CellBegins.clear();
+    CellKeys.clear();
+    for (uint32_t sortedIndex = 0; sortedIndex < numberOfParticles; ++sortedIndex)
+    {
+        const uint64_t key = SortKeys[sortedIndex] >> NumberOfIndexBits;
+        const uint32_t index = static_cast<uint32_t>(SortKeys[sortedIndex] & indexMask);
+        SortedIndices[sortedIndex] = index;
+        SortedSpheres[sortedIndex] = Spheres[index];
+        if (CellKeys.empty() || (key != CellKeys.back()))
+        {
+            CellBegins.push_back(sortedIndex);
+            CellKeys.push_back(key);
+        }
+    }
+    CellBegins.push_back(numberOfParticles);
+    CellKeys.push_back(UINT64_MAX);
+}
+
+void FParticleHashGridCollider::sortByKey(uint64_t maxKey) const
+{
+    // As few counting sorts as the largest digit allows, sharing the bits of the keys evenly. The indices below the keys are already in order.
+    const unsigned numberOfKeyBits = static_cast<unsigned>(std::bit_width(maxKey));
+    const unsigned numberOfDigits = (numberOfKeyBits + MaxRadixBits - 1) / MaxRadixBits;
+    const unsigned radixBits = (numberOfKeyBits + numberOfDigits - 1) / numberOfDigits;
+    const uint32_t numberOfDigitValues = 1u << radixBits;
+    const uint64_t digitMask = numberOfDigitValues - 1;
+    const uint32_t numberOfParticles = static_cast<uint32_t>(SortKeys.size());
+    
+    // Count every digit in a single pass over the keys.
+    DigitBegins.assign(numberOfDigits * numberOfDigitValues, 0);
+    for (const uint64_t sortKey : SortKeys)
+    {
+        for (unsigned digit = 0; digit < numberOfDigits; ++digit)
+        {
+            ++DigitBegins[digit * numberOfDigitValues + ((sortKey >> (NumberOfIndexBits + digit * radixBits)) & digitMask)];
+        }
+    }
+    
+    ScratchSortKeys.resize(numberOfParticles);
+    for (unsigned digit = 0; digit < numberOfDigits; ++digit)
+    {
+        // Prefix sum, so each digit value knows where it begins. A digit shared by all keys leaves the order as it is.
+        uint32_t* const digitBegins = &DigitBegins[digit * numberOfDigitValues];
+        const unsigned shift = NumberOfIndexBits + digit * radixBits;
+        if (digitBegins[(SortKeys[0] >> shift) & digitMask] == numberOfParticles)
+        {
+            continue;
+        }
+        uint32_t begin = 0;
+        for (uint32_t value = 0; value < numberOfDigitValues; ++value)
+        {
+            const uint32_t count = digitBegins[value];
+            digitBegins[value] = begin;
+            begin += count;
+        }
+        
+        // Scatter, keeping the order of the previous digits inside each digit value.
+        for (const uint64_t sortKey : SortKeys)
+        {
+            ScratchSortKeys[digitBegins[(sortKey >> shift) & digitMask]++] = sortKey;
+        }
+        SortKeys.swap(ScratchSortKeys);
+    }
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
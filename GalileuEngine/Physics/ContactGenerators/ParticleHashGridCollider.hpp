@@ -0,0 +1,121 @@
+//
+//  ParticleHashGridCollider.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Math.hpp"
+#include "ParticleCollider.hpp"
+
+// STD library includes.
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace GE
+{
+namespace Physics
+{
+using Math::FReal;
+
+/**
+ * A particle collider whose broadphase is a uniform grid of cubic cells, rebuilt every frame by sorting the particles by cell with a radix sort,
+ * i.e. a few counting sorts. A cell's key is its linear index in the particles' bounding box, a hash without collisions.
+ * Each occupied cell is tested against itself and the 13 neighbouring cells after it, found by walking the sorted cells, so no cell is looked up.
+ * Only particles in neighbouring cells are tested against each other, so it is a good fit when radii are similar.
+ */
+class FParticleHashGridCollider : public FParticleCollider
+{
+public:
+    /**
+     * Stores the edge length of the grid cells. It must be at least the largest particle diameter plus the contact margin.
+     * When zero, the default, that is the size used.
+     */
+    FReal CellSize = Math::Zero;
+    
+private:
+    /** See @ref FParticleContactGenerator::addContacts. */
+    virtual unsigned addContactsImplementation(std::span<FParticleContact> particleContacts) const override;
+    
+    /** Sorts the particles by cell key, filling SortKeys, SortedIndices, SortedSpheres, CellBegins and CellKeys. */
+    void buildGrid(FReal inverseCellSize) const;
+    
+    /** Sorts SortKeys by their cell keys, the largest being given, one counting sort per digit. */
+    void sortByKey(uint64_t maxKey) const;
+    
+    /** Tests every particle of a cell against every particle of another one, both given as ranges of sorted indices. */
+    FORCE_INLINE void testCells(uint32_t firstBegin, uint32_t firstEnd, uint32_t secondBegin, uint32_t secondEnd,
+                                std::span<FParticleContact> particleContacts, unsigned& numberOfContacts) const
+    {
+        for (uint32_t first = firstBegin; first < firstEnd; ++first)
+        {
+            for (uint32_t second = secondBegin; second < secondEnd; ++second)
+            {
+                testSortedPair(first, second, particleContacts, numberOfContacts);
+            }
+        }
+    }
+    
+    /** Generates a contact if the particles at the given sorted indices interpenetrate. See testPair(). */
+    FORCE_INLINE void testSortedPair(uint32_t first, uint32_t second, std::span<FParticleContact> particleContacts, unsigned& numberOfContacts) const
+    {
+        const FVector3 delta{SortedSpheres[first].Position - SortedSpheres[second].Position};
+        const FReal radiusSum = SortedSpheres[first].Radius + SortedSpheres[second].Radius + ContactMargin;
+        const FReal squareDistance = delta.squareMagnitude();
+        if (squareDistance < radiusSum*radiusSum)
+        {
+            reportPair(SortedIndices[first], SortedIndices[second], delta, squareDistance, particleContacts, numberOfContacts);
+        }
+    }
+    
+private:
+    /** A particle's position and radius, read together by the pair tests. */
+    struct FSphere
+    {
+        FPositionVector3 Position;
+        FReal Radius;
+    };
+    
+    /** Stores the largest number of bits of the digits sorted by each counting sort, whose counts then fill 16 KB. */
+    static constexpr unsigned MaxRadixBits = 12;
+    
+    /** Stores the difference between the keys of cells next to each other along Y. */
+    mutable uint64_t RowStride = 0;
+    
+    /** Stores the difference between the keys of cells next to each other along Z. */
+    mutable uint64_t SliceStride = 0;
+    
+    /** Stores the number of low bits of SortKeys holding the particle indices. */
+    mutable unsigned NumberOfIndexBits = 0;
+    
+    /** Stores each particle's cell key, shifted left by NumberOfIndexBits, plus its index. Once sorted, the particles are grouped by cell, by index within a cell. */
+    mutable std::vector<uint64_t> SortKeys;
+    
+    /** Stores the keys being sorted, swapped with SortKeys after each counting sort. */
+    mutable std::vector<uint64_t> ScratchSortKeys;
+    
+    /** Stores the number of particles per digit value, then where each digit value begins, for each counting sort. */
+    mutable std::vector<uint32_t> DigitBegins;
+    
+    /** Stores the sphere of each particle, so sorting them reads one array. */
+    mutable std::vector<FSphere> Spheres;
+    
+    /** Stores the spheres in sorted order, so testing neighbouring cells reads them sequentially. */
+    mutable std::vector<FSphere> SortedSpheres;
+    
+    /** Stores the particle indices in sorted order. */
+    mutable std::vector<uint32_t> SortedIndices;
+    
+    /** Stores, for each occupied cell in key order, the sorted index of its first particle, plus one past the last particle. */
+    mutable std::vector<uint32_t> CellBegins;
+    
+    /** Stores the key of each occupied cell, plus UINT64_MAX after the last one, which stops the searches for neighbours. */
+    mutable std::vector<uint64_t> CellKeys;
+};
+
+}   // End of namespace Physics
+}   // End of namespace GE
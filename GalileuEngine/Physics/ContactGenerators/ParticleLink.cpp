@@ -19,10 +19,15 @@ FReal FParticleLink::computeCurrentLength() const
     CHECK(Particles[0] != nullptr)
     CHECK(Particles[1] != nullptr)
     
-    const FVector3 deltaPosition = Particles[0]->getPosition() - Particles[1]->getPosition();
+    const FVector3 deltaPosition{Particles[0]->getPosition() - Particles[1]->getPosition()};
     const FReal length = deltaPosition.magnitude();
     return length;
 }
 
+unsigned FParticleLink::getMaxNumberOfContactsImplementation() const
+{
+    return 1;
+}
+
 }   // End of namespace Physics
 }   // End of namespace GE
@@ -30,6 +30,9 @@ class FParticleLink : public FParticleContactGenerator
 public:
     /** Stores the pair of particles that composes this link. */
     FParticle* Particles[2];
+    
+    /** Stores how accurately the contact normal is computed, Exact by default. */
+    Math::ENormalization Normalization = Math::ENormalization::Exact;
 
 protected:
     /** Gets the current link's length. */
@@ -38,6 +41,9 @@ protected:
 private:
     /** See @ref FParticleContactGenerator::addContacts. */
     virtual unsigned addContactsImplementation(std::span<FParticleContact> particleContacts) const = 0;
+    
+    /** See @ref FParticleContactGenerator::getMaxNumberOfContacts. A link generates a single contact at most. */
+    virtual unsigned getMaxNumberOfContactsImplementation() const override;
 };
 
 }   // End of namespace Physics
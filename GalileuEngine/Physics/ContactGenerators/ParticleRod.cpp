@@ -34,8 +34,9 @@ unsigned FParticleRod::addContactsImplementation(std::span<FParticleContact> par
     contact.Particles[0] = Particles[0];
     contact.Particles[1] = Particles[1];
     
-    FVector3 normal = Particles[0]->getPosition() - Particles[0]->getPosition();
-    normal.normalize();
+    // It points from the first particle towards the second one: contacts move the first particle along their normal.
+    FVector3 normal{Particles[1]->getPosition() - Particles[0]->getPosition()};
+    normal.normalize(Normalization);
     
     if (currentLength > Length)
     {
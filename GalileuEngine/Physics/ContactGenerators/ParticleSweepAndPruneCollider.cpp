@@ -0,0 +1,91 @@
+//
+//  ParticleSweepAndPruneCollider.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "ParticleSweepAndPruneCollider.hpp"
+
+// GE includes.
+#include "ParticleContact.hpp"
+
+namespace GE
+{
+namespace Physics
+{
+namespace
+{
+
+/** Returns the coordinate of the given vector along the given axis. */
+FORCE_INLINE FReal getCoordinate(const FPositionVector3& vector, unsigned axis)
+{
+    return static_cast<FReal>((axis == 0) ? vector.X : ((axis == 1) ? vector.Y : vector.Z));
+}
+
+}   // End of anonymous namespace
+
+unsigned FParticleSweepAndPruneCollider::addContactsImplementation(std::span<FParticleContact> particleContacts) const
+{
+    CHECK(SweepAxis < 3)
+    
+    gatherParticles();
+    sortEndpoints();
+    
+    // Sweep: the intervals that may overlap the current one follow it, up to the first one starting after it ends.
+    unsigned numberOfContacts = 0;
+    const size_t numberOfEndpoints = Endpoints.size();
+    for (size_t index = 0; index < numberOfEndpoints; ++index)
+    {
+        const FReal upperValue = UpperValues[index];
+        for (size_t otherIndex = index + 1; (otherIndex < numberOfEndpoints) && (Endpoints[otherIndex].Value < upperValue); ++otherIndex)
+        {
+            testPair(Endpoints[index].ParticleIndex, Endpoints[otherIndex].ParticleIndex, particleContacts, numberOfContacts);
+        }
+    }
+    
+    return numberOfContacts;
+}
+
+void FParticleSweepAndPruneCollider::sortEndpoints() const
+{
+    const size_t numberOfParticles = Particles.size();
+    if (numberOfParticles != NumberOfSortedParticles)
+    {
+        // The particle set changed, the previous order means nothing now.
+        Endpoints.resize(numberOfParticles);
+        for (size_t index = 0; index < numberOfParticles; ++index)
+        {
+            Endpoints[index].ParticleIndex = static_cast<uint32_t>(index);
+        }
+        NumberOfSortedParticles = numberOfParticles;
+    }
+    
+    for (FEndpoint& endpoint : Endpoints)
+    {
+        endpoint.Value = getCoordinate(Positions[endpoint.ParticleIndex], SweepAxis) - getBroadphaseRadius(endpoint.ParticleIndex);
+    }
+    
+    // Insertion sort: O(n + number of swaps), and the order changes little from one frame to the next.
+    for (size_t index = 1; index < numberOfParticles; ++index)
+    {
+        const FEndpoint endpoint = Endpoints[index];
+        size_t destination = index;
+        while ((destination > 0) && (Endpoints[destination - 1].Value > endpoint.Value))
+        {
+            Endpoints[destination] = Endpoints[destination - 1];
+            --destination;
+        }
+        Endpoints[destination] = endpoint;
+    }
+    
+    UpperValues.resize(numberOfParticles);
+    for (size_t index = 0; index < numberOfParticles; ++index)
+    {
+        const uint32_t particleIndex = Endpoints[index].ParticleIndex;
+        UpperValues[index] = getCoordinate(Positions[particleIndex], SweepAxis) + getBroadphaseRadius(particleIndex);
+    }
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
@@ -0,0 +1,65 @@
+//
+//  ParticleSweepAndPruneCollider.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Math.hpp"
+#include "ParticleCollider.hpp"
+
+// STD library includes.
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace GE
+{
+namespace Physics
+{
+using Math::FReal;
+
+/**
+ * A particle collider whose broadphase sorts the particles' intervals along one axis and only tests the overlapping ones.
+ * The sorted endpoint list is kept across frames and re-sorted by insertion sort, which is close to linear when particles move little between frames.
+ * Unlike @ref FParticleHashGridCollider, it does not depend on the particle radii being similar.
+ */
+class FParticleSweepAndPruneCollider : public FParticleCollider
+{
+public:
+    /** Stores the axis to sweep along: 0 for X, 1 for Y and 2 for Z. Ideally, the one along which the particles are most spread. */
+    unsigned SweepAxis = 0;
+    
+private:
+    /** See @ref FParticleContactGenerator::addContacts. */
+    virtual unsigned addContactsImplementation(std::span<FParticleContact> particleContacts) const override;
+    
+    /** Updates the endpoints to the current positions and sorts them, starting from the previous frame's order. */
+    void sortEndpoints() const;
+    
+private:
+    /** The lower end of a particle's interval along the sweep axis. */
+    struct FEndpoint
+    {
+        /** Stores the coordinate of the endpoint. */
+        FReal Value;
+        
+        /** Stores the index of the particle. */
+        uint32_t ParticleIndex;
+    };
+    
+    /** Stores the endpoints sorted by value as of the last call to addContacts(). */
+    mutable std::vector<FEndpoint> Endpoints;
+    
+    /** Stores the upper end of each endpoint's interval, in the same order as Endpoints, so the sweep reads memory sequentially. */
+    mutable std::vector<FReal> UpperValues;
+    
+    /** Stores the number of particles when the endpoints were last built, to detect particles added or removed in between. */
+    mutable size_t NumberOfSortedParticles = 0;
+};
+
+}   // End of namespace Physics
+}   // End of namespace GE
@@ -0,0 +1,266 @@
+//
+//  DynamicAABBTree.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "DynamicAABBTree.hpp"
+
+// STD library includes.
+#include <algorithm>
+
+namespace GE
+{
+namespace Physics
+{
+
+uint32_t FDynamicAABBTree::insert(const FAABB& aabb, uint32_t userData)
+{
+    const uint32_t leaf = allocateNode();
+    Nodes[leaf].AABB = aabb.fatten(Margin);
+    Nodes[leaf].UserData = userData;
+    insertLeaf(leaf);
+    ++NumberOfLeaves;
+    
+    return leaf;
+}
+
+void FDynamicAABBTree::remove(uint32_t proxy)
+{
+    CHECK(proxy < Nodes.size() && Nodes[proxy].isLeaf())
+    
+    removeLeaf(proxy);
+    freeNode(proxy);
+    --NumberOfLeaves;
+}
+
+bool FDynamicAABBTree::move(uint32_t proxy, const FAABB& aabb)
+{
+    CHECK(proxy < Nodes.size() && Nodes[proxy].isLeaf())
+    
+    FNode& leaf = Nodes[proxy];
+    if (leaf.AABB.contains(aabb))
+    {
+        return false;
+    }
+    
+    // Refit instead of reinserting: the leaf keeps its place and the rotations on the way up repair the tree.
+    leaf.AABB = aabb.fatten(Margin);
+    refit(leaf.Parent);
+    
+    return true;
+}
+
+void FDynamicAABBTree::clear()
+{
+    Nodes.clear();
+    Root = NullNode;
+    FirstFreeNode = NullNode;
+    NumberOfLeaves = 0;
+}
+
+const FAABB& FDynamicAABBTree::getFatAABB(uint32_t proxy) const
+{
+    CHECK(proxy < Nodes.size())
+    
+    return Nodes[proxy].AABB;
+}
+
+uint32_t FDynamicAABBTree::getUserData(uint32_t proxy) const
+{
+    CHECK(proxy < Nodes.size())
+    
+    return Nodes[proxy].UserData;
+}
+
+size_t FDynamicAABBTree::size() const
+{
+    return NumberOfLeaves;
+}
+
+int32_t FDynamicAABBTree::getHeight() const
+{
+    return (Root == NullNode) ? 0 : Nodes[Root].Height;
+}
+
+uint32_t FDynamicAABBTree::allocateNode()
+{
+    uint32_t index = FirstFreeNode;
+    if (index == NullNode)
+    {
+        index = static_cast<uint32_t>(Nodes.size());
+        Nodes.emplace_back();
+    }
+    else
+    {
+        FirstFreeNode = Nodes[index].Parent;
+        Nodes[index] = FNode{};
+    }
+    
+    return index;
+}
+
+void FDynamicAABBTree::freeNode(uint32_t index)
+{
+    Nodes[index].Parent = FirstFreeNode;
+    Nodes[index].Height = -1;
+    FirstFreeNode = index;
+}
+
+void FDynamicAABBTree::insertLeaf(uint32_t leaf)
+{
+    if (Root == NullNode)
+    {
+        Root = leaf;
+        Nodes[leaf].Parent = NullNode;
+        return;
+    }
+    
+    // Find the best sibling, descending while that is cheaper than pairing with the current node.
+    const FAABB leafAABB = Nodes[leaf].AABB;
+    uint32_t sibling = Root;
+    while (!Nodes[sibling].isLeaf())
+    {
+        const FNode& node = Nodes[sibling];
+        const FReal area = node.AABB.getSurfaceArea();
+        const FReal combinedArea = FAABB::merge(node.AABB, leafAABB).getSurfaceArea();
+        
+        // Pairing with this node creates a parent of the combined area; going down grows this node anyway.
+        const FReal cost = 2 * combinedArea;
+        const FReal inheritedCost = 2 * (combinedArea - area);
+        
+        FReal childCosts[2];
+        for (unsigned childIndex = 0; childIndex < 2; ++childIndex)
+        {
+            const FNode& child = Nodes[node.Children[childIndex]];
+            const FReal mergedArea = FAABB::merge(child.AABB, leafAABB).getSurfaceArea();
+            childCosts[childIndex] = (child.isLeaf() ? mergedArea : mergedArea - child.AABB.getSurfaceArea()) + inheritedCost;
+        }
+        
+        if ((cost < childCosts[0]) && (cost < childCosts[1]))
+        {
+            break;
+        }
+        sibling = node.Children[(childCosts[0] <= childCosts[1]) ? 0 : 1];
+    }
+    
+    // Replace the sibling by a new parent of both.
+    const uint32_t oldParent = Nodes[sibling].Parent;
+    const uint32_t newParent = allocateNode();
+    FNode& parent = Nodes[newParent];
+    parent.Parent = oldParent;
+    parent.Children[0] = sibling;
+    parent.Children[1] = leaf;
+    Nodes[sibling].Parent = newParent;
+    Nodes[leaf].Parent = newParent;
+    
+    if (oldParent == NullNode)
+    {
+        Root = newParent;
+    }
+    else
+    {
+        FNode& grandParent = Nodes[oldParent];
+        grandParent.Children[(grandParent.Children[0] == sibling) ? 0 : 1] = newParent;
+    }
+    
+    refit(newParent);
+}
+
+void FDynamicAABBTree::removeLeaf(uint32_t leaf)
+{
+    if (leaf == Root)
+    {
+        Root = NullNode;
+        return;
+    }
+    
+    const uint32_t parent = Nodes[leaf].Parent;
+    const uint32_t grandParent = Nodes[parent].Parent;
+    const uint32_t sibling = Nodes[parent].Children[(Nodes[parent].Children[0] == leaf) ? 1 : 0];
+    
+    // The sibling takes the parent's place.
+    Nodes[sibling].Parent = grandParent;
+    freeNode(parent);
+    if (grandParent == NullNode)
+    {
+        Root = sibling;
+    }
+    else
+    {
+        FNode& node = Nodes[grandParent];
+        node.Children[(node.Children[0] == parent) ? 0 : 1] = sibling;
+        refit(grandParent);
+    }
+}
+
+void FDynamicAABBTree::refit(uint32_t index)
+{
+    while (index != NullNode)
+    {
+        rotate(index);
+        updateFromChildren(index);
+        index = Nodes[index].Parent;
+    }
+}
+
+void FDynamicAABBTree::rotate(uint32_t index)
+{
+    const FNode& node = Nodes[index];
+    
+    // Candidate rotations: a child of this node swaps places with a child of its sibling.
+    FReal bestGain = Math::Zero;
+    unsigned bestChild = 0;
+    unsigned bestGrandChild = 0;
+    for (unsigned childIndex = 0; childIndex < 2; ++childIndex)
+    {
+        const FNode& child = Nodes[node.Children[childIndex]];
+        const FNode& sibling = Nodes[node.Children[1 - childIndex]];
+        if (sibling.isLeaf())
+        {
+            continue;
+        }
+        
+        // After the swap, the sibling bounds the child and the grandchild it keeps.
+        const FReal siblingArea = sibling.AABB.getSurfaceArea();
+        for (unsigned grandChildIndex = 0; grandChildIndex < 2; ++grandChildIndex)
+        {
+            const FNode& keptGrandChild = Nodes[sibling.Children[1 - grandChildIndex]];
+            const FReal gain = siblingArea - FAABB::merge(child.AABB, keptGrandChild.AABB).getSurfaceArea();
+            if (gain > bestGain)
+            {
+                bestGain = gain;
+                bestChild = childIndex;
+                bestGrandChild = grandChildIndex;
+            }
+        }
+    }
+    
+    if (bestGain <= Math::Zero)
+    {
+        return;
+    }
+    
+    const uint32_t child = node.Children[bestChild];
+    const uint32_t sibling = node.Children[1 - bestChild];
+    const uint32_t grandChild = Nodes[sibling].Children[bestGrandChild];
+    
+    Nodes[index].Children[bestChild] = grandChild;
+    Nodes[grandChild].Parent = index;
+    Nodes[sibling].Children[bestGrandChild] = child;
+    Nodes[child].Parent = sibling;
+    updateFromChildren(sibling);
+}
+
+void FDynamicAABBTree::updateFromChildren(uint32_t index)
+{
+    FNode& node = Nodes[index];
+    const FNode& firstChild = Nodes[node.Children[0]];
+    const FNode& secondChild = Nodes[node.Children[1]];
+    node.AABB = FAABB::merge(firstChild.AABB, secondChild.AABB);
+    node.Height = 1 + std::max(firstChild.Height, secondChild.Height);
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
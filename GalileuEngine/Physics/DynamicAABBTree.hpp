@@ -0,0 +1,248 @@
+//
+//  DynamicAABBTree.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Math.hpp"
+#include "AABB.hpp"
+#include "UtilMacros.hpp"
+
+// STD library includes.
+#include <vector>
+#include <cstdint>
+
+namespace GE
+{
+namespace Physics
+{
+using Math::FReal;
+using Math::FAABB;
+
+/**
+ * A bounding volume hierarchy of axis-aligned boxes that is updated incrementally as the boxes move.
+ * Each box is stored fattened by a margin, so boxes that move less than the margin do not touch the tree.
+ * When a box escapes its fat box, its leaf is refitted in place and its ancestors are refitted bottom-up, with tree
+ * rotations on the way keeping the tree's quality. The nodes live in a flat pool, and freed nodes are recycled.
+ *
+ * It serves as a broadphase, see @ref forEachOverlappingPair, and as a spatial index, see @ref query.
+ */
+class FDynamicAABBTree
+{
+public:
+    /** The proxy (and node) index meaning "none". */
+    static constexpr uint32_t NullNode = UINT32_MAX;
+    
+    /** Stores how much the boxes are fattened by on every side. Changing it only affects boxes inserted or moved afterwards. */
+    FReal Margin = static_cast<FReal>(0.1);
+    
+public:
+    /**
+     * Adds a box to the tree.
+     *
+     * @param aabb The box.
+     * @param userData The value passed back by the queries.
+     * @return The box's proxy, which remains valid until removed.
+     */
+    uint32_t insert(const FAABB& aabb, uint32_t userData);
+    
+    /**
+     * Removes a box from the tree.
+     *
+     * @param proxy The box's proxy.
+     */
+    void remove(uint32_t proxy);
+    
+    /**
+     * Updates a box. Nothing is done while the box stays inside its fat box.
+     *
+     * @param proxy The box's proxy.
+     * @param aabb The new box.
+     * @return Whether the tree was modified.
+     */
+    bool move(uint32_t proxy, const FAABB& aabb);
+    
+    /** Removes all the boxes, keeping the memory. */
+    void clear();
+    
+    /** Returns the fat box of a proxy. */
+    const FAABB& getFatAABB(uint32_t proxy) const;
+    
+    /** Returns the user data of a proxy. */
+    uint32_t getUserData(uint32_t proxy) const;
+    
+    /** Returns the number of boxes. */
+    size_t size() const;
+    
+    /** Returns the height of the tree, zero if it is empty or has a single box. */
+    int32_t getHeight() const;
+    
+    /**
+     * Calls a function with the user data of every box whose fat box overlaps the given one.
+     *
+     * @param aabb The box to test against.
+     * @param callback A function taking the user data and returning whether the query should continue.
+     */
+    template<typename TCallback>
+    void query(const FAABB& aabb, TCallback&& callback) const
+    {
+        if (Root == NullNode)
+        {
+            return;
+        }
+        
+        std::vector<uint32_t> stack;
+        stack.reserve(2 * (getHeight() + 1));
+        stack.push_back(Root);
+        while (!stack.empty())
+        {
+            const FNode& node = Nodes[stack.back()];
+            stack.pop_back();
+            if (!node.AABB.overlaps(aabb))
+            {
+                continue;
+            }
+            
+            if (node.isLeaf())
+            {
+                if (!callback(node.UserData))
+                {
+                    return;
+                }
+            }
+            else
+            {
+                stack.push_back(node.Children[0]);
+                stack.push_back(node.Children[1]);
+            }
+        }
+    }
+    
+    /**
+     * Calls a function with the user data of each pair of boxes whose fat boxes overlap, once per pair.
+     * The tree is traversed against itself, so no per-box query is needed.
+     *
+     * @param callback A function taking the two user data.
+     */
+    template<typename TCallback>
+    void forEachOverlappingPair(TCallback&& callback) const
+    {
+        if ((Root == NullNode) || Nodes[Root].isLeaf())
+        {
+            return;
+        }
+        
+        std::vector<FNodePair> stack;
+        stack.reserve(4 * (getHeight() + 1));
+        stack.push_back({Root, Root});
+        while (!stack.empty())
+        {
+            const FNodePair pair = stack.back();
+            stack.pop_back();
+            const FNode& first = Nodes[pair.First];
+            const FNode& second = Nodes[pair.Second];
+            
+            if (pair.First == pair.Second)
+            {
+                // A subtree against itself: the pairs are inside each child and across them.
+                if (!first.isLeaf())
+                {
+                    stack.push_back({first.Children[0], first.Children[0]});
+                    stack.push_back({first.Children[1], first.Children[1]});
+                    stack.push_back({first.Children[0], first.Children[1]});
+                }
+            }
+            else if (first.AABB.overlaps(second.AABB))
+            {
+                if (first.isLeaf() && second.isLeaf())
+                {
+                    callback(first.UserData, second.UserData);
+                }
+                else if (second.isLeaf() || (!first.isLeaf() && (first.AABB.getSurfaceArea() >= second.AABB.getSurfaceArea())))
+                {
+                    // Descend into the larger subtree.
+                    stack.push_back({first.Children[0], pair.Second});
+                    stack.push_back({first.Children[1], pair.Second});
+                }
+                else
+                {
+                    stack.push_back({pair.First, second.Children[0]});
+                    stack.push_back({pair.First, second.Children[1]});
+                }
+            }
+        }
+    }
+    
+private:
+    /** A tree node. Leaves hold the boxes; internal nodes always have two children. */
+    struct FNode
+    {
+        /** Stores the fat box for leaves, or the box bounding both children. */
+        FAABB AABB{Math::FVector3{Math::Zero}, Math::FVector3{Math::Zero}};
+        
+        /** Stores the parent, or the next free node while in the free list. */
+        uint32_t Parent = NullNode;
+        
+        /** Stores the children, NullNode for leaves. */
+        uint32_t Children[2] = {NullNode, NullNode};
+        
+        /** Stores the height of the subtree, zero for leaves. */
+        int32_t Height = 0;
+        
+        /** Stores the user data of leaves. */
+        uint32_t UserData = 0;
+        
+        FORCE_INLINE bool isLeaf() const { return Children[0] == NullNode; }
+    };
+    
+    /** Two nodes whose subtrees must be tested against each other. */
+    struct FNodePair
+    {
+        uint32_t First;
+        uint32_t Second;
+    };
+    
+    /** Takes a node from the free list, or grows the pool. */
+    uint32_t allocateNode();
+    
+    /** Returns a node to the free list. */
+    void freeNode(uint32_t index);
+    
+    /** Links a leaf into the tree next to the sibling that increases the total surface area the least. */
+    void insertLeaf(uint32_t leaf);
+    
+    /** Unlinks a leaf from the tree, freeing its parent. */
+    void removeLeaf(uint32_t leaf);
+    
+    /** Walks from the given node up to the root, rotating and recomputing each node's box and height. */
+    void refit(uint32_t index);
+    
+    /**
+     * Swaps a child of the given node with a grandchild on the other side if that reduces the surface area of the
+     * affected child, as done by Kopta et al. in "Fast, Effective BVH Updates for Animated Scenes".
+     */
+    void rotate(uint32_t index);
+    
+    /** Recomputes the box and height of an internal node from its children. */
+    void updateFromChildren(uint32_t index);
+    
+private:
+    /** Stores the nodes, including the free ones. */
+    std::vector<FNode> Nodes;
+    
+    /** Stores the root node. */
+    uint32_t Root = NullNode;
+    
+    /** Stores the first node of the free list. */
+    uint32_t FirstFreeNode = NullNode;
+    
+    /** Stores the number of leaves. */
+    size_t NumberOfLeaves = 0;
+};
+
+}   // End of namespace Physics
+}   // End of namespace GE
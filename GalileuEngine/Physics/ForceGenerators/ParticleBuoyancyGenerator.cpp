@@ -22,27 +22,13 @@ FParticleBuoyancyGenerator::FParticleBuoyancyGenerator(FReal maxDepth, FReal obj
 
 void FParticleBuoyancyGenerator::updateForce(FParticle *particle, FReal deltaTime)
 {
-    FReal submersionDepth = particle->getPosition().Y;
-    
-    // Is the object out of the liquid?
-    if ((submersionDepth) >= (LiquidHeight + MaxDepth))
-    {
-        return;
-    }
-    FVector3 buoyancyforce = FVector3::ZeroVector;
-    
-    // Is the object fully submerged?
-    if ((submersionDepth) <= (LiquidHeight - MaxDepth))
-    {
-        buoyancyforce.Y = LiquidDensity * ObjectVolume;
-        particle->addForce(buoyancyforce);
-        return;
-    }
-    
-    // Otherwise it is partly submerged.
-    FReal relativeDepth = (submersionDepth - LiquidHeight - MaxDepth) / (2 * MaxDepth);
-    buoyancyforce.Y = LiquidDensity * ObjectVolume * relativeDepth;
-    particle->addForce(buoyancyforce);
+    FParticleStore& particleStore = *particle->getStore();
+    applyForce(particleStore, particleStore.getIndex(particle->getHandle()));
+}
+
+EParticleForceGeneratorType FParticleBuoyancyGenerator::getType() const
+{
+    return EParticleForceGeneratorType::Buoyancy;
 }
 
 }   // End of namespace Physics
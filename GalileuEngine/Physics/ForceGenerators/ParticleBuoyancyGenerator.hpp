@@ -20,7 +20,7 @@ using Math::FVector3;
 /**
  * A force generator that applies a buoyancy force for a plane of liquid parallel to XZ plane.
  */
-class FParticleBuoyancyGenerator : public FParticleForceGenerator
+class FParticleBuoyancyGenerator final : public FParticleForceGenerator
 {
 public:
     /**
@@ -42,6 +42,42 @@ public:
      * @param deltaTime The integration time.
      */
     void updateForce(FParticle *particle, FReal deltaTime) override;
+    
+    /** Returns EParticleForceGeneratorType::Buoyancy. */
+    EParticleForceGeneratorType getType() const override;
+    
+    /**
+     * Applies the buoyancy force to a particle directly in its store. This is the kernel behind updateForce(), inlined in batches.
+     *
+     * @param particleStore The store where the particle lives.
+     * @param particleIndex The index of the particle in the arrays of the store.
+     */
+    FORCE_INLINE void applyForce(FParticleStore& particleStore, size_t particleIndex) const
+    {
+        // The difference is taken in position precision, so the depth stays accurate far from the origin.
+        const FReal heightAboveLiquid = static_cast<FReal>(particleStore.getPositions()[particleIndex].Y - LiquidHeight);
+        
+        // Is the object out of the liquid?
+        if (heightAboveLiquid >= MaxDepth)
+        {
+            return;
+        }
+        FVector3 buoyancyforce = FVector3::ZeroVector;
+        
+        // Is the object fully submerged?
+        if (heightAboveLiquid <= -MaxDepth)
+        {
+            buoyancyforce.Y = LiquidDensity * ObjectVolume;
+            particleStore.getAccumulatedForces()[particleIndex] += buoyancyforce;
+            return;
+        }
+        
+        // Otherwise it is partly submerged.
+        FReal relativeDepth = (heightAboveLiquid - MaxDepth) / (2 * MaxDepth);
+        buoyancyforce.Y = LiquidDensity * ObjectVolume * relativeDepth;
+        particleStore.getAccumulatedForces()[particleIndex] += buoyancyforce;
+    }
+    
 private:
     /**
      * The maximum submersion depth of the object before it generates its maximum bouyance force.
@@ -6,3 +6,16 @@
 //
 
 #include "ParticleForceGenerator.hpp"
+
+namespace GE
+{
+namespace Physics
+{
+
+EParticleForceGeneratorType FParticleForceGenerator::getType() const
+{
+    return EParticleForceGeneratorType::Custom;
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
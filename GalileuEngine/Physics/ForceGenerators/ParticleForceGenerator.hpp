@@ -11,12 +11,34 @@
 #include "Math.hpp"
 #include "Particle.hpp"
 
+// STD library includes.
+#include <cstdint>
+
 namespace GE
 {
 namespace Physics
 {
 using Math::FReal;
 
+/**
+ * The generators FParticleForcePairManager knows the concrete type of, so their pairs can be bucketed by type
+ * and dispatched to a batch kernel without virtual calls.
+ */
+enum class EParticleForceGeneratorType : uint8_t
+{
+    /** Any other generator, dispatched through updateForce(). */
+    Custom,
+    
+    /** FParticleGravityGenerator. */
+    Gravity,
+    
+    /** FParticleSpringGenerator. */
+    Spring,
+    
+    /** FParticleBuoyancyGenerator. */
+    Buoyancy
+};
+
 /**
  * A mechanism for applying force to an object. The instance is asked to add a force to one of more particles.
  */
@@ -31,6 +53,11 @@ public:
      */
     virtual void updateForce(FParticle* particle, FReal deltaTime) = 0;
     
+    /**
+     * Returns the concrete type of the generator. User-defined generators must keep the default, Custom.
+     */
+    virtual EParticleForceGeneratorType getType() const;
+    
     /**
      * Destructor.
      */
@@ -22,13 +22,13 @@ void FParticleGravityGenerator::updateForce(FParticle* particle, FReal deltaTime
 {
     CHECK(particle != nullptr)
     
-    // Don't apply gravity to particles with infinite mass.
-    if (!particle->hasFiniteMass())
-    {
-        return;
-    }
-    
-    particle->addForce(GravityAcceleration * particle->getMass());
+    FParticleStore& particleStore = *particle->getStore();
+    applyForce(particleStore, particleStore.getIndex(particle->getHandle()));
+}
+
+EParticleForceGeneratorType FParticleGravityGenerator::getType() const
+{
+    return EParticleForceGeneratorType::Gravity;
 }
 
 }   // End of namespace Physics
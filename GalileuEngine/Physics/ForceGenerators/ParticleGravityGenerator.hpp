@@ -20,7 +20,7 @@ using Math::FVector3;
 /**
  * A force generator that applies gravitational force. A single instance can be shared across multiple particles.
  */
-class FParticleGravityGenerator : public FParticleForceGenerator
+class FParticleGravityGenerator final : public FParticleForceGenerator
 {
 public:
     /**
@@ -38,6 +38,27 @@ public:
      */
     void updateForce(FParticle* particle, FReal deltaTime) override;
     
+    /** Returns EParticleForceGeneratorType::Gravity. */
+    EParticleForceGeneratorType getType() const override;
+    
+    /**
+     * Applies the gravity force to a particle directly in its store. This is the kernel behind updateForce(), inlined in batches.
+     *
+     * @param particleStore The store where the particle lives.
+     * @param particleIndex The index of the particle in the arrays of the store.
+     */
+    FORCE_INLINE void applyForce(FParticleStore& particleStore, size_t particleIndex) const
+    {
+        // Don't apply gravity to particles with infinite mass.
+        const FReal inverseMass = particleStore.getInverseMasses()[particleIndex];
+        if (inverseMass <= Math::Zero)
+        {
+            return;
+        }
+        
+        particleStore.getAccumulatedForces()[particleIndex] += GravityAcceleration * (Math::One / inverseMass);
+    }
+    
 private:
     /**
      * Stores the gravity acceleration.
@@ -24,20 +24,18 @@ void FParticleSpringGenerator::updateForce(FParticle* particle, FReal deltaTime)
 {
     CHECK(particle != nullptr);
     
-    // Calculates the spring vector.
-    FVector3 force;
-    particle->getPosition(&force);
-    force -= OtherParticle->getPosition();
-    
-    // Calculates the magnitude of the spring force.
-    FReal magnitude = force.magnitude();
-    magnitude = abs(magnitude - RestLength);
-    magnitude *= SpringConstant;
-    
-    // Calculates the final force (Hooke's law) and apply it.
-    force.normalize();
-    force *= -magnitude;
-    particle->addForce(force);
+    FParticleStore& particleStore = *particle->getStore();
+    applyForce(particleStore, particleStore.getIndex(particle->getHandle()));
+}
+
+EParticleForceGeneratorType FParticleSpringGenerator::getType() const
+{
+    return EParticleForceGeneratorType::Spring;
+}
+
+void FParticleSpringGenerator::setNormalization(Math::ENormalization normalization)
+{
+    Normalization = normalization;
 }
 
 }   // End of namespace Physics
@@ -21,10 +21,10 @@ namespace Physics
 using Math::FReal;
 
 /**
- * A force generator that applies a spring force. It should not be used for stiff springs.
+ * A force generator that applies a spring force. It should not be used for stiff springs; see FParticleSpringNetwork and EParticleSpringIntegration::Implicit instead.
  * The spring is attached to the particle passed to the constructor, but the spring force is only applied to the particle passed to the updateForce() method. So the distance between the particles is defined as the current spring length, then Hook’s law is used to calculate the spring force.
  */
-class FParticleSpringGenerator : public FParticleForceGenerator
+class FParticleSpringGenerator final : public FParticleForceGenerator
 {
 public:
     /**
@@ -43,6 +43,39 @@ public:
      * @param deltaTime The integration time.
      */
     void updateForce(FParticle* particle, FReal deltaTime) override;
+    
+    /** Returns EParticleForceGeneratorType::Spring. */
+    EParticleForceGeneratorType getType() const override;
+    
+    /**
+     * Sets how accurately the spring's direction is computed. See Math::ENormalization.
+     *
+     * @param normalization The new accuracy, Exact by default.
+     */
+    void setNormalization(Math::ENormalization normalization);
+    
+    /**
+     * Applies the spring force to a particle directly in its store. This is the kernel behind updateForce(), inlined in batches.
+     *
+     * @param particleStore The store where the particle lives.
+     * @param particleIndex The index of the particle in the arrays of the store.
+     */
+    FORCE_INLINE void applyForce(FParticleStore& particleStore, size_t particleIndex) const
+    {
+        // Calculates the spring vector.
+        FVector3 force{particleStore.getPositions()[particleIndex] - OtherParticle->getPosition()};
+        
+        // Calculates the magnitude of the spring force.
+        FReal magnitude = force.magnitude();
+        magnitude = Math::abs(magnitude - RestLength);
+        magnitude *= SpringConstant;
+        
+        // Calculates the final force (Hooke's law) and apply it.
+        force.normalize(Normalization);
+        force *= -magnitude;
+        particleStore.getAccumulatedForces()[particleIndex] += force;
+    }
+    
 private:
     /**
      * The particle at the opposite end of the spring.
@@ -58,6 +91,11 @@ private:
      * Stores the rest legnth of the spring.
      */
     FReal RestLength;
+    
+    /**
+     * Stores how accurately the spring's direction is computed.
+     */
+    Math::ENormalization Normalization = Math::ENormalization::Exact;
 };
 
 }   // End of namespace Physics
@@ -13,117 +13,121 @@
 
 using namespace GE::Physics;
 
+FParticle::FParticle(FParticleStore* store, FParticleHandle handle)
+    : Store{store}, Handle{handle}
+{
+}
+
 void FParticle::integrate(const FReal deltaTime)
 {
-    // Check whether the particle is immovable or not.
-    if (InverseMass <= Math::Zero)
-    {
-        return;
-    }
-    
-    assert(deltaTime > Math::Zero);
-    
-    // Position integration.
-    Position.addScaledVector(deltaTime, Velocity);
-    
-    // Velocity integration.
-    FVector3 finalAcceleration = Acceleration;
-    finalAcceleration.addScaledVector(InverseMass, AccumulatedForces);
-    Velocity.addScaledVector(deltaTime, finalAcceleration);
-    
-    // Apply drag.
-    Velocity *= pow(Damping, deltaTime);
+    Store->integrate(getIndex(), deltaTime);
 }
 
-void FParticle::getPosition(FVector3* position) const
+void FParticle::getPosition(FPositionVector3* position) const
 {
-    *position = Position;
+    *position = Store->getPositions()[getIndex()];
 }
 
-FVector3 FParticle::getPosition() const
+FPositionVector3 FParticle::getPosition() const
 {
-    return Position;
+    return Store->getPositions()[getIndex()];
 }
 
-void FParticle::setPosition(const FVector3& position)
+void FParticle::setPosition(const FPositionVector3& position)
 {
-    Position = position;
+    Store->getPositions()[getIndex()] = position;
 }
 
 void FParticle::addDisplacement(const FVector3& displacement)
 {
-    Position += displacement;
+    Store->getPositions()[getIndex()] += displacement;
 }
 
 void FParticle::getVelocity(FVector3* velocity) const
 {
-    *velocity = Velocity;
+    *velocity = Store->getVelocities()[getIndex()];
 }
 
 FVector3 FParticle::getVelocity() const
 {
-    return Velocity;
+    return Store->getVelocities()[getIndex()];
 }
 
 void FParticle::setVelocity(const FVector3& velocity)
 {
-    Velocity = velocity;
+    Store->getVelocities()[getIndex()] = velocity;
 }
 
 void FParticle::addVelocity(const FVector3& velocity)
 {
-    Velocity += velocity;
+    Store->getVelocities()[getIndex()] += velocity;
 }
 
 FVector3 FParticle::getAcceleration() const
 {
-    return Acceleration;
+    return Store->getAccelerations()[getIndex()];
 }
 
 bool FParticle::hasFiniteMass() const
 {
-    return InverseMass > Math::Zero;
+    return getInverseMass() > Math::Zero;
 }
 
 void FParticle::setMass(const FReal mass)
 {
     assert(mass != Math::Zero);
-    InverseMass = Math::One / mass;
+    setInverseMass(Math::One / mass);
 }
 
 FReal FParticle::getMass() const
 {
-    if (InverseMass == Math::Zero)
+    const FReal inverseMass = getInverseMass();
+    if (inverseMass == Math::Zero)
     {
         return Math::Max_number;
     }
     else
     {
-        return Math::One / InverseMass;
+        return Math::One / inverseMass;
     }
 }
 
 void FParticle::setInverseMass(const FReal inverseMass)
 {
-    InverseMass = inverseMass;
+    Store->getInverseMasses()[getIndex()] = inverseMass;
 }
 
 FReal FParticle::getInverseMass() const
 {
-    return InverseMass;
+    return Store->getInverseMasses()[getIndex()];
 }
 
 void FParticle::setDamping(const FReal damping)
 {
-    Damping = damping;
+    Store->getDampings()[getIndex()] = damping;
 }
 
 void FParticle::clearAccumulatedForces()
 {
-    AccumulatedForces.zeroOut();
+    Store->getAccumulatedForces()[getIndex()].zeroOut();
 }
 
 void FParticle::addForce(const FVector3& force)
 {
-    AccumulatedForces += force;
+    Store->getAccumulatedForces()[getIndex()] += force;
+}
+
+FParticleStore* FParticle::getStore() const
+{
+    return Store;
+}
+
+FParticleHandle FParticle::getHandle() const
+{
+    return Handle;
+}
+
+bool FParticle::isValid() const
+{
+    return (Store != nullptr) && Store->contains(Handle);
 }
@@ -10,22 +10,39 @@
 // GE includes.
 #include "Math.hpp"
 #include "Vector3.hpp"
+#include "ParticleStore.hpp"
 
 namespace GE
 {
 namespace Physics
 {
 using Math::FVector3;
+using Math::FPositionVector3;
 using Math::FReal;
 
 /**
  * Abstracts a point mass, this is the simplest object that can be simulated in this physics engine.
+ * It is a thin view over a particle living in a FParticleStore, thus it is cheap to copy, and copies refer to the same particle.
  */
 class FParticle
 {
 public:
+    /**
+     * Creates a view that does not refer to any particle.
+     */
+    FParticle() = default;
+    
+    /**
+     * Creates a view of the given particle.
+     *
+     * @param store The store where the particle lives.
+     * @param handle The particle's handle.
+     */
+    FParticle(FParticleStore* store, FParticleHandle handle);
+    
     /**
      * Advances the particle forward in time by the specified amount. This function applies the Newton-Euler integration method, a linear approximation of the exact integral.
+     * FParticleWorld can use other methods, see ParticleIntegrator.
      *
      * @param deltaTime The integration time.
      */
@@ -36,19 +53,19 @@ public:
      *
      * @param position Pointer to a vector for writing the position.
      */
-    void getPosition(FVector3* position) const;
+    void getPosition(FPositionVector3* position) const;
     
     /**
      * Returns the current particle's position.
      */
-    FVector3 getPosition() const;
+    FPositionVector3 getPosition() const;
     
     /**
      * Sets the current particle's position.
      *
      * @param position The new position of the particle.
      */
-    void setPosition(const FVector3& position);
+    void setPosition(const FPositionVector3& position);
     
     /**
      * Adds a displacement to the current particle's position.
@@ -111,6 +128,7 @@ public:
     
     /**
      * Sets the particle’s inverse mass. Use it in case of a infinite-mass object,
+     * Storing (1.0 / Mass), instead of just (Mass), makes it easy to set infinite-mass objects (immovable), but difficult to set zero-mass objects (create numerical problems).
      *
      * @param inverseMass The new inverse mass of the particle. It can be zero in case of a particle with infinite mass (unmovable)
      */
@@ -124,7 +142,8 @@ public:
     FReal getInverseMass() const;
     
     /**
-     * Sets the particle’s damping. See damping member for better description.
+     * Sets the particle’s damping, the fraction of the linear velocity kept after one second.
+     * Damping is necessary to eliminate excess energy introduced by numerical instability in the integrator.
      *
      * @param damping The new damping. It should be in the [0, 1] interval.
      */
@@ -140,40 +159,35 @@ public:
      */
     void addForce(const FVector3& force);
     
-protected:
     /**
-     * Stores the linear position of the particle in world space.
+     * Returns the store where the particle lives.
      */
-    FVector3 Position;
+    FParticleStore* getStore() const;
     
     /**
-     * Stores the linear velocity of the particle in world space.
+     * Returns the particle's handle inside its store.
      */
-    FVector3 Velocity;
+    FParticleHandle getHandle() const;
     
     /**
-     * Stores the linear acceleration of the particle in world space.
-     * Primarily used to define acceleration due to gravity, but it can also be used for any other constant acceleration.
+     * Checks whether this view refers to a particle that is still alive.
      */
-    FVector3 Acceleration;
+    bool isValid() const;
     
-    /**
-     * Stores the accumulated force to be used by the integrator. It is zeroed out at each integration step.
-     * AccumulatedForces = Force = sum_i Force_i => Accel = (1.0 / Mass) * Force.
-     * These forces are accumulated by mean of FParticle's addForce(Force_i).
-     */
-    FVector3 AccumulatedForces;
+protected:
+    /** Gets the current position of the particle inside the store's arrays. */
+    FORCE_INLINE size_t getIndex() const
+    {
+        CHECK(Store != nullptr)
+        return Store->getIndex(Handle);
+    }
     
-    /**
-     * Stores the damping factor applied to linear motion.
-     * Damping is necessary to eliminate excess energy introduced by numerical instability in the integrator.
-     */
-    FReal Damping = Math::One;
+protected:
+    /** Stores the store where the particle lives. */
+    FParticleStore* Store = nullptr;
     
-    /**
-     * Stores (1.0 / Mass), instead of just (Mass), because this way it is easy to set infinite-mass objects (immovable), but difficult to set zero-mass objects (create numerical problems).
-     */
-    FReal InverseMass;
+    /** Stores the particle's handle inside the store. */
+    FParticleHandle Handle;
 };
 
 }   // End of namespace Physics
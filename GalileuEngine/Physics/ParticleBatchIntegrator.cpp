@@ -0,0 +1,689 @@
+//
+//  ParticleBatchIntegrator.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "ParticleBatchIntegrator.hpp"
+
+// GE includes.
+#include "UtilMacros.hpp"
+#include "ParticleIntegrators.hpp"
+#include "Vector3.hpp"
+
+// STD library includes.
+#include <cmath>
+#include <cassert>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+    #include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
+namespace GE
+{
+namespace Physics
+{
+
+namespace
+{
+
+/** The number of components between consecutive vectors of the store's arrays: 4 when they are padded, see GE_ALIGNED_PARTICLES. */
+constexpr size_t Stride = GE_ALIGNED_PARTICLES ? 4 : 3;
+
+static_assert(sizeof(FParticleVector3) == Stride * sizeof(FReal), "The batch integrator reads vector arrays as flat FReal arrays.");
+static_assert(sizeof(FParticlePositionVector3) == Stride * sizeof(FPositionReal), "The batch integrator reads position arrays as flat FPositionReal arrays.");
+
+/** The number of components of the widest batch, i.e. 8 vectors, see integrateAVX2(). */
+constexpr size_t MaxBatchComponents = 24;
+
+/** Pointers to the beginning of the store's arrays, and to the uniform acceleration repeated over MaxBatchComponents components. */
+struct FParticleArrays
+{
+    FPositionReal* Positions;
+    FReal* Velocities;
+    const FReal* Accelerations;
+    const FReal* AccumulatedForces;
+    const FReal* UniformAccelerations;
+    const FReal* InverseMasses;
+    const FReal* Dampings;
+};
+
+FORCE_INLINE void integrateScalar(const FParticleArrays& arrays, size_t index, FReal deltaTime, FParticleDampingPowerCache& dampingPowerCache)
+{
+    const FReal inverseMass = arrays.InverseMasses[index];
+    
+    // Check whether the particle is immovable or not.
+    if (inverseMass <= Math::Zero)
+    {
+        return;
+    }
+    
+    FPositionReal* const position = arrays.Positions + Stride*index;
+    FReal* const velocity = arrays.Velocities + Stride*index;
+    const FReal* const acceleration = arrays.Accelerations + Stride*index;
+    const FReal* const accumulatedForce = arrays.AccumulatedForces + Stride*index;
+    const FReal dampingPower = dampingPowerCache.get(arrays.Dampings[index]);
+    
+    for (size_t component = 0; component < 3; ++component)
+    {
+        position[component] += static_cast<FPositionReal>(velocity[component]) * deltaTime;
+        const FReal finalAcceleration = (acceleration[component] + arrays.UniformAccelerations[component]) + accumulatedForce[component] * inverseMass;
+        velocity[component] += finalAcceleration * deltaTime;
+        velocity[component] *= dampingPower;
+    }
+}
+
+#if GE_FIXED_PRECISION
+
+/** The number of particles integrateScalar() processes: fixed-point reals have no SIMD instructions. */
+constexpr size_t BatchSize = 1;
+
+#elif GE_ALIGNED_PARTICLES && (defined(__AVX2__) || defined(__SSE2__))
+
+/** The number of particles integrateAligned() processes: one, each of its padded vectors filling a register. */
+constexpr size_t BatchSize = 1;
+
+#if !GE_DOUBLE_PRECISION
+
+/**
+ * Integrates a particle whose vectors are padded, moving each of them with a single aligned load.
+ * The padding is zero in every array, so it stays zero.
+ */
+FORCE_INLINE void integrateAligned(const FParticleArrays& arrays, size_t index, FReal deltaTime, FParticleDampingPowerCache& dampingPowerCache)
+{
+    const FReal inverseMass = arrays.InverseMasses[index];
+    
+    // Check whether the particle is immovable or not.
+    if (inverseMass <= Math::Zero)
+    {
+        return;
+    }
+    
+    const size_t offset = 4*index;
+    const __m128 deltaTimes = _mm_set1_ps(deltaTime);
+    const __m128 velocity = _mm_load_ps(arrays.Velocities + offset);
+    const __m128 acceleration = _mm_load_ps(arrays.Accelerations + offset);
+    const __m128 accumulatedForce = _mm_load_ps(arrays.AccumulatedForces + offset);
+    const __m128 uniformAcceleration = _mm_load_ps(arrays.UniformAccelerations);
+    
+#if GE_MIXED_PRECISION && defined(__AVX2__)
+    const __m256d position = _mm256_load_pd(arrays.Positions + offset);
+    _mm256_store_pd(arrays.Positions + offset, _mm256_add_pd(position, _mm256_mul_pd(_mm256_cvtps_pd(velocity), _mm256_set1_pd(deltaTime))));
+#elif GE_MIXED_PRECISION
+    const __m128d wideDeltaTimes = _mm_set1_pd(deltaTime);
+    const __m128d positionXY = _mm_load_pd(arrays.Positions + offset);
+    const __m128d positionZW = _mm_load_pd(arrays.Positions + offset + 2);
+    _mm_store_pd(arrays.Positions + offset, _mm_add_pd(positionXY, _mm_mul_pd(_mm_cvtps_pd(velocity), wideDeltaTimes)));
+    _mm_store_pd(arrays.Positions + offset + 2, _mm_add_pd(positionZW, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(velocity, velocity)), wideDeltaTimes)));
+#else
+    const __m128 position = _mm_load_ps(arrays.Positions + offset);
+    _mm_store_ps(arrays.Positions + offset, _mm_add_ps(position, _mm_mul_ps(velocity, deltaTimes)));
+#endif
+    
+    const __m128 finalAcceleration = _mm_add_ps(_mm_add_ps(acceleration, uniformAcceleration), _mm_mul_ps(accumulatedForce, _mm_set1_ps(inverseMass)));
+    const __m128 dampingPower = _mm_set1_ps(dampingPowerCache.get(arrays.Dampings[index]));
+    _mm_store_ps(arrays.Velocities + offset, _mm_mul_ps(_mm_add_ps(velocity, _mm_mul_ps(finalAcceleration, deltaTimes)), dampingPower));
+}
+
+#elif defined(__AVX2__)
+
+/**
+ * Integrates a particle whose vectors are padded, moving each of them with a single aligned load.
+ * The padding is zero in every array, so it stays zero.
+ */
+FORCE_INLINE void integrateAligned(const FParticleArrays& arrays, size_t index, FReal deltaTime, FParticleDampingPowerCache& dampingPowerCache)
+{
+    const FReal inverseMass = arrays.InverseMasses[index];
+    
+    // Check whether the particle is immovable or not.
+    if (inverseMass <= Math::Zero)
+    {
+        return;
+    }
+    
+    const size_t offset = 4*index;
+    const __m256d deltaTimes = _mm256_set1_pd(deltaTime);
+    const __m256d position = _mm256_load_pd(arrays.Positions + offset);
+    const __m256d velocity = _mm256_load_pd(arrays.Velocities + offset);
+    const __m256d acceleration = _mm256_load_pd(arrays.Accelerations + offset);
+    const __m256d accumulatedForce = _mm256_load_pd(arrays.AccumulatedForces + offset);
+    const __m256d uniformAcceleration = _mm256_load_pd(arrays.UniformAccelerations);
+    
+    const __m256d finalAcceleration = _mm256_add_pd(_mm256_add_pd(acceleration, uniformAcceleration), _mm256_mul_pd(accumulatedForce, _mm256_set1_pd(inverseMass)));
+    const __m256d dampingPower = _mm256_set1_pd(dampingPowerCache.get(arrays.Dampings[index]));
+    _mm256_store_pd(arrays.Positions + offset, _mm256_add_pd(position, _mm256_mul_pd(velocity, deltaTimes)));
+    _mm256_store_pd(arrays.Velocities + offset, _mm256_mul_pd(_mm256_add_pd(velocity, _mm256_mul_pd(finalAcceleration, deltaTimes)), dampingPower));
+}
+
+#else
+
+/**
+ * Integrates a particle whose vectors are padded, moving each of them with two aligned loads.
+ * The padding is zero in every array, so it stays zero.
+ */
+FORCE_INLINE void integrateAligned(const FParticleArrays& arrays, size_t index, FReal deltaTime, FParticleDampingPowerCache& dampingPowerCache)
+{
+    const FReal inverseMass = arrays.InverseMasses[index];
+    
+    // Check whether the particle is immovable or not.
+    if (inverseMass <= Math::Zero)
+    {
+        return;
+    }
+    
+    const __m128d deltaTimes = _mm_set1_pd(deltaTime);
+    const __m128d inverseMasses = _mm_set1_pd(inverseMass);
+    const __m128d dampingPower = _mm_set1_pd(dampingPowerCache.get(arrays.Dampings[index]));
+    for (size_t half = 0; half < 2; ++half)
+    {
+        const size_t offset = 4*index + 2*half;
+        const __m128d position = _mm_load_pd(arrays.Positions + offset);
+        const __m128d velocity = _mm_load_pd(arrays.Velocities + offset);
+        const __m128d acceleration = _mm_load_pd(arrays.Accelerations + offset);
+        const __m128d accumulatedForce = _mm_load_pd(arrays.AccumulatedForces + offset);
+        const __m128d uniformAcceleration = _mm_load_pd(arrays.UniformAccelerations + 2*half);
+        
+        const __m128d finalAcceleration = _mm_add_pd(_mm_add_pd(acceleration, uniformAcceleration), _mm_mul_pd(accumulatedForce, inverseMasses));
+        _mm_store_pd(arrays.Positions + offset, _mm_add_pd(position, _mm_mul_pd(velocity, deltaTimes)));
+        _mm_store_pd(arrays.Velocities + offset, _mm_mul_pd(_mm_add_pd(velocity, _mm_mul_pd(finalAcceleration, deltaTimes)), dampingPower));
+    }
+}
+
+#endif
+
+#elif GE_ALIGNED_PARTICLES && defined(__ARM_NEON) && defined(__aarch64__)
+
+/** The number of particles integrateAligned() processes: one, each of its padded vectors filling a register. */
+constexpr size_t BatchSize = 1;
+
+#if !GE_DOUBLE_PRECISION
+
+/**
+ * Integrates a particle whose vectors are padded, moving each of them with a single load. NEON loads do not need the alignment,
+ * but the padded vectors never straddle a cache line. The padding is zero in every array, so it stays zero.
+ */
+FORCE_INLINE void integrateAligned(const FParticleArrays& arrays, size_t index, FReal deltaTime, FParticleDampingPowerCache& dampingPowerCache)
+{
+    const FReal inverseMass = arrays.InverseMasses[index];
+    
+    // Check whether the particle is immovable or not.
+    if (inverseMass <= Math::Zero)
+    {
+        return;
+    }
+    
+    const size_t offset = 4*index;
+    const float32x4_t velocity = vld1q_f32(arrays.Velocities + offset);
+    const float32x4_t acceleration = vld1q_f32(arrays.Accelerations + offset);
+    const float32x4_t accumulatedForce = vld1q_f32(arrays.AccumulatedForces + offset);
+    const float32x4_t uniformAcceleration = vld1q_f32(arrays.UniformAccelerations);
+    
+#if GE_MIXED_PRECISION
+    const float64x2_t wideDeltaTimes = vdupq_n_f64(deltaTime);
+    const float64x2_t positionXY = vld1q_f64(arrays.Positions + offset);
+    const float64x2_t positionZW = vld1q_f64(arrays.Positions + offset + 2);
+    vst1q_f64(arrays.Positions + offset, vaddq_f64(positionXY, vmulq_f64(vcvt_f64_f32(vget_low_f32(velocity)), wideDeltaTimes)));
+    vst1q_f64(arrays.Positions + offset + 2, vaddq_f64(positionZW, vmulq_f64(vcvt_high_f64_f32(velocity), wideDeltaTimes)));
+#else
+    const float32x4_t position = vld1q_f32(arrays.Positions + offset);
+    vst1q_f32(arrays.Positions + offset, vaddq_f32(position, vmulq_n_f32(velocity, deltaTime)));
+#endif
+    
+    const float32x4_t finalAcceleration = vaddq_f32(vaddq_f32(acceleration, uniformAcceleration), vmulq_n_f32(accumulatedForce, inverseMass));
+    const float32x4_t dampingPower = vdupq_n_f32(dampingPowerCache.get(arrays.Dampings[index]));
+    vst1q_f32(arrays.Velocities + offset, vmulq_f32(vaddq_f32(velocity, vmulq_n_f32(finalAcceleration, deltaTime)), dampingPower));
+}
+
+#else
+
+/**
+ * Integrates a particle whose vectors are padded, moving each of them with two loads.
+ * The padding is zero in every array, so it stays zero.
+ */
+FORCE_INLINE void integrateAligned(const FParticleArrays& arrays, size_t index, FReal deltaTime, FParticleDampingPowerCache& dampingPowerCache)
+{
+    const FReal inverseMass = arrays.InverseMasses[index];
+    
+    // Check whether the particle is immovable or not.
+    if (inverseMass <= Math::Zero)
+    {
+        return;
+    }
+    
+    const float64x2_t dampingPower = vdupq_n_f64(dampingPowerCache.get(arrays.Dampings[index]));
+    for (size_t half = 0; half < 2; ++half)
+    {
+        const size_t offset = 4*index + 2*half;
+        const float64x2_t position = vld1q_f64(arrays.Positions + offset);
+        const float64x2_t velocity = vld1q_f64(arrays.Velocities + offset);
+        const float64x2_t acceleration = vld1q_f64(arrays.Accelerations + offset);
+        const float64x2_t accumulatedForce = vld1q_f64(arrays.AccumulatedForces + offset);
+        const float64x2_t uniformAcceleration = vld1q_f64(arrays.UniformAccelerations + 2*half);
+        
+        const float64x2_t finalAcceleration = vaddq_f64(vaddq_f64(acceleration, uniformAcceleration), vmulq_n_f64(accumulatedForce, inverseMass));
+        vst1q_f64(arrays.Positions + offset, vaddq_f64(position, vmulq_n_f64(velocity, deltaTime)));
+        vst1q_f64(arrays.Velocities + offset, vmulq_f64(vaddq_f64(velocity, vmulq_n_f64(finalAcceleration, deltaTime)), dampingPower));
+    }
+}
+
+#endif
+
+#elif defined(__AVX2__) && GE_DOUBLE_PRECISION
+
+/** The number of particles integrateAVX2() processes. */
+constexpr size_t BatchSize = 4;
+
+/** Spreads 4 per-particle scalars over the 12 components of 4 vectors: particle k owns lanes [3k, 3k+2] of the concatenated registers. */
+FORCE_INLINE void spreadAVX2(__m256d scalars, __m256d spread[3])
+{
+    spread[0] = _mm256_permute4x64_pd(scalars, _MM_SHUFFLE(1, 0, 0, 0));
+    spread[1] = _mm256_permute4x64_pd(scalars, _MM_SHUFFLE(2, 2, 1, 1));
+    spread[2] = _mm256_permute4x64_pd(scalars, _MM_SHUFFLE(3, 3, 3, 2));
+}
+
+/**
+ * Integrates 4 particles, i.e. 12 doubles per vector array, held in 3 registers.
+ */
+FORCE_INLINE void integrateAVX2(const FParticleArrays& arrays, size_t index, __m256d deltaTime, FParticleDampingPowerCache& dampingPowerCache)
+{
+    const __m256d inverseMasses = _mm256_loadu_pd(arrays.InverseMasses + index);
+    const __m256d isMovable = _mm256_cmp_pd(inverseMasses, _mm256_setzero_pd(), _CMP_GT_OQ);
+    
+    // Does every particle share the cached damping?
+    __m256d dampingPowers;
+    const __m256d dampings = _mm256_loadu_pd(arrays.Dampings + index);
+    if (_mm256_movemask_pd(_mm256_cmp_pd(dampings, _mm256_set1_pd(dampingPowerCache.getLastDamping()), _CMP_EQ_OQ)) == 0xF)
+    {
+        dampingPowers = _mm256_set1_pd(dampingPowerCache.getLastPower());
+    }
+    else
+    {
+        alignas(32) FReal powers[4];
+        for (size_t lane = 0; lane < 4; ++lane)
+        {
+            powers[lane] = dampingPowerCache.get(arrays.Dampings[index + lane]);
+        }
+        dampingPowers = _mm256_load_pd(powers);
+    }
+    
+    __m256d inverseMass[3], mask[3], dampingPower[3];
+    spreadAVX2(inverseMasses, inverseMass);
+    spreadAVX2(isMovable, mask);
+    spreadAVX2(dampingPowers, dampingPower);
+    
+    const size_t offset = 3*index;
+    for (size_t part = 0; part < 3; ++part)
+    {
+        const size_t first = offset + 4*part;
+        const __m256d position = _mm256_loadu_pd(arrays.Positions + first);
+        const __m256d velocity = _mm256_loadu_pd(arrays.Velocities + first);
+        const __m256d acceleration = _mm256_loadu_pd(arrays.Accelerations + first);
+        const __m256d accumulatedForce = _mm256_loadu_pd(arrays.AccumulatedForces + first);
+        const __m256d uniformAcceleration = _mm256_loadu_pd(arrays.UniformAccelerations + 4*part);
+        
+        const __m256d newPosition = _mm256_add_pd(position, _mm256_mul_pd(velocity, deltaTime));
+        const __m256d finalAcceleration = _mm256_add_pd(_mm256_add_pd(acceleration, uniformAcceleration), _mm256_mul_pd(accumulatedForce, inverseMass[part]));
+        const __m256d newVelocity = _mm256_mul_pd(_mm256_add_pd(velocity, _mm256_mul_pd(finalAcceleration, deltaTime)), dampingPower[part]);
+        
+        _mm256_storeu_pd(arrays.Positions + first, _mm256_blendv_pd(position, newPosition, mask[part]));
+        _mm256_storeu_pd(arrays.Velocities + first, _mm256_blendv_pd(velocity, newVelocity, mask[part]));
+    }
+}
+
+#elif defined(__AVX2__)
+
+/** The number of particles integrateAVX2() processes. */
+constexpr size_t BatchSize = 8;
+
+/**
+ * Moves 8 position components by velocity * deltaTime, where the mask is set.
+ * In mixed precision, the velocities are widened to double first, like in integrateScalar().
+ */
+FORCE_INLINE void movePositionsAVX2(FPositionReal* positions, __m256 velocity, __m256 deltaTime, __m256 mask)
+{
+#if GE_MIXED_PRECISION
+    const __m256d wideDeltaTime = _mm256_cvtps_pd(_mm256_castps256_ps128(deltaTime));
+    const __m128 velocityHalves[2] = { _mm256_castps256_ps128(velocity), _mm256_extractf128_ps(velocity, 1) };
+    const __m128 maskHalves[2] = { _mm256_castps256_ps128(mask), _mm256_extractf128_ps(mask, 1) };
+    for (size_t half = 0; half < 2; ++half)
+    {
+        const __m256d position = _mm256_loadu_pd(positions + 4*half);
+        const __m256d newPosition = _mm256_add_pd(position, _mm256_mul_pd(_mm256_cvtps_pd(velocityHalves[half]), wideDeltaTime));
+        
+        // Widening keeps the sign bit of the mask's lanes, which is all blendv looks at.
+        _mm256_storeu_pd(positions + 4*half, _mm256_blendv_pd(position, newPosition, _mm256_cvtps_pd(maskHalves[half])));
+    }
+#else
+    const __m256 position = _mm256_loadu_ps(positions);
+    const __m256 newPosition = _mm256_add_ps(position, _mm256_mul_ps(velocity, deltaTime));
+    _mm256_storeu_ps(positions, _mm256_blendv_ps(position, newPosition, mask));
+#endif
+}
+
+/**
+ * Integrates 8 particles, i.e. 24 floats per vector array, held in 3 registers.
+ * Per-particle scalars are spread over the components with a permutation: particle k owns lanes [3k, 3k+2] of the concatenated registers.
+ */
+FORCE_INLINE void integrateAVX2(const FParticleArrays& arrays, size_t index, __m256 deltaTime, FParticleDampingPowerCache& dampingPowerCache)
+{
+    static_assert(std::is_same_v<FReal, float>, "This AVX2 batch integrator requires single precision.");
+    
+    const __m256i spreads[3] =
+    {
+        _mm256_setr_epi32(0, 0, 0, 1, 1, 1, 2, 2),
+        _mm256_setr_epi32(2, 3, 3, 3, 4, 4, 4, 5),
+        _mm256_setr_epi32(5, 5, 6, 6, 6, 7, 7, 7),
+    };
+    
+    const __m256 inverseMasses = _mm256_loadu_ps(arrays.InverseMasses + index);
+    const __m256 isMovable = _mm256_cmp_ps(inverseMasses, _mm256_setzero_ps(), _CMP_GT_OQ);
+    
+    // Does every particle share the cached damping?
+    __m256 dampingPowers;
+    const __m256 dampings = _mm256_loadu_ps(arrays.Dampings + index);
+    if (_mm256_movemask_ps(_mm256_cmp_ps(dampings, _mm256_set1_ps(dampingPowerCache.getLastDamping()), _CMP_EQ_OQ)) == 0xFF)
+    {
+        dampingPowers = _mm256_set1_ps(dampingPowerCache.getLastPower());
+    }
+    else
+    {
+        alignas(32) FReal powers[8];
+        for (size_t lane = 0; lane < 8; ++lane)
+        {
+            powers[lane] = dampingPowerCache.get(arrays.Dampings[index + lane]);
+        }
+        dampingPowers = _mm256_load_ps(powers);
+    }
+    
+    const size_t offset = 3*index;
+    for (size_t part = 0; part < 3; ++part)
+    {
+        const size_t first = offset + 8*part;
+        const __m256 inverseMass = _mm256_permutevar8x32_ps(inverseMasses, spreads[part]);
+        const __m256 mask = _mm256_permutevar8x32_ps(isMovable, spreads[part]);
+        const __m256 dampingPower = _mm256_permutevar8x32_ps(dampingPowers, spreads[part]);
+        
+        const __m256 velocity = _mm256_loadu_ps(arrays.Velocities + first);
+        const __m256 acceleration = _mm256_loadu_ps(arrays.Accelerations + first);
+        const __m256 accumulatedForce = _mm256_loadu_ps(arrays.AccumulatedForces + first);
+        const __m256 uniformAcceleration = _mm256_loadu_ps(arrays.UniformAccelerations + 8*part);
+        
+        const __m256 finalAcceleration = _mm256_add_ps(_mm256_add_ps(acceleration, uniformAcceleration), _mm256_mul_ps(accumulatedForce, inverseMass));
+        const __m256 newVelocity = _mm256_mul_ps(_mm256_add_ps(velocity, _mm256_mul_ps(finalAcceleration, deltaTime)), dampingPower);
+        
+        movePositionsAVX2(arrays.Positions + first, velocity, deltaTime, mask);
+        _mm256_storeu_ps(arrays.Velocities + first, _mm256_blendv_ps(velocity, newVelocity, mask));
+    }
+}
+
+#elif defined(__SSE2__) && GE_DOUBLE_PRECISION
+
+/** The number of particles integrateSSE2() processes. */
+constexpr size_t BatchSize = 2;
+
+FORCE_INLINE __m128d selectSSE2(__m128d mask, __m128d ifTrue, __m128d ifFalse)
+{
+    return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, ifFalse));
+}
+
+/** Spreads 2 per-particle scalars over the 6 components of 2 vectors: particle k owns lanes [3k, 3k+2] of the concatenated registers. */
+FORCE_INLINE void spreadSSE2(__m128d scalars, __m128d spread[3])
+{
+    spread[0] = _mm_unpacklo_pd(scalars, scalars);
+    spread[1] = scalars;
+    spread[2] = _mm_unpackhi_pd(scalars, scalars);
+}
+
+/**
+ * Integrates 2 particles, i.e. 6 doubles per vector array, held in 3 registers.
+ */
+FORCE_INLINE void integrateSSE2(const FParticleArrays& arrays, size_t index, __m128d deltaTime, FParticleDampingPowerCache& dampingPowerCache)
+{
+    const __m128d inverseMasses = _mm_loadu_pd(arrays.InverseMasses + index);
+    const __m128d isMovable = _mm_cmpgt_pd(inverseMasses, _mm_setzero_pd());
+    
+    // Does every particle share the cached damping?
+    __m128d dampingPowers;
+    const __m128d dampings = _mm_loadu_pd(arrays.Dampings + index);
+    if (_mm_movemask_pd(_mm_cmpeq_pd(dampings, _mm_set1_pd(dampingPowerCache.getLastDamping()))) == 0x3)
+    {
+        dampingPowers = _mm_set1_pd(dampingPowerCache.getLastPower());
+    }
+    else
+    {
+        dampingPowers = _mm_setr_pd(dampingPowerCache.get(arrays.Dampings[index]), dampingPowerCache.get(arrays.Dampings[index + 1]));
+    }
+    
+    __m128d inverseMass[3], mask[3], dampingPower[3];
+    spreadSSE2(inverseMasses, inverseMass);
+    spreadSSE2(isMovable, mask);
+    spreadSSE2(dampingPowers, dampingPower);
+    
+    const size_t offset = 3*index;
+    for (size_t part = 0; part < 3; ++part)
+    {
+        const size_t first = offset + 2*part;
+        const __m128d position = _mm_loadu_pd(arrays.Positions + first);
+        const __m128d velocity = _mm_loadu_pd(arrays.Velocities + first);
+        const __m128d acceleration = _mm_loadu_pd(arrays.Accelerations + first);
+        const __m128d accumulatedForce = _mm_loadu_pd(arrays.AccumulatedForces + first);
+        const __m128d uniformAcceleration = _mm_loadu_pd(arrays.UniformAccelerations + 2*part);
+        
+        const __m128d newPosition = _mm_add_pd(position, _mm_mul_pd(velocity, deltaTime));
+        const __m128d finalAcceleration = _mm_add_pd(_mm_add_pd(acceleration, uniformAcceleration), _mm_mul_pd(accumulatedForce, inverseMass[part]));
+        const __m128d newVelocity = _mm_mul_pd(_mm_add_pd(velocity, _mm_mul_pd(finalAcceleration, deltaTime)), dampingPower[part]);
+        
+        _mm_storeu_pd(arrays.Positions + first, selectSSE2(mask[part], newPosition, position));
+        _mm_storeu_pd(arrays.Velocities + first, selectSSE2(mask[part], newVelocity, velocity));
+    }
+}
+
+#elif defined(__SSE2__)
+
+/** The number of particles integrateSSE2() processes. */
+constexpr size_t BatchSize = 4;
+
+FORCE_INLINE __m128 selectSSE2(__m128 mask, __m128 ifTrue, __m128 ifFalse)
+{
+    return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+}
+
+/** Spreads 4 per-particle scalars over the 12 components of 4 vectors, see integrateAVX2(). */
+FORCE_INLINE void spreadSSE2(__m128 scalars, __m128 spread[3])
+{
+    spread[0] = _mm_shuffle_ps(scalars, scalars, _MM_SHUFFLE(1, 0, 0, 0));
+    spread[1] = _mm_shuffle_ps(scalars, scalars, _MM_SHUFFLE(2, 2, 1, 1));
+    spread[2] = _mm_shuffle_ps(scalars, scalars, _MM_SHUFFLE(3, 3, 3, 2));
+}
+
+#if GE_MIXED_PRECISION
+FORCE_INLINE __m128d selectSSE2(__m128d mask, __m128d ifTrue, __m128d ifFalse)
+{
+    return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, ifFalse));
+}
+#endif
+
+/**
+ * Moves 4 position components by velocity * deltaTime, where the mask is set.
+ * In mixed precision, the velocities are widened to double first, like in integrateScalar().
+ */
+FORCE_INLINE void movePositionsSSE2(FPositionReal* positions, __m128 velocity, __m128 deltaTime, __m128 mask)
+{
+#if GE_MIXED_PRECISION
+    const __m128d wideDeltaTime = _mm_cvtps_pd(deltaTime);
+    const __m128 velocityHalves[2] = { velocity, _mm_movehl_ps(velocity, velocity) };
+    
+    // Duplicating each 32-bit lane of the mask makes it a 64-bit mask.
+    const __m128 maskHalves[2] = { _mm_unpacklo_ps(mask, mask), _mm_unpackhi_ps(mask, mask) };
+    for (size_t half = 0; half < 2; ++half)
+    {
+        const __m128d position = _mm_loadu_pd(positions + 2*half);
+        const __m128d newPosition = _mm_add_pd(position, _mm_mul_pd(_mm_cvtps_pd(velocityHalves[half]), wideDeltaTime));
+        _mm_storeu_pd(positions + 2*half, selectSSE2(_mm_castps_pd(maskHalves[half]), newPosition, position));
+    }
+#else
+    const __m128 position = _mm_loadu_ps(positions);
+    const __m128 newPosition = _mm_add_ps(position, _mm_mul_ps(velocity, deltaTime));
+    _mm_storeu_ps(positions, selectSSE2(mask, newPosition, position));
+#endif
+}
+
+/**
+ * Integrates 4 particles, i.e. 12 floats per vector array, held in 3 registers.
+ */
+FORCE_INLINE void integrateSSE2(const FParticleArrays& arrays, size_t index, __m128 deltaTime, FParticleDampingPowerCache& dampingPowerCache)
+{
+    static_assert(std::is_same_v<FReal, float>, "This SSE2 batch integrator requires single precision.");
+    
+    const __m128 inverseMasses = _mm_loadu_ps(arrays.InverseMasses + index);
+    const __m128 isMovable = _mm_cmpgt_ps(inverseMasses, _mm_setzero_ps());
+    
+    // Does every particle share the cached damping?
+    __m128 dampingPowers;
+    const __m128 dampings = _mm_loadu_ps(arrays.Dampings + index);
+    if (_mm_movemask_ps(_mm_cmpeq_ps(dampings, _mm_set1_ps(dampingPowerCache.getLastDamping()))) == 0xF)
+    {
+        dampingPowers = _mm_set1_ps(dampingPowerCache.getLastPower());
+    }
+    else
+    {
+        alignas(16) FReal powers[4];
+        for (size_t lane = 0; lane < 4; ++lane)
+        {
+            powers[lane] = dampingPowerCache.get(arrays.Dampings[index + lane]);
+        }
+        dampingPowers = _mm_load_ps(powers);
+    }
+    
+    __m128 inverseMass[3], mask[3], dampingPower[3];
+    spreadSSE2(inverseMasses, inverseMass);
+    spreadSSE2(isMovable, mask);
+    spreadSSE2(dampingPowers, dampingPower);
+    
+    const size_t offset = 3*index;
+    for (size_t part = 0; part < 3; ++part)
+    {
+        const size_t first = offset + 4*part;
+        const __m128 velocity = _mm_loadu_ps(arrays.Velocities + first);
+        const __m128 acceleration = _mm_loadu_ps(arrays.Accelerations + first);
+        const __m128 accumulatedForce = _mm_loadu_ps(arrays.AccumulatedForces + first);
+        const __m128 uniformAcceleration = _mm_loadu_ps(arrays.UniformAccelerations + 4*part);
+        
+        const __m128 finalAcceleration = _mm_add_ps(_mm_add_ps(acceleration, uniformAcceleration), _mm_mul_ps(accumulatedForce, inverseMass[part]));
+        const __m128 newVelocity = _mm_mul_ps(_mm_add_ps(velocity, _mm_mul_ps(finalAcceleration, deltaTime)), dampingPower[part]);
+        
+        movePositionsSSE2(arrays.Positions + first, velocity, deltaTime, mask[part]);
+        _mm_storeu_ps(arrays.Velocities + first, selectSSE2(mask[part], newVelocity, velocity));
+    }
+}
+
+#else
+
+/** The number of particles integrateScalar() processes. */
+constexpr size_t BatchSize = 1;
+
+#endif
+
+}   // End of anonymous namespace
+
+void FParticleBatchIntegrator::integrate(FParticleStore& store, FReal deltaTime, const FVector3& uniformAcceleration)
+{
+    integrate(store, 0, store.size(), deltaTime, uniformAcceleration);
+}
+
+void FParticleBatchIntegrator::integrate(FParticleStore& store, size_t begin, size_t end, FReal deltaTime, const FVector3& uniformAcceleration)
+{
+    CHECK(end <= store.size())
+    assert(deltaTime > Math::Zero);
+    
+    if (begin >= end)
+    {
+        return;
+    }
+    
+    FParticleArrays arrays
+    {
+        .Positions = &store.getPositions().data()->X,
+        .Velocities = &store.getVelocities().data()->X,
+        .Accelerations = &store.getAccelerations().data()->X,
+        .AccumulatedForces = &store.getAccumulatedForces().data()->X,
+        .UniformAccelerations = nullptr,
+        .InverseMasses = store.getInverseMasses().data(),
+        .Dampings = store.getDampings().data(),
+    };
+    
+    // Every batch starts at a particle boundary, so the components of the uniform acceleration line up with the arrays', padding included.
+    alignas(32) FReal uniformAccelerations[MaxBatchComponents] = {};
+    for (size_t vectorIndex = 0; vectorIndex < MaxBatchComponents / Stride; ++vectorIndex)
+    {
+        uniformAccelerations[Stride*vectorIndex + 0] = uniformAcceleration.X;
+        uniformAccelerations[Stride*vectorIndex + 1] = uniformAcceleration.Y;
+        uniformAccelerations[Stride*vectorIndex + 2] = uniformAcceleration.Z;
+    }
+    arrays.UniformAccelerations = uniformAccelerations;
+    FParticleDampingPowerCache dampingPowerCache{deltaTime};
+    
+    size_t index = begin;
+    
+#if GE_FIXED_PRECISION
+    // Every particle is a remaining one.
+#elif GE_ALIGNED_PARTICLES && (defined(__AVX2__) || defined(__SSE2__) || (defined(__ARM_NEON) && defined(__aarch64__)))
+    for (; index < end; ++index)
+    {
+        integrateAligned(arrays, index, deltaTime, dampingPowerCache);
+    }
+#elif defined(__AVX2__)
+#if GE_DOUBLE_PRECISION
+    const __m256d deltaTimes = _mm256_set1_pd(deltaTime);
+#else
+    const __m256 deltaTimes = _mm256_set1_ps(deltaTime);
+#endif
+    for (; index + BatchSize <= end; index += BatchSize)
+    {
+        integrateAVX2(arrays, index, deltaTimes, dampingPowerCache);
+    }
+#elif defined(__SSE2__)
+#if GE_DOUBLE_PRECISION
+    const __m128d deltaTimes = _mm_set1_pd(deltaTime);
+#else
+    const __m128 deltaTimes = _mm_set1_ps(deltaTime);
+#endif
+    for (; index + BatchSize <= end; index += BatchSize)
+    {
+        integrateSSE2(arrays, index, deltaTimes, dampingPowerCache);
+    }
+#endif
+    
+    // Remaining particles.
+    for (; index < end; ++index)
+    {
+        integrateScalar(arrays, index, deltaTime, dampingPowerCache);
+    }
+}
+
+FParticleBatchIntegrator::EInstructionSet FParticleBatchIntegrator::getInstructionSet()
+{
+#if GE_FIXED_PRECISION
+    return EInstructionSet::Scalar;
+#elif defined(__AVX2__)
+    return EInstructionSet::AVX2;
+#elif defined(__SSE2__)
+    return EInstructionSet::SSE2;
+#elif GE_ALIGNED_PARTICLES && defined(__ARM_NEON) && defined(__aarch64__)
+    return EInstructionSet::NEON;
+#else
+    return EInstructionSet::Scalar;
+#endif
+}
+
+size_t FParticleBatchIntegrator::getBatchSize()
+{
+    return BatchSize;
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
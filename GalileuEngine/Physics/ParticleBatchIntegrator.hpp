@@ -0,0 +1,83 @@
+//
+//  ParticleBatchIntegrator.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Math.hpp"
+#include "ParticleStore.hpp"
+#include "Vector3.hpp"
+
+// STD library includes.
+#include <cstddef>
+#include <limits>
+
+namespace GE
+{
+namespace Physics
+{
+using Math::FReal;
+using Math::FVector3;
+
+/**
+ * Integrates many particles of a FParticleStore at once, using SIMD instructions whenever they are available at compile time.
+ * AVX2 processes 8 particles per instruction, SSE2 processes 4, otherwise it falls back to a scalar loop. Both widths are halved in double precision, and fixed point always takes the scalar loop.
+ * In mixed precision, see Precision.hpp, the velocities are computed in single precision and widened to move the double precision positions.
+ * When the store's vectors are padded, see GE_ALIGNED_PARTICLES, particles are integrated one at a time instead, each vector moved with an aligned load.
+ * On ARM, only the padded vectors have a NEON path: packed ones take the scalar loop, so the padded layout is the one to pick there.
+ *
+ * It applies the same method as FParticleStore::integrate(), with the same operation order, and pow(Damping, deltaTime) is only recomputed when the damping changes from one particle to the next.
+ * A uniform acceleration, such as gravity, can be added to every movable particle on the way, instead of being accumulated as forces.
+ * Results match the scalar path within Tolerance (relative, per component and per step). They are usually bit-identical; differences come from the compiler fusing multiply-adds in only one of the paths.
+ */
+class FParticleBatchIntegrator
+{
+public:
+    /** The instruction sets the batch integrator can be compiled for. */
+    enum class EInstructionSet
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        
+        /** Only with padded vectors, see GE_ALIGNED_PARTICLES. */
+        NEON,
+    };
+    
+    /** The maximum relative difference, per component and per step, between this and the scalar path. */
+    static constexpr FReal Tolerance = (FReal) 4 * std::numeric_limits<FReal>::epsilon();
+    
+public:
+    /**
+     * Advances every particle of the store forward in time.
+     *
+     * @param store The particles to integrate.
+     * @param deltaTime The integration time.
+     * @param uniformAcceleration The acceleration added to every movable particle's.
+     */
+    static void integrate(FParticleStore& store, FReal deltaTime, const FVector3& uniformAcceleration = FVector3::ZeroVector);
+    
+    /**
+     * Advances the particles in the range [begin, end) of the store's arrays forward in time.
+     *
+     * @param store The particles to integrate.
+     * @param begin The first particle's index.
+     * @param end One past the last particle's index.
+     * @param deltaTime The integration time.
+     * @param uniformAcceleration The acceleration added to every movable particle's.
+     */
+    static void integrate(FParticleStore& store, size_t begin, size_t end, FReal deltaTime, const FVector3& uniformAcceleration = FVector3::ZeroVector);
+    
+    /** Returns the instruction set this integrator has been compiled for. */
+    static EInstructionSet getInstructionSet();
+    
+    /** Returns the number of particles processed per instruction. */
+    static size_t getBatchSize();
+};
+
+}   // End of namespace Physics
+}   // End of namespace GE
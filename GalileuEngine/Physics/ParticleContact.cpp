@@ -12,6 +12,37 @@ namespace GE
 namespace Physics
 {
 
+size_t FParticleContactKeyHash::operator()(const FParticleContactKey& key) const
+{
+    // Mixes the fields the FNV way.
+    const auto combine = [](size_t hash, size_t value)
+    {
+        return (hash ^ value) * static_cast<size_t>(1099511628211ull);
+    };
+    size_t hash = static_cast<size_t>(14695981039346656037ull);
+    hash = combine(hash, reinterpret_cast<uintptr_t>(key.Stores[0]));
+    hash = combine(hash, key.Indices[0]);
+    hash = combine(hash, key.Generations[0]);
+    hash = combine(hash, reinterpret_cast<uintptr_t>(key.Stores[1]));
+    hash = combine(hash, key.Indices[1]);
+    hash = combine(hash, key.Generations[1]);
+    return hash;
+}
+
+FParticleContactKey FParticleContact::getKey() const
+{
+    CHECK(Particles[0] != nullptr)
+    
+    FParticleContactKey key;
+    key.Stores[0] = Particles[0]->getStore();
+    key.Indices[0] = Particles[0]->getHandle().Index;
+    key.Generations[0] = Particles[0]->getHandle().Generation;
+    key.Stores[1] = (Particles[1] != nullptr) ? Particles[1]->getStore() : nullptr;
+    key.Indices[1] = (Particles[1] != nullptr) ? Particles[1]->getHandle().Index : FParticleHandle::InvalidIndex;
+    key.Generations[1] = (Particles[1] != nullptr) ? Particles[1]->getHandle().Generation : 0;
+    return key;
+}
+
 void FParticleContact::resolveContact(FReal deltaTime)
 {
     resolveVelocity(deltaTime);
@@ -22,39 +53,28 @@ void FParticleContact::resolveVelocity(FReal deltaTime)
 {
     CHECK(Particles[0] != nullptr)      // Note that Particles[1] can be nullptr (see Particles's declaration comment).
     
-    FReal separatingVelocity = computeSeparatingVelocity();
-    
-    // Is the contact either separating or at rest?
-    if (separatingVelocity > 0)
+    const FReal impulse = computeImpulse(computeSeparatingVelocity(), deltaTime);
+    if (impulse == 0)
     {
-        // So, no impulse required.
-        return;
-    }
-    
-    const FReal restitutedSeparatingVelocity = -separatingVelocity * RestitutionCoefficient;
-    
-    updateSeparatingVelocityIfRestingContact(&separatingVelocity, deltaTime);
-    
-    const FReal deltaVelocity = restitutedSeparatingVelocity - separatingVelocity;
-    const FReal totalInverseMass = computeTotalInverseMass();
-    
-    // Do all particles have infinite mass?
-    if (totalInverseMass <= 0)
-    {
-        // So, they are immovable.
         return;
     }
     
-    const FReal impulse = deltaVelocity / totalInverseMass;
+    applyImpulse(impulse);
+}
+
+void FParticleContact::applyImpulse(FReal impulse)
+{
     const FVector3 impulsePerInverseMass = ContactNormal * impulse;
-    const auto applyImpulse = [&impulsePerInverseMass](FParticle* const particle, const FReal direction)
+    const auto applyToParticle = [&impulsePerInverseMass](FParticle* const particle, const FReal direction)
     {
         if (particle == nullptr) return;
         
         particle->addVelocity(impulsePerInverseMass * (direction * particle->getInverseMass()));
     };
-    applyImpulse(Particles[0], +1);
-    applyImpulse(Particles[1], -1);     // Opposite direction.
+    applyToParticle(Particles[0], +1);
+    applyToParticle(Particles[1], -1);     // Opposite direction.
+    
+    AccumulatedImpulse += impulse;
 }
 
 void FParticleContact::resolveInterpenetration(FReal deltaTime)
@@ -95,6 +115,32 @@ void FParticleContact::resolveInterpenetration(FReal deltaTime)
     }
 }
 
+FReal FParticleContact::computeImpulse(FReal separatingVelocity, FReal deltaTime) const
+{
+    // Is the contact either separating or at rest?
+    if (separatingVelocity > 0)
+    {
+        // So, no impulse required.
+        return 0;
+    }
+    
+    const FReal restitutedSeparatingVelocity = -separatingVelocity * RestitutionCoefficient;
+    
+    updateSeparatingVelocityIfRestingContact(&separatingVelocity, deltaTime);
+    
+    const FReal deltaVelocity = restitutedSeparatingVelocity - separatingVelocity;
+    const FReal totalInverseMass = computeTotalInverseMass();
+    
+    // Do all particles have infinite mass?
+    if (totalInverseMass <= 0)
+    {
+        // So, they are immovable.
+        return 0;
+    }
+    
+    return deltaVelocity / totalInverseMass;
+}
+
 FReal FParticleContact::computeSeparatingVelocity() const
 {
     FVector3 relativeVelocity = Particles[0]->getVelocity();
@@ -115,7 +161,7 @@ FORCE_INLINE FReal FParticleContact::computeSeparatingAcceleration() const
     return relativeAcceleration | ContactNormal;
 }
 
-FORCE_INLINE FReal FParticleContact::computeTotalInverseMass() const
+FReal FParticleContact::computeTotalInverseMass() const
 {
     const bool isThereSecondParticle = Particles[1] != nullptr;
     const FReal mass0 = Particles[0]->getInverseMass();
@@ -124,7 +170,7 @@ FORCE_INLINE FReal FParticleContact::computeTotalInverseMass() const
     return totalInverseMass;
 }
 
-FORCE_INLINE void FParticleContact::updateSeparatingVelocityIfRestingContact(FReal* separatingVelocity, FReal deltaTime)
+FORCE_INLINE void FParticleContact::updateSeparatingVelocityIfRestingContact(FReal* separatingVelocity, FReal deltaTime) const
 {
     const FReal separatingAcceleration = computeSeparatingAcceleration();
     
@@ -13,6 +13,8 @@
 
 // STD library includes.
 //#include <optional>
+#include <cstdint>
+#include <cstddef>
 
 namespace GE
 {
@@ -20,6 +22,32 @@ namespace Physics
 {
 using Math::FReal;
 
+/**
+ * Identifies the pair of particles of a contact, so contacts can be matched across frames.
+ * Different views (FParticle objects) of the same particles give the same key.
+ */
+struct FParticleContactKey
+{
+    /** Stores the store of each particle, nullptr if there is no second particle. */
+    const FParticleStore* Stores[2];
+    
+    /** Stores the slot index (see FParticleHandle) of each particle, FParticleHandle::InvalidIndex if there is no second particle. */
+    uint32_t Indices[2];
+    
+    /** Stores the slot generation (see FParticleHandle) of each particle, so a slot reused by a newer particle makes a different key. */
+    uint32_t Generations[2];
+    
+    bool operator==(const FParticleContactKey&) const = default;
+};
+
+/**
+ * Hashes FParticleContactKey, for use in unordered containers.
+ */
+struct FParticleContactKeyHash
+{
+    size_t operator()(const FParticleContactKey& key) const;
+};
+
 /**
  * This class represents two FParticles that are touching each other.
  * Resolving a contact eliminates their interpenetration and applies enough impulses to keep them apart.
@@ -35,17 +63,29 @@ public:
     FParticle* Particles[2];
     //std::optional<FParticle> OtherParticle;
     
-    /** Stores the normal restitution coefficient at the point of contact. */
-    FReal RestitutionCoefficient;
+    // The vectors are kept together, then the scalars, so that padded vectors (see GE_ALIGNED_PARTICLES) leave no holes between the members.
     
     /** Stores the contact direction in world coordiantes. */
-    FVector3 ContactNormal;
+    FParticleVector3 ContactNormal;
+    
+    /** Stores the displacement applied to each particle during interpenetration resolution. */
+    FParticleVector3 Displacements[2];
+    
+    /** Stores the normal restitution coefficient at the point of contact. */
+    FReal RestitutionCoefficient;
     
     /** Stores the contact penetration depth. */
     FReal PenetrationDepth;
     
-    /** Stores the displacement applied to each particle during interpenetration resolution. */
-    FVector3 Displacements[2];
+    /**
+     * Stores the impulse along the normal applied to the particles so far.
+     * The resolver applies it before anything else (warm start) and adds to it, so it must be zero unless carried from a previous frame.
+     */
+    FReal AccumulatedImpulse;
+    
+public:
+    /** Returns the key identifying the contact's pair of particles. */
+    FParticleContactKey getKey() const;
     
 protected:
     /** 
@@ -73,6 +113,21 @@ private:
      */
     void resolveInterpenetration(FReal deltaTime);
     
+    /**
+     * Computes the impulse along the contact normal that resolves the separating velocity, zero if none is needed.
+     *
+     * @param separatingVelocity The current separating velocity.
+     * @param deltaTime The integration time.
+     */
+    FReal computeImpulse(FReal separatingVelocity, FReal deltaTime) const;
+    
+    /**
+     * Applies an impulse along the contact normal to the particles, in opposite directions, and adds it to AccumulatedImpulse.
+     *
+     * @param impulse The impulse, as computed by computeImpulse().
+     */
+    void applyImpulse(FReal impulse);
+    
     /** Computes the separating velocity at the contact point. */
     FReal computeSeparatingVelocity() const;
     
@@ -87,7 +142,7 @@ private:
      * @param separatingVelocity The separating velocity to be updated, if necessary.
      * @param deltaTime The integration time.
      */
-    void updateSeparatingVelocityIfRestingContact(FReal* separatingVelocity, FReal deltaTime);
+    void updateSeparatingVelocityIfRestingContact(FReal* separatingVelocity, FReal deltaTime) const;
 };
 
 }   // End of namespace Physics
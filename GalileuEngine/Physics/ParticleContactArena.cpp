@@ -0,0 +1,279 @@
+//
+//  ParticleContactArena.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "ParticleContactArena.hpp"
+
+// STD library includes.
+#include <algorithm>
+
+namespace GE
+{
+namespace Physics
+{
+
+FParticleContactArena::FParticleContactArena(unsigned initialCapacity, std::optional<unsigned> maxCapacity)
+: Contacts(initialCapacity),
+  MaxCapacity(maxCapacity)
+{
+}
+
+void FParticleContactArena::setMaxCapacity(std::optional<unsigned> maxCapacity)
+{
+    MaxCapacity = maxCapacity;
+}
+
+std::optional<unsigned> FParticleContactArena::getMaxCapacity() const
+{
+    return MaxCapacity;
+}
+
+void FParticleContactArena::clear()
+{
+    NumberOfContacts = 0;
+    NumberOfOverflows = 0;
+    BatchEnds.clear();
+}
+
+std::span<FParticleContact> FParticleContactArena::addContacts(const FParticleContactGenerator& generator)
+{
+    while (true)
+    {
+        const unsigned usableCapacity = getUsableCapacity();
+        const unsigned numberOfAvailableContacts = (usableCapacity > NumberOfContacts) ? (usableCapacity - NumberOfContacts) : 0;
+        
+        // At the maximum capacity, offer the spare contact too: a generator using it had more contacts than room, one merely filling the room did not.
+        const unsigned numberOfOfferedContacts = std::min(numberOfAvailableContacts + 1, getCapacity() - NumberOfContacts);
+        if (numberOfOfferedContacts == 0)
+        {
+            if (grow())
+            {
+                continue;
+            }
+            
+            ++NumberOfOverflows;
+            ++TotalNumberOfOverflows;
+            endBatch();
+            return {};
+        }
+        
+        const std::span<FParticleContact> offeredContacts = std::span{Contacts}.subspan(NumberOfContacts, numberOfOfferedContacts);
+        const unsigned numberOfContactsUsed = generator.addContacts(offeredContacts);
+        
+        // A full span may have cut contacts off, so run the generator again with more room if possible.
+        if ((numberOfContactsUsed == numberOfOfferedContacts) && grow())
+        {
+            continue;
+        }
+        
+        if (numberOfContactsUsed > numberOfAvailableContacts)
+        {
+            ++NumberOfOverflows;
+            ++TotalNumberOfOverflows;
+        }
+        
+        const unsigned numberOfContactsKept = std::min(numberOfContactsUsed, numberOfAvailableContacts);
+        NumberOfContacts += numberOfContactsKept;
+        endBatch();
+        return std::span{Contacts}.subspan(NumberOfContacts - numberOfContactsKept, numberOfContactsKept);
+    }
+}
+
+void FParticleContactArena::addContacts(std::span<FParticleContactGenerator* const> generators, Core::FJobSystem& jobSystem)
+{
+    const auto addContactsSerially = [this, generators]()
+    {
+        for (const FParticleContactGenerator* generator : generators)
+        {
+            addContacts(*generator);
+        }
+    };
+    
+    // Give each generator its room, one after the other (prefix sum).
+    Regions.resize(generators.size());
+    GeneratorRooms.resize(generators.size(), MinNumberOfContactsPerGenerator);
+    size_t end = NumberOfContacts;
+    for (size_t generatorIndex = 0; generatorIndex < generators.size(); ++generatorIndex)
+    {
+        const unsigned size = std::min(GeneratorRooms[generatorIndex], generators[generatorIndex]->getMaxNumberOfContacts());
+        Regions[generatorIndex] = FRegion{end, size, 0};
+        end += size;
+    }
+    if (!reserve(end))
+    {
+        addContactsSerially();
+        return;
+    }
+    
+    // Run the generators, and again with twice the room the ones that filled theirs, in new room past the end.
+    std::vector<size_t> pendingGenerators(generators.size());
+    for (size_t generatorIndex = 0; generatorIndex < generators.size(); ++generatorIndex)
+    {
+        pendingGenerators[generatorIndex] = generatorIndex;
+    }
+    bool isAnyGeneratorRunAgain = false;
+    while (!pendingGenerators.empty())
+    {
+        jobSystem.parallelFor(pendingGenerators.size(), 1, [&](size_t beginPending, size_t endPending)
+        {
+            for (size_t pendingIndex = beginPending; pendingIndex < endPending; ++pendingIndex)
+            {
+                const size_t generatorIndex = pendingGenerators[pendingIndex];
+                FRegion& region = Regions[generatorIndex];
+                if (region.Size > 0)
+                {
+                    region.NumberOfContactsUsed = generators[generatorIndex]->addContacts(std::span{Contacts}.subspan(region.Begin, region.Size));
+                }
+            }
+        });
+        
+        std::vector<size_t> fullGenerators;
+        for (const size_t generatorIndex : pendingGenerators)
+        {
+            FRegion& region = Regions[generatorIndex];
+            const unsigned maxNumberOfContacts = generators[generatorIndex]->getMaxNumberOfContacts();
+            if ((region.NumberOfContactsUsed == region.Size) && (region.Size < maxNumberOfContacts))
+            {
+                region = FRegion{end, std::min(2 * region.Size, maxNumberOfContacts), 0};
+                end += region.Size;
+                GeneratorRooms[generatorIndex] = region.Size;
+                fullGenerators.push_back(generatorIndex);
+            }
+        }
+        if (!reserve(end))
+        {
+            addContactsSerially();
+            return;
+        }
+        isAnyGeneratorRunAgain |= !fullGenerators.empty();
+        pendingGenerators = std::move(fullGenerators);
+    }
+    
+    // Compact in generator order. Without reruns, every region starts at or after where its contacts go, so moving them in place is safe.
+    std::span<FParticleContact> compactedContacts = std::span{Contacts}.subspan(NumberOfContacts);
+    if (isAnyGeneratorRunAgain)
+    {
+        CompactedContacts.resize(end - NumberOfContacts);
+        compactedContacts = CompactedContacts;
+    }
+    size_t numberOfCompactedContacts = 0;
+    for (size_t generatorIndex = 0; generatorIndex < generators.size(); ++generatorIndex)
+    {
+        const FRegion& region = Regions[generatorIndex];
+        const auto regionBegin = Contacts.begin() + region.Begin;
+        std::copy(regionBegin, regionBegin + region.NumberOfContactsUsed, compactedContacts.begin() + numberOfCompactedContacts);
+        numberOfCompactedContacts += region.NumberOfContactsUsed;
+        
+        // Next time, start with room for twice as many contacts.
+        unsigned& room = GeneratorRooms[generatorIndex];
+        room = std::max({room, region.Size, 2 * region.NumberOfContactsUsed});
+    }
+    if (isAnyGeneratorRunAgain)
+    {
+        std::copy(CompactedContacts.begin(), CompactedContacts.begin() + numberOfCompactedContacts, Contacts.begin() + NumberOfContacts);
+    }
+    
+    for (size_t generatorIndex = 0; generatorIndex < generators.size(); ++generatorIndex)
+    {
+        NumberOfContacts += Regions[generatorIndex].NumberOfContactsUsed;
+        endBatch();
+    }
+}
+
+size_t FParticleContactArena::getNumberOfBatches() const
+{
+    return BatchEnds.size();
+}
+
+std::span<FParticleContact> FParticleContactArena::getBatch(size_t batchIndex)
+{
+    CHECK(batchIndex < BatchEnds.size())
+    
+    const unsigned begin = (batchIndex == 0) ? 0 : BatchEnds[batchIndex - 1];
+    return std::span{Contacts}.subspan(begin, BatchEnds[batchIndex] - begin);
+}
+
+std::span<FParticleContact> FParticleContactArena::getContacts()
+{
+    return std::span{Contacts}.first(NumberOfContacts);
+}
+
+unsigned FParticleContactArena::size() const
+{
+    return NumberOfContacts;
+}
+
+unsigned FParticleContactArena::getCapacity() const
+{
+    return static_cast<unsigned>(Contacts.size());
+}
+
+unsigned FParticleContactArena::getHighWaterMark() const
+{
+    return HighWaterMark;
+}
+
+unsigned FParticleContactArena::getNumberOfOverflows() const
+{
+    return NumberOfOverflows;
+}
+
+unsigned FParticleContactArena::getTotalNumberOfOverflows() const
+{
+    return TotalNumberOfOverflows;
+}
+
+unsigned FParticleContactArena::getNumberOfGrowths() const
+{
+    return NumberOfGrowths;
+}
+
+bool FParticleContactArena::reserve(size_t numberOfContacts)
+{
+    while (getUsableCapacity() < numberOfContacts)
+    {
+        if (!grow())
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+void FParticleContactArena::endBatch()
+{
+    BatchEnds.push_back(NumberOfContacts);
+    HighWaterMark = std::max(HighWaterMark, NumberOfContacts);
+}
+
+unsigned FParticleContactArena::getUsableCapacity() const
+{
+    const unsigned capacity = getCapacity();
+    return MaxCapacity.has_value() ? std::min(capacity, *MaxCapacity) : capacity;
+}
+
+bool FParticleContactArena::grow()
+{
+    const unsigned capacity = getCapacity();
+    if (MaxCapacity.has_value() && (capacity > *MaxCapacity))
+    {
+        return false;
+    }
+    
+    unsigned newCapacity = std::max(2 * capacity, 64u);
+    if (MaxCapacity.has_value())
+    {
+        newCapacity = std::min(newCapacity, *MaxCapacity + 1);
+    }
+    
+    Contacts.resize(newCapacity);
+    ++NumberOfGrowths;
+    return true;
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
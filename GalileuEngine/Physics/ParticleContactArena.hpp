@@ -0,0 +1,184 @@
+//
+//  ParticleContactArena.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "ParticleContact.hpp"
+#include "ContactGenerators/ParticleContactGenerator.hpp"
+#include "JobSystem.hpp"
+
+// STD library includes.
+#include <span>
+#include <vector>
+#include <optional>
+
+namespace GE
+{
+namespace Physics
+{
+
+/**
+ * Stores the contacts of a frame, growing geometrically whenever a generator runs out of room, and never shrinking.
+ * A maximum capacity can be set for real-time budgets, in which case the contacts that do not fit are lost, but counted.
+ * The arena then allocates one spare contact past the maximum capacity, so it can tell a generator that exactly fills the room left from one that has more contacts.
+ */
+class FParticleContactArena
+{
+public:
+    /**
+     * The basic constructor.
+     *
+     * @param initialCapacity The number of contacts to allocate up front.
+     * @param maxCapacity The number of contacts the arena never grows beyond. None, the default, means unbounded.
+     */
+    explicit FParticleContactArena(unsigned initialCapacity, std::optional<unsigned> maxCapacity = std::nullopt);
+    
+    /**
+     * Sets the number of contacts the arena never grows beyond. Lowering it does not free memory.
+     *
+     * @param maxCapacity The new value. None means unbounded.
+     */
+    void setMaxCapacity(std::optional<unsigned> maxCapacity);
+    
+    /** Returns the number of contacts the arena never grows beyond, if any. */
+    std::optional<unsigned> getMaxCapacity() const;
+    
+    /** Removes all contacts, starting a new frame. */
+    void clear();
+    
+    /**
+     * Appends the contacts of a generator.
+     * If the generator fills all the room left, the arena grows and the generator is run again, until it leaves room or the maximum capacity is reached.
+     *
+     * @param generator The generator.
+     * @return The contacts appended.
+     */
+    std::span<FParticleContact> addContacts(const FParticleContactGenerator& generator);
+    
+    /**
+     * Appends the contacts of several generators, running them concurrently.
+     * Each generator gets its own span, sized from its upper bound (see FParticleContactGenerator::getMaxNumberOfContacts())
+     * and from how many contacts it generated before, placed by a prefix sum. Generators that fill their span run again
+     * with twice the room. The contacts are then compacted in generator order, so the result is the same as calling
+     * addContacts() on each generator in order, whatever the number of threads.
+     * Falls back to doing exactly that when the maximum capacity could be exceeded.
+     *
+     * @param generators The generators. They must not share mutable state.
+     * @param jobSystem The job system to run on.
+     */
+    void addContacts(std::span<FParticleContactGenerator* const> generators, Core::FJobSystem& jobSystem);
+    
+    /** Returns the number of batches of the current frame, one per generator whose contacts were appended. */
+    size_t getNumberOfBatches() const;
+    
+    /**
+     * Returns the contacts of a batch.
+     *
+     * @param batchIndex The index of the batch, in the order the generators' contacts were appended.
+     */
+    std::span<FParticleContact> getBatch(size_t batchIndex);
+    
+    /** Returns the contacts of the current frame. */
+    std::span<FParticleContact> getContacts();
+    
+    /** Returns the number of contacts of the current frame. */
+    unsigned size() const;
+    
+    /** Returns the number of contacts allocated. */
+    unsigned getCapacity() const;
+    
+    /** Returns the largest number of contacts stored in a frame since the arena was created. */
+    unsigned getHighWaterMark() const;
+    
+    /** Returns the number of generators that ran out of room at the maximum capacity in the current frame, so some of their contacts were lost. */
+    unsigned getNumberOfOverflows() const;
+    
+    /** Returns the number of generators that ran out of room at the maximum capacity since the arena was created. */
+    unsigned getTotalNumberOfOverflows() const;
+    
+    /** Returns the number of times the arena has grown. */
+    unsigned getNumberOfGrowths() const;
+    
+private:
+    /** Returns the number of contacts that may be used, the capacity limited by the maximum one. */
+    unsigned getUsableCapacity() const;
+    
+    /**
+     * Doubles the capacity, within the maximum one plus the spare contact.
+     *
+     * @return Whether the capacity has grown.
+     */
+    bool grow();
+    
+    /**
+     * Grows until the given number of contacts is usable.
+     *
+     * @return Whether it was possible.
+     */
+    bool reserve(size_t numberOfContacts);
+    
+    /** Records that the contacts up to NumberOfContacts form a batch, and updates the high-water mark. */
+    void endBatch();
+    
+private:
+    /** The room given to a generator in the concurrent addContacts(). */
+    struct FRegion
+    {
+        /** Stores the index of the first contact. */
+        size_t Begin;
+        
+        /** Stores the number of contacts available. */
+        unsigned Size;
+        
+        /** Stores the number of contacts the generator used. */
+        unsigned NumberOfContactsUsed;
+    };
+    
+    /** Stores the smallest room given to a generator whose upper bound is larger. */
+    static constexpr unsigned MinNumberOfContactsPerGenerator = 64;
+    
+private:
+    /** Stores the contacts. Its size is the capacity. */
+    Core::TCacheAlignedVector<FParticleContact> Contacts;
+    
+    /** Stores the number of contacts of the current frame. */
+    unsigned NumberOfContacts = 0;
+    
+    /** Stores the number of contacts the arena never grows beyond, if any. */
+    std::optional<unsigned> MaxCapacity;
+    
+    /** Stores the largest number of contacts stored in a frame. */
+    unsigned HighWaterMark = 0;
+    
+    /** Stores the number of generators that ran out of room at the maximum capacity in the current frame. */
+    unsigned NumberOfOverflows = 0;
+    
+    /** Stores the number of generators that ran out of room at the maximum capacity since the arena was created. */
+    unsigned TotalNumberOfOverflows = 0;
+    
+    /** Stores the number of times the arena has grown. */
+    unsigned NumberOfGrowths = 0;
+    
+    /** Stores where each batch of the current frame ends. */
+    std::vector<unsigned> BatchEnds;
+    
+    /**
+     * Stores the room to give each generator in the concurrent addContacts(), learned from the previous frames, indexed like the generators.
+     * It only ever holds as many entries as there are generators, and a wrong guess after the generators change merely costs a rerun.
+     */
+    std::vector<unsigned> GeneratorRooms;
+    
+    /** Stores the room of each generator during the concurrent addContacts(). */
+    std::vector<FRegion> Regions;
+    
+    /** Stores the contacts while compacting them, when some generators had to run again. */
+    Core::TCacheAlignedVector<FParticleContact> CompactedContacts;
+};
+
+}   // End of namespace Physics
+}   // End of namespace GE
@@ -0,0 +1,72 @@
+//
+//  ParticleContactCache.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "ParticleContactCache.hpp"
+
+namespace GE
+{
+namespace Physics
+{
+
+void FParticleContactCache::beginFrame()
+{
+    CurrentKeys.clear();
+    NumberOfWarmStartedContacts = 0;
+}
+
+void FParticleContactCache::warmStart(std::span<FParticleContact> contacts, const FParticleContactGenerator* generator, FReal factor)
+{
+    CHECK((factor >= Math::Zero) && (factor <= Math::One))
+    
+    for (FParticleContact& contact : contacts)
+    {
+        contact.AccumulatedImpulse = Math::Zero;
+        if (factor <= Math::Zero)
+        {
+            continue;
+        }
+        
+        const FKey key{contact.getKey(), generator};
+        CurrentKeys.push_back(key);
+        
+        const auto previousImpulse = PreviousImpulses.find(key);
+        if (previousImpulse != PreviousImpulses.end())
+        {
+            contact.AccumulatedImpulse = factor * previousImpulse->second;
+            ++NumberOfWarmStartedContacts;
+        }
+    }
+}
+
+void FParticleContactCache::endFrame(std::span<const FParticleContact> contacts)
+{
+    PreviousImpulses.clear();
+    
+    // Nothing to remember when the cache was disabled.
+    if (CurrentKeys.size() != contacts.size())
+    {
+        return;
+    }
+    
+    for (size_t contactIndex = 0; contactIndex < contacts.size(); ++contactIndex)
+    {
+        PreviousImpulses[CurrentKeys[contactIndex]] = contacts[contactIndex].AccumulatedImpulse;
+    }
+}
+
+size_t FParticleContactCache::getNumberOfWarmStartedContacts() const
+{
+    return NumberOfWarmStartedContacts;
+}
+
+size_t FParticleContactCache::FKeyHash::operator()(const FKey& key) const
+{
+    return FParticleContactKeyHash{}(key.Particles) ^ (std::hash<const void*>{}(key.Generator) * 31);
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
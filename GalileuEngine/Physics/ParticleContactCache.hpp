@@ -0,0 +1,90 @@
+//
+//  ParticleContactCache.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Math.hpp"
+#include "ParticleContact.hpp"
+#include "ContactGenerators/ParticleContactGenerator.hpp"
+
+// STD library includes.
+#include <span>
+#include <vector>
+#include <unordered_map>
+
+namespace GE
+{
+namespace Physics
+{
+using Math::FReal;
+
+/**
+ * Remembers the impulse each contact needed in the previous frame, so the resolver can start from it (warm start).
+ * Contacts are matched across frames by their particles and the generator that reported them.
+ * Resting contacts need about the same impulse every frame, so warm-started stacks settle in far fewer iterations.
+ */
+class FParticleContactCache
+{
+public:
+    /**
+     * Starts a frame, forgetting the contacts passed to warmStart() in the previous one.
+     */
+    void beginFrame();
+    
+    /**
+     * Sets the accumulated impulse of the contacts just reported by a generator to the one they had in the previous frame, if any.
+     * Must be called once per generator, in the order the contacts are stored.
+     *
+     * @param contacts The contacts reported by the generator.
+     * @param generator The generator.
+     * @param factor How much of the previous impulse to keep, in [0, 1]. Zero disables the cache, leaving all impulses at zero.
+     */
+    void warmStart(std::span<FParticleContact> contacts, const FParticleContactGenerator* generator, FReal factor);
+    
+    /**
+     * Ends a frame, remembering the accumulated impulses of the resolved contacts.
+     *
+     * @param contacts All the contacts passed to warmStart() during this frame, in the same order.
+     */
+    void endFrame(std::span<const FParticleContact> contacts);
+    
+    /** Returns the number of contacts of the current frame that were found in the previous one. */
+    size_t getNumberOfWarmStartedContacts() const;
+    
+private:
+    /** Identifies a contact across frames. */
+    struct FKey
+    {
+        /** Stores the particles of the contact. */
+        FParticleContactKey Particles;
+        
+        /** Stores the generator that reported the contact. */
+        const FParticleContactGenerator* Generator;
+        
+        bool operator==(const FKey&) const = default;
+    };
+    
+    /** Hashes FKey. */
+    struct FKeyHash
+    {
+        size_t operator()(const FKey& key) const;
+    };
+    
+private:
+    /** Stores the impulse of each contact of the previous frame. */
+    std::unordered_map<FKey, FReal, FKeyHash> PreviousImpulses;
+    
+    /** Stores the keys of the contacts of the current frame, in the order they were passed to warmStart(). */
+    std::vector<FKey> CurrentKeys;
+    
+    /** Stores the number of contacts of the current frame that were found in the previous one. */
+    size_t NumberOfWarmStartedContacts = 0;
+};
+
+}   // End of namespace Physics
+}   // End of namespace GE
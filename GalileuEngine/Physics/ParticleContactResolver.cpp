@@ -7,10 +7,26 @@
 
 #include "ParticleContactResolver.hpp"
 
+// STD library includes.
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <utility>
+
 namespace GE
 {
 namespace Physics
 {
+namespace
+{
+
+/** Returns the key a contact is ordered by, Max_number if it needs no resolution. */
+FORCE_INLINE FReal computeKey(const FReal separatingVelocity, const FReal penetrationDepth)
+{
+    return ((separatingVelocity < 0) || (penetrationDepth > 0)) ? separatingVelocity : Math::Max_number;
+}
+
+}   // End of anonymous namespace
 
 FParticleContactResolver::FParticleContactResolver(unsigned maxNumberOfIterations)
 : MaxNumberOfIterations(maxNumberOfIterations)
@@ -22,34 +38,603 @@ void FParticleContactResolver::setMaxNumberOfIterations(unsigned maxNumberOfIter
     MaxNumberOfIterations = maxNumberOfIterations;
 }
 
-void FParticleContactResolver::resolveContacts(std::vector<FParticleContact>& contacts, const FReal deltaTime)
+void FParticleContactResolver::setMaxNumberOfSweeps(unsigned maxNumberOfSweeps)
+{
+    MaxNumberOfSweeps = maxNumberOfSweeps;
+}
+
+void FParticleContactResolver::setSolver(EParticleContactSolver solver)
+{
+    Solver = solver;
+}
+
+EParticleContactSolver FParticleContactResolver::getSolver() const
+{
+    return Solver;
+}
+
+unsigned FParticleContactResolver::getNumberOfIterations() const
+{
+    return UsedNumberOfIterations;
+}
+
+void FParticleContactResolver::resolveContacts(std::span<FParticleContact> contacts, const FReal deltaTime)
+{
+    switch (Solver)
+    {
+        case EParticleContactSolver::Sequential:
+            resolveContactsSequentially(contacts, deltaTime);
+            break;
+            
+        case EParticleContactSolver::Jacobi:
+            resolveContactsJacobi(contacts, deltaTime, nullptr);
+            break;
+            
+        case EParticleContactSolver::ColoredGaussSeidel:
+            resolveContactsColoredGaussSeidel(contacts, deltaTime, nullptr);
+            break;
+    }
+}
+
+void FParticleContactResolver::resolveContacts(std::span<FParticleContact> contacts, const FReal deltaTime, Core::FJobSystem& jobSystem)
+{
+    switch (Solver)
+    {
+        case EParticleContactSolver::Sequential:
+            resolveContactsSequentially(contacts, deltaTime);
+            break;
+            
+        case EParticleContactSolver::Jacobi:
+            resolveContactsJacobi(contacts, deltaTime, &jobSystem);
+            break;
+            
+        case EParticleContactSolver::ColoredGaussSeidel:
+            resolveContactsColoredGaussSeidel(contacts, deltaTime, &jobSystem);
+            break;
+    }
+}
+
+void FParticleContactResolver::applyWarmStartImpulses(std::span<FParticleContact> contacts, Core::FJobSystem* jobSystem)
+{
+    RemainingWarmStartImpulses.resize(contacts.size());
+    bool isAnyContactWarmStarted = false;
+    for (size_t contactIndex = 0; contactIndex < contacts.size(); ++contactIndex)
+    {
+        RemainingWarmStartImpulses[contactIndex] = contacts[contactIndex].AccumulatedImpulse;
+        isAnyContactWarmStarted |= (contacts[contactIndex].AccumulatedImpulse != 0);
+    }
+    if (!isAnyContactWarmStarted)
+    {
+        return;
+    }
+    
+    const auto applyToGroups = [&](size_t begin, size_t end)
+    {
+        for (size_t group = begin; group < end; ++group)
+        {
+            // Sum in contact order, so the result does not depend on the number of threads.
+            FVector3 impulse = FVector3::ZeroVector;
+            for (uint32_t position = ParticleGroupBegins[group]; position < ParticleGroupBegins[group + 1]; ++position)
+            {
+                const uint32_t particleReference = GroupedParticleReferences[position];
+                const FParticleContact& contact = contacts[particleReference / 2];
+                const FReal direction = (particleReference % 2 == 0) ? +1 : -1;
+                impulse += contact.ContactNormal * (direction * contact.AccumulatedImpulse);
+            }
+            
+            const uint32_t particleReference = GroupedParticleReferences[ParticleGroupBegins[group]];
+            FParticle* const particle = contacts[particleReference / 2].Particles[particleReference % 2];
+            particle->addVelocity(impulse * particle->getInverseMass());
+        }
+    };
+    
+    const size_t numberOfGroups = ParticleGroupBegins.size() - 1;
+    if (jobSystem)
+    {
+        jobSystem->parallelFor(numberOfGroups, 64, applyToGroups);
+    }
+    else
+    {
+        applyToGroups(0, numberOfGroups);
+    }
+}
+
+void FParticleContactResolver::resolveContactsSequentially(std::span<FParticleContact> contacts, const FReal deltaTime)
 {
     UsedNumberOfIterations = 0;
+    if (contacts.empty() || (MaxNumberOfIterations == 0))
+    {
+        return;
+    }
+    
+    buildParticleAdjacency(contacts);
+    TotalDisplacements.assign(ParticleGroupBegins.size() - 1, FParticleVector3::ZeroVector);
+    
+    // Build the heap of separating velocities.
+    const uint32_t numberOfContacts = static_cast<uint32_t>(contacts.size());
+    Keys.resize(numberOfContacts);
+    Heap.resize(numberOfContacts);
+    HeapPositions.resize(numberOfContacts);
+    for (uint32_t contactIndex = 0; contactIndex < numberOfContacts; ++contactIndex)
+    {
+        Keys[contactIndex] = computeKey(contacts[contactIndex].computeSeparatingVelocity(), contacts[contactIndex].PenetrationDepth);
+        placeInHeap(contactIndex, contactIndex);
+    }
+    for (size_t heapPosition = numberOfContacts / 2; heapPosition-- > 0;)
+    {
+        siftDown(heapPosition);
+    }
     
     while( UsedNumberOfIterations < MaxNumberOfIterations )
     {
         // Identify the contact with the highest closing velocity, i.e. mininum separating velocity.
-        FReal minSeparatingVelocity = Math::Max_number;
-        size_t minContactIndex = contacts.size();
-        for (size_t contactIndex = 0; contactIndex < contacts.size(); ++contactIndex)
+        const uint32_t minContactIndex = Heap.front();
+        
+        // Did not find a minimum?
+        if (Keys[minContactIndex] == Math::Max_number)
         {
-            const FReal separatingVelocity = contacts[contactIndex].computeSeparatingVelocity();
-            if ((separatingVelocity < minSeparatingVelocity) && ((separatingVelocity < 0) || (contacts[contactIndex].PenetrationDepth > 0)))
+            break;
+        }
+        
+        // Push the particles apart by what is left of the penetration, so resolving the contact again does not push them twice.
+        contacts[minContactIndex].resolveVelocity(deltaTime);
+        resolveCurrentInterpenetration(contacts[minContactIndex], minContactIndex);
+        ++UsedNumberOfIterations;
+        
+        // Only the contact's particles moved, so only the contacts sharing them need new keys.
+        for (unsigned particle = 0; particle < 2; ++particle)
+        {
+            const uint32_t group = ContactParticleGroups[2*minContactIndex + particle];
+            if (group == UINT32_MAX)
             {
-                minSeparatingVelocity = separatingVelocity;
-                minContactIndex = contactIndex;
+                continue;
             }
+            for (uint32_t position = ParticleGroupBegins[group]; position < ParticleGroupBegins[group + 1]; ++position)
+            {
+                updateKey(contacts, GroupedParticleReferences[position] / 2);
+            }
+        }
+    }
+}
+
+void FParticleContactResolver::resolveContactsJacobi(std::span<FParticleContact> contacts, const FReal deltaTime, Core::FJobSystem* jobSystem)
+{
+    UsedNumberOfIterations = 0;
+    if (contacts.empty())
+    {
+        return;
+    }
+    
+    buildParticleAdjacency(contacts);
+    applyWarmStartImpulses(contacts, jobSystem);
+    
+    const uint32_t numberOfContacts = static_cast<uint32_t>(contacts.size());
+    const uint32_t numberOfGroups = static_cast<uint32_t>(ParticleGroupBegins.size() - 1);
+    VelocityChanges.resize(2 * numberOfContacts);
+    TotalDisplacements.assign(numberOfGroups, FParticleVector3::ZeroVector);
+    
+    const auto runInParallel = [jobSystem](size_t count, const Core::FJobSystem::FRangeTask& task)
+    {
+        if (jobSystem)
+        {
+            jobSystem->parallelFor(count, 64, task);
+        }
+        else
+        {
+            task(0, count);
         }
+    };
+    
+    for (unsigned sweep = 0; sweep < MaxNumberOfSweeps; ++sweep)
+    {
+        // Every contact reads the state left by the previous sweep and writes only its own corrections.
+        std::atomic<bool> isAnyContactCorrected = false;
+        runInParallel(numberOfContacts, [&](size_t begin, size_t end)
+        {
+            bool isAnyCorrected = false;
+            for (size_t contactIndex = begin; contactIndex < end; ++contactIndex)
+            {
+                isAnyCorrected |= computeJacobiCorrections(contacts[contactIndex], static_cast<uint32_t>(contactIndex), deltaTime);
+            }
+            if (isAnyCorrected)
+            {
+                isAnyContactCorrected.store(true, std::memory_order_relaxed);
+            }
+        });
         
-        // Did not find a minimum?
-        if (minContactIndex == contacts.size())
+        if (!isAnyContactCorrected.load(std::memory_order_relaxed))
         {
             break;
         }
         
-        contacts[minContactIndex].resolveContact(deltaTime);
-        ++UsedNumberOfIterations;
+        // Every particle reads only its own contacts' corrections.
+        runInParallel(numberOfGroups, [&](size_t begin, size_t end)
+        {
+            for (size_t group = begin; group < end; ++group)
+            {
+                applyJacobiCorrections(contacts, static_cast<uint32_t>(group));
+            }
+        });
+        
+        UsedNumberOfIterations += numberOfContacts;
+    }
+}
+
+bool FParticleContactResolver::computeJacobiCorrections(FParticleContact& contact, uint32_t contactIndex, const FReal deltaTime)
+{
+    FParticleVector3& firstVelocityChange = VelocityChanges[2*contactIndex];
+    FParticleVector3& secondVelocityChange = VelocityChanges[2*contactIndex + 1];
+    firstVelocityChange.zeroOut();
+    secondVelocityChange.zeroOut();
+    contact.Displacements[0].zeroOut();
+    contact.Displacements[1].zeroOut();
+    
+    const FReal totalInverseMass = contact.computeTotalInverseMass();
+    if (totalInverseMass <= 0)
+    {
+        return false;
+    }
+    const FReal firstInverseMass = contact.Particles[0]->getInverseMass();
+    const FReal secondInverseMass = (contact.Particles[1] != nullptr) ? contact.Particles[1]->getInverseMass() : Math::Zero;
+    
+    const FReal impulse = computeParallelImpulse(contact, contactIndex, totalInverseMass, deltaTime);
+    const FVector3 impulsePerInverseMass = contact.ContactNormal * impulse;
+    firstVelocityChange = impulsePerInverseMass * firstInverseMass;
+    secondVelocityChange = impulsePerInverseMass * -secondInverseMass;
+    
+    // Each particle only gets the average of its contacts' corrections, so credit the contact with the smaller share.
+    uint32_t numberOfSharingContacts = getGroupSize(ContactParticleGroups[2*contactIndex]);
+    if (contact.Particles[1] != nullptr)
+    {
+        numberOfSharingContacts = std::max(numberOfSharingContacts, getGroupSize(ContactParticleGroups[2*contactIndex + 1]));
+    }
+    contact.AccumulatedImpulse += impulse / static_cast<FReal>(numberOfSharingContacts);
+    if (impulse < 0)
+    {
+        RemainingWarmStartImpulses[contactIndex] += impulse / static_cast<FReal>(numberOfSharingContacts);
+    }
+    
+    const FReal penetrationDepth = computeCurrentPenetrationDepth(contact, contactIndex);
+    if (penetrationDepth > 0)
+    {
+        const FVector3 movePerInverseMass = contact.ContactNormal * (penetrationDepth / totalInverseMass);
+        contact.Displacements[0] = movePerInverseMass * firstInverseMass;
+        contact.Displacements[1] = movePerInverseMass * -secondInverseMass;
+    }
+    
+    return (impulse != 0) || (penetrationDepth > 0);
+}
+
+void FParticleContactResolver::applyJacobiCorrections(std::span<FParticleContact> contacts, uint32_t group)
+{
+    const uint32_t begin = ParticleGroupBegins[group];
+    const uint32_t end = ParticleGroupBegins[group + 1];
+    
+    FVector3 velocityChange = FVector3::ZeroVector;
+    FVector3 displacement = FVector3::ZeroVector;
+    for (uint32_t position = begin; position < end; ++position)
+    {
+        const uint32_t particleReference = GroupedParticleReferences[position];
+        velocityChange += VelocityChanges[particleReference];
+        displacement += contacts[particleReference / 2].Displacements[particleReference % 2];
+    }
+    
+    const FReal inverseNumberOfContacts = Math::One / static_cast<FReal>(end - begin);
+    velocityChange *= inverseNumberOfContacts;
+    displacement *= inverseNumberOfContacts;
+    
+    FParticle* const particle = contacts[GroupedParticleReferences[begin] / 2].Particles[GroupedParticleReferences[begin] % 2];
+    particle->addVelocity(velocityChange);
+    particle->addDisplacement(displacement);
+    TotalDisplacements[group] += displacement;
+}
+
+void FParticleContactResolver::resolveContactsColoredGaussSeidel(std::span<FParticleContact> contacts, const FReal deltaTime, Core::FJobSystem* jobSystem)
+{
+    UsedNumberOfIterations = 0;
+    if (contacts.empty())
+    {
+        return;
+    }
+    
+    buildParticleAdjacency(contacts);
+    applyWarmStartImpulses(contacts, jobSystem);
+    colorContacts(contacts);
+    
+    const uint32_t numberOfGroups = static_cast<uint32_t>(ParticleGroupBegins.size() - 1);
+    TotalDisplacements.assign(numberOfGroups, FParticleVector3::ZeroVector);
+    
+    const size_t numberOfColors = ColorBegins.size() - 1;
+    for (unsigned sweep = 0; sweep < MaxNumberOfSweeps; ++sweep)
+    {
+        std::atomic<bool> isAnyContactCorrected = false;
+        for (size_t color = 0; color < numberOfColors; ++color)
+        {
+            // The contacts of a color share no particle, so they can be resolved in any order, at the same time.
+            const uint32_t colorBegin = ColorBegins[color];
+            const uint32_t colorEnd = ColorBegins[color + 1];
+            const auto resolveRange = [&](size_t begin, size_t end)
+            {
+                bool isAnyCorrected = false;
+                for (size_t position = colorBegin + begin; position < colorBegin + end; ++position)
+                {
+                    const uint32_t contactIndex = ColoredContacts[position];
+                    isAnyCorrected |= resolveColoredContact(contacts[contactIndex], contactIndex, deltaTime);
+                }
+                if (isAnyCorrected)
+                {
+                    isAnyContactCorrected.store(true, std::memory_order_relaxed);
+                }
+            };
+            
+            if (jobSystem && (color != SequentialColor))
+            {
+                jobSystem->parallelFor(colorEnd - colorBegin, 64, resolveRange);
+            }
+            else
+            {
+                resolveRange(0, colorEnd - colorBegin);
+            }
+        }
+        
+        if (!isAnyContactCorrected.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+        
+        UsedNumberOfIterations += static_cast<unsigned>(contacts.size());
+    }
+}
+
+void FParticleContactResolver::colorContacts(std::span<const FParticleContact> contacts)
+{
+    const uint32_t numberOfContacts = static_cast<uint32_t>(contacts.size());
+    ContactColors.assign(numberOfContacts, SequentialColor);
+    ParticleColorMasks.assign(ParticleGroupBegins.size() - 1, 0);
+    
+    const auto getUsedColors = [this](uint32_t contactIndex)
+    {
+        uint64_t usedColors = ParticleColorMasks[ContactParticleGroups[2*contactIndex]];
+        const uint32_t secondGroup = ContactParticleGroups[2*contactIndex + 1];
+        if (secondGroup != UINT32_MAX)
+        {
+            usedColors |= ParticleColorMasks[secondGroup];
+        }
+        return usedColors;
+    };
+    const auto setColor = [this](uint32_t contactIndex, unsigned color)
+    {
+        ContactColors[contactIndex] = static_cast<uint8_t>(color);
+        ParticleColorMasks[ContactParticleGroups[2*contactIndex]] |= uint64_t{1} << color;
+        const uint32_t secondGroup = ContactParticleGroups[2*contactIndex + 1];
+        if (secondGroup != UINT32_MAX)
+        {
+            ParticleColorMasks[secondGroup] |= uint64_t{1} << color;
+        }
+    };
+    
+    // Keep last frame's colors where possible, so a topology that changes little keeps its coloring.
+    std::vector<uint32_t>& uncoloredContacts = ColoredContacts;     // Used as scratch memory before the sort.
+    uncoloredContacts.clear();
+    for (uint32_t contactIndex = 0; contactIndex < numberOfContacts; ++contactIndex)
+    {
+        const auto previousColor = PreviousColors.find(contacts[contactIndex].getKey());
+        if ((previousColor != PreviousColors.end()) && (previousColor->second < MaxNumberOfColors)
+            && !(getUsedColors(contactIndex) & (uint64_t{1} << previousColor->second)))
+        {
+            setColor(contactIndex, previousColor->second);
+        }
+        else
+        {
+            uncoloredContacts.push_back(contactIndex);
+        }
+    }
+    
+    // Give the new contacts, and the ones that lost their color, the lowest free color.
+    for (const uint32_t contactIndex : uncoloredContacts)
+    {
+        const uint64_t usedColors = getUsedColors(contactIndex);
+        if (usedColors != UINT64_MAX)
+        {
+            setColor(contactIndex, static_cast<unsigned>(std::countr_one(usedColors)));
+        }
+    }
+    
+    // Sort the contacts by color.
+    ColorBegins.assign(MaxNumberOfColors + 2, 0);
+    for (const uint8_t color : ContactColors)
+    {
+        ++ColorBegins[color + 1];
+    }
+    for (size_t color = 0; color <= MaxNumberOfColors; ++color)
+    {
+        ColorBegins[color + 1] += ColorBegins[color];
+    }
+    std::vector<uint32_t> nextPositions(ColorBegins.begin(), ColorBegins.end() - 1);
+    ColoredContacts.resize(numberOfContacts);
+    for (uint32_t contactIndex = 0; contactIndex < numberOfContacts; ++contactIndex)
+    {
+        ColoredContacts[nextPositions[ContactColors[contactIndex]]++] = contactIndex;
+    }
+    
+    CurrentColors.clear();
+    for (uint32_t contactIndex = 0; contactIndex < numberOfContacts; ++contactIndex)
+    {
+        CurrentColors[contacts[contactIndex].getKey()] = ContactColors[contactIndex];
+    }
+    std::swap(PreviousColors, CurrentColors);
+}
+
+bool FParticleContactResolver::resolveColoredContact(FParticleContact& contact, uint32_t contactIndex, const FReal deltaTime)
+{
+    const FReal totalInverseMass = contact.computeTotalInverseMass();
+    if (totalInverseMass <= 0)
+    {
+        return false;
+    }
+    
+    const FReal impulse = computeParallelImpulse(contact, contactIndex, totalInverseMass, deltaTime);
+    const bool isVelocityCorrected = (impulse != 0);
+    if (isVelocityCorrected)
+    {
+        contact.applyImpulse(impulse);
+        if (impulse < 0)
+        {
+            RemainingWarmStartImpulses[contactIndex] += impulse;
+        }
+    }
+    
+    return resolveCurrentInterpenetration(contact, contactIndex) || isVelocityCorrected;
+}
+
+bool FParticleContactResolver::resolveCurrentInterpenetration(FParticleContact& contact, uint32_t contactIndex)
+{
+    const FReal totalInverseMass = contact.computeTotalInverseMass();
+    const FReal penetrationDepth = computeCurrentPenetrationDepth(contact, contactIndex);
+    if ((penetrationDepth <= 0) || (totalInverseMass <= 0))
+    {
+        return false;
+    }
+    
+    const FVector3 movePerInverseMass = contact.ContactNormal * (penetrationDepth / totalInverseMass);
+    contact.Displacements[0] = movePerInverseMass * contact.Particles[0]->getInverseMass();
+    contact.Particles[0]->addDisplacement(contact.Displacements[0]);
+    TotalDisplacements[ContactParticleGroups[2*contactIndex]] += contact.Displacements[0];
+    if (contact.Particles[1] != nullptr)
+    {
+        contact.Displacements[1] = movePerInverseMass * -contact.Particles[1]->getInverseMass();
+        contact.Particles[1]->addDisplacement(contact.Displacements[1]);
+        TotalDisplacements[ContactParticleGroups[2*contactIndex + 1]] += contact.Displacements[1];
+    }
+    else
+    {
+        contact.Displacements[1].zeroOut();
+    }
+    
+    return true;
+}
+
+FReal FParticleContactResolver::computeParallelImpulse(const FParticleContact& contact, uint32_t contactIndex, FReal totalInverseMass, const FReal deltaTime) const
+{
+    const FReal separatingVelocity = contact.computeSeparatingVelocity();
+    const FReal impulse = contact.computeImpulse(separatingVelocity, deltaTime);
+    if ((impulse != 0) || (separatingVelocity <= 0) || (RemainingWarmStartImpulses[contactIndex] <= 0))
+    {
+        return impulse;
+    }
+    
+    // The warm start pushed the particles apart more than needed now: take back what is left of it, up to stopping them.
+    return -std::min(separatingVelocity / totalInverseMass, RemainingWarmStartImpulses[contactIndex]);
+}
+
+FReal FParticleContactResolver::computeCurrentPenetrationDepth(const FParticleContact& contact, uint32_t contactIndex) const
+{
+    // The contact's penetration depth is as of its generation, so subtract how much the particles have been pushed apart since.
+    FVector3 relativeDisplacement = TotalDisplacements[ContactParticleGroups[2*contactIndex]];
+    const uint32_t secondGroup = ContactParticleGroups[2*contactIndex + 1];
+    if (secondGroup != UINT32_MAX)
+    {
+        relativeDisplacement -= TotalDisplacements[secondGroup];
+    }
+    return contact.PenetrationDepth - (relativeDisplacement | contact.ContactNormal);
+}
+
+void FParticleContactResolver::buildParticleAdjacency(std::span<const FParticleContact> contacts)
+{
+    // Different views (FParticle objects) may refer to the same particle, so compare the particles themselves.
+    const auto getParticleKey = [&contacts](uint32_t particleReference)
+    {
+        const FParticle* const particle = contacts[particleReference / 2].Particles[particleReference % 2];
+        return std::make_pair(particle->getStore(), particle->getHandle().Index);
+    };
+    
+    // A particle reference is (2 * contact index + particle slot in the contact).
+    std::vector<uint32_t>& particleReferences = GroupedParticleReferences;
+    particleReferences.clear();
+    for (uint32_t contactIndex = 0; contactIndex < contacts.size(); ++contactIndex)
+    {
+        CHECK(contacts[contactIndex].Particles[0] != nullptr)
+        
+        particleReferences.push_back(2*contactIndex);
+        if (contacts[contactIndex].Particles[1] != nullptr)
+        {
+            particleReferences.push_back(2*contactIndex + 1);
+        }
+    }
+    std::sort(particleReferences.begin(), particleReferences.end(), [&](uint32_t lhs, uint32_t rhs)
+    {
+        return std::make_pair(getParticleKey(lhs), lhs) < std::make_pair(getParticleKey(rhs), rhs);
+    });
+    
+    ContactParticleGroups.assign(2 * contacts.size(), UINT32_MAX);
+    ParticleGroupBegins.clear();
+    uint32_t previousParticleReference = 0;
+    for (uint32_t position = 0; position < particleReferences.size(); ++position)
+    {
+        const uint32_t particleReference = particleReferences[position];
+        if ((position == 0) || (getParticleKey(particleReference) != getParticleKey(previousParticleReference)))
+        {
+            ParticleGroupBegins.push_back(position);
+        }
+        ContactParticleGroups[particleReference] = static_cast<uint32_t>(ParticleGroupBegins.size() - 1);
+        previousParticleReference = particleReference;
+    }
+    ParticleGroupBegins.push_back(static_cast<uint32_t>(particleReferences.size()));
+}
+
+void FParticleContactResolver::updateKey(std::span<const FParticleContact> contacts, uint32_t contactIndex)
+{
+    const FReal oldKey = Keys[contactIndex];
+    Keys[contactIndex] = computeKey(contacts[contactIndex].computeSeparatingVelocity(), computeCurrentPenetrationDepth(contacts[contactIndex], contactIndex));
+    if (Keys[contactIndex] < oldKey)
+    {
+        siftUp(HeapPositions[contactIndex]);
+    }
+    else if (Keys[contactIndex] > oldKey)
+    {
+        siftDown(HeapPositions[contactIndex]);
+    }
+}
+
+void FParticleContactResolver::siftUp(size_t heapPosition)
+{
+    const uint32_t contactIndex = Heap[heapPosition];
+    while (heapPosition > 0)
+    {
+        const size_t parentPosition = (heapPosition - 1) / 2;
+        if (!isBefore(contactIndex, Heap[parentPosition]))
+        {
+            break;
+        }
+        placeInHeap(Heap[parentPosition], heapPosition);
+        heapPosition = parentPosition;
+    }
+    placeInHeap(contactIndex, heapPosition);
+}
+
+void FParticleContactResolver::siftDown(size_t heapPosition)
+{
+    const uint32_t contactIndex = Heap[heapPosition];
+    const size_t heapSize = Heap.size();
+    while (true)
+    {
+        size_t childPosition = 2*heapPosition + 1;
+        if (childPosition >= heapSize)
+        {
+            break;
+        }
+        if ((childPosition + 1 < heapSize) && isBefore(Heap[childPosition + 1], Heap[childPosition]))
+        {
+            ++childPosition;
+        }
+        if (!isBefore(Heap[childPosition], contactIndex))
+        {
+            break;
+        }
+        placeInHeap(Heap[childPosition], heapPosition);
+        heapPosition = childPosition;
     }
+    placeInHeap(contactIndex, heapPosition);
 }
 
 }   // End of namespace Physics
@@ -11,9 +11,13 @@
 #include "Math.hpp"
 #include "Particle.hpp"
 #include "ParticleContact.hpp"
+#include "JobSystem.hpp"
 
 // STD library includes.
+#include <span>
 #include <vector>
+#include <cstdint>
+#include <unordered_map>
 
 namespace GE
 {
@@ -21,6 +25,38 @@ namespace Physics
 {
 using Math::FReal;
 
+/**
+ * The algorithms FParticleContactResolver can resolve contacts with.
+ */
+enum class EParticleContactSolver
+{
+    /**
+     * Resolves one contact per iteration, the one with the lowest separating velocity.
+     * The contacts are kept in a min-heap keyed by that velocity, and resolving a contact only re-keys the contacts
+     * sharing a particle with it, so an iteration costs O(k log n), k being the number of neighbouring contacts.
+     * As in the parallel solvers, the penetration depths are reduced by how far the particles have been pushed apart since.
+     * It ignores the contacts' accumulated impulses: it could not take back a warm start that turns out too strong.
+     */
+    Sequential,
+    
+    /**
+     * Computes the corrections of all contacts at once, from the same state, then moves each particle by the average of
+     * its contacts' corrections; and repeats, up to the maximum number of sweeps.
+     * Both passes run in parallel when a job system is given, and the sums are always taken in contact order, so the
+     * results do not depend on the number of threads. Converges slower than Sequential per contact resolved.
+     */
+    Jacobi,
+    
+    /**
+     * Colors the contacts so that no two contacts of the same color share a particle, then resolves the colors one
+     * after the other, each color's contacts in parallel; and repeats, up to the maximum number of sweeps.
+     * Each contact sees the corrections of the previous colors, as in Sequential, so it converges about as fast per
+     * sweep as resolving all contacts in order. Colors are kept from the previous frame whenever they remain valid.
+     * The results do not depend on the number of threads.
+     */
+    ColoredGaussSeidel
+};
+
 /**
  * This class is responsible for resolving particle contacts.
  */
@@ -41,18 +77,197 @@ public:
      */
     void setMaxNumberOfIterations(unsigned maxNumberOfIterations);
     
+    /**
+     * Sets the maximum number of sweeps over all contacts performed by the parallel solvers. They stop earlier once no contact needs resolution.
+     *
+     * @param maxNumberOfSweeps The new value.
+     */
+    void setMaxNumberOfSweeps(unsigned maxNumberOfSweeps);
+    
+    /**
+     * Sets the algorithm resolving the contacts. The default is EParticleContactSolver::Sequential.
+     *
+     * @param solver The new algorithm.
+     */
+    void setSolver(EParticleContactSolver solver);
+    
+    /** Returns the algorithm resolving the contacts. */
+    EParticleContactSolver getSolver() const;
+    
+    /** Returns the number of contact resolutions performed the last time the contacts were resolved, sweeps times contacts for the parallel solvers. */
+    unsigned getNumberOfIterations() const;
+    
     /**
      * Handles a set of particle contacts to resolve both velocity and penetration.
+     * The parallel solvers apply the contacts' accumulated impulses first, see FParticleContact::AccumulatedImpulse.
+     *
+     * @param contacts The contacts, all of them filled in.
+     * @param deltaTime The integration time.
+     */
+    void resolveContacts(std::span<FParticleContact> contacts, const FReal deltaTime);
+    
+    /**
+     * Handles a set of particle contacts to resolve both velocity and penetration, spreading the work of the parallel solvers across jobs.
+     *
+     * @param contacts The contacts, all of them filled in.
+     * @param deltaTime The integration time.
+     * @param jobSystem The job system to run on.
+     */
+    void resolveContacts(std::span<FParticleContact> contacts, const FReal deltaTime, Core::FJobSystem& jobSystem);
+    
+private:
+    /** Applies the contacts' accumulated impulses to their particles, one particle group at a time. */
+    void applyWarmStartImpulses(std::span<FParticleContact> contacts, Core::FJobSystem* jobSystem);
+    
+    /** Resolves the contacts with EParticleContactSolver::Sequential. */
+    void resolveContactsSequentially(std::span<FParticleContact> contacts, const FReal deltaTime);
+    
+    /** Resolves the contacts with EParticleContactSolver::Jacobi, on the job system if given. */
+    void resolveContactsJacobi(std::span<FParticleContact> contacts, const FReal deltaTime, Core::FJobSystem* jobSystem);
+    
+    /**
+     * Computes the velocity and position corrections of a contact from the current state, storing them in
+     * VelocityChanges and the contact's Displacements.
+     *
+     * @return Whether the contact needed any correction.
+     */
+    bool computeJacobiCorrections(FParticleContact& contact, uint32_t contactIndex, const FReal deltaTime);
+    
+    /** Applies to a particle the average of its contacts' corrections. */
+    void applyJacobiCorrections(std::span<FParticleContact> contacts, uint32_t group);
+    
+    /** Resolves the contacts with EParticleContactSolver::ColoredGaussSeidel, on the job system if given. */
+    void resolveContactsColoredGaussSeidel(std::span<FParticleContact> contacts, const FReal deltaTime, Core::FJobSystem* jobSystem);
+    
+    /**
+     * Assigns a color to each contact, filling ColorBegins and ColoredContacts, and remembers them for the next frame.
+     * Contacts first try the color their pair of particles had in the previous frame, then take the lowest free one.
+     */
+    void colorContacts(std::span<const FParticleContact> contacts);
+    
+    /**
+     * Resolves a contact right away, updating the particles' velocities and positions.
+     *
+     * @return Whether the contact needed any correction.
+     */
+    bool resolveColoredContact(FParticleContact& contact, uint32_t contactIndex, const FReal deltaTime);
+    
+    /**
+     * Pushes a contact's particles apart by its current penetration depth, see computeCurrentPenetrationDepth(), and adds the displacements to TotalDisplacements.
+     *
+     * @return Whether the particles were moved.
+     */
+    bool resolveCurrentInterpenetration(FParticleContact& contact, uint32_t contactIndex);
+    
+    /** Returns the number of contacts of a particle group. */
+    FORCE_INLINE uint32_t getGroupSize(uint32_t group) const
+    {
+        return ParticleGroupBegins[group + 1] - ParticleGroupBegins[group];
+    }
+    
+    /**
+     * Computes the impulse the parallel solvers apply to a contact: the one resolving its separating velocity or, if it
+     * is separating, minus the part of its warm-start impulse not taken back yet, enough to stop the separation at most.
      */
-    void resolveContacts(std::vector<FParticleContact>& contacts, const FReal deltaTime);
+    FReal computeParallelImpulse(const FParticleContact& contact, uint32_t contactIndex, FReal totalInverseMass, const FReal deltaTime) const;
+    
+    /** Returns a contact's penetration depth, minus how much the resolver has pushed its particles apart. */
+    FReal computeCurrentPenetrationDepth(const FParticleContact& contact, uint32_t contactIndex) const;
+    
+
+    /** Groups the contacts by particle, filling ParticleGroupBegins, GroupedParticleReferences and ContactParticleGroups. */
+    void buildParticleAdjacency(std::span<const FParticleContact> contacts);
+    
+    /** Recomputes a contact's key and restores the heap property around it. */
+    void updateKey(std::span<const FParticleContact> contacts, uint32_t contactIndex);
+    
+    /** Returns whether the first contact must be resolved before the second one: lower key first, then lower index. */
+    FORCE_INLINE bool isBefore(uint32_t firstContactIndex, uint32_t secondContactIndex) const
+    {
+        return (Keys[firstContactIndex] < Keys[secondContactIndex])
+            || ((Keys[firstContactIndex] == Keys[secondContactIndex]) && (firstContactIndex < secondContactIndex));
+    }
+    
+    /** Moves the contact at the given heap position up while it goes before its parent. */
+    void siftUp(size_t heapPosition);
+    
+    /** Moves the contact at the given heap position down while a child goes before it. */
+    void siftDown(size_t heapPosition);
+    
+    /** Places a contact at a heap position. */
+    FORCE_INLINE void placeInHeap(uint32_t contactIndex, size_t heapPosition)
+    {
+        Heap[heapPosition] = contactIndex;
+        HeapPositions[contactIndex] = static_cast<uint32_t>(heapPosition);
+    }
     
 protected:
     /** Stores the maximum number of iteratons allowed while resolving contacts. */
     unsigned MaxNumberOfIterations;
     
     /** Stores the actual number of iterations performed last time the solver has run. */
-    unsigned UsedNumberOfIterations;
-
+    unsigned UsedNumberOfIterations = 0;
+    
+    /** Stores the maximum number of sweeps over all contacts performed by the parallel solvers. */
+    unsigned MaxNumberOfSweeps = 16;
+    
+    /** Stores the algorithm resolving the contacts. */
+    EParticleContactSolver Solver = EParticleContactSolver::Sequential;
+    
+private:
+    /** Stores each contact's separating velocity, or Max_number if it needs no resolution. */
+    std::vector<FReal> Keys;
+    
+    /** Stores the contact indices as a binary min-heap. */
+    std::vector<uint32_t> Heap;
+    
+    /** Stores the position of each contact in Heap. */
+    std::vector<uint32_t> HeapPositions;
+    
+    /** Stores the particle references, (2 * contact index + slot of the particle in the contact), grouped by particle and sorted within groups. */
+    std::vector<uint32_t> GroupedParticleReferences;
+    
+    /** Stores where each particle's group begins in GroupedParticleReferences, plus one past the last group. */
+    std::vector<uint32_t> ParticleGroupBegins;
+    
+    /** Stores, for each contact, the group of each of its particles, or UINT32_MAX if there is no second particle. */
+    std::vector<uint32_t> ContactParticleGroups;
+    
+    /** Stores, for each contact, how much of the warm-start impulse the parallel solvers may still take back. */
+    std::vector<FReal> RemainingWarmStartImpulses;
+    
+    /** Stores the velocity change of each particle reference computed by the last Jacobi sweep. */
+    Core::TCacheAlignedVector<FParticleVector3> VelocityChanges;
+    
+    /** Stores the displacement of each particle group accumulated by the solvers, to track the penetration depths. */
+    Core::TCacheAlignedVector<FParticleVector3> TotalDisplacements;
+    
+    /** Stores the number of colors with no shared particles. Each particle tracks the colors of its contacts in a 64-bit mask. */
+    static constexpr unsigned MaxNumberOfColors = 64;
+    
+    /**
+     * Stores the color of the contacts that could not get one of the MaxNumberOfColors colors.
+     * They form an extra last color, resolved by a single thread.
+     */
+    static constexpr uint8_t SequentialColor = MaxNumberOfColors;
+    
+    /** Stores where each color begins in ColoredContacts, plus one past the last color. */
+    std::vector<uint32_t> ColorBegins;
+    
+    /** Stores the contact indices sorted by color, and by index within a color. */
+    std::vector<uint32_t> ColoredContacts;
+    
+    /** Stores the color of each contact. */
+    std::vector<uint8_t> ContactColors;
+    
+    /** Stores the colors used by the contacts of each particle group. */
+    std::vector<uint64_t> ParticleColorMasks;
+    
+    /** Stores the color of each pair of particles in the previous frame. */
+    std::unordered_map<FParticleContactKey, uint8_t, FParticleContactKeyHash> PreviousColors;
+    
+    /** Stores the colors of the current frame, swapped with PreviousColors at the end of colorContacts(). */
+    std::unordered_map<FParticleContactKey, uint8_t, FParticleContactKeyHash> CurrentColors;
 };
 
 }   // End of namespace Physics
@@ -7,40 +7,357 @@
 
 #include "ParticleForcePairManager.hpp"
 
+// GE includes.
+#include "ParticleGravityGenerator.hpp"
+#include "ParticleSpringGenerator.hpp"
+#include "ParticleBuoyancyGenerator.hpp"
+
 // STD library includes.
 #include <algorithm>
+#include <unordered_set>
 
 namespace GE
 {
 namespace Physics
 {
+namespace
+{
+
+/**
+ * Runs the kernel of a generator type over some pairs, which must all have a generator of that type.
+ */
+template<typename TParticleForceGenerator, typename TParticleForcePair>
+void applyForces(std::span<const TParticleForcePair> particleForcePairs)
+{
+    for (const TParticleForcePair& pair : particleForcePairs)
+    {
+        FParticleStore& particleStore = *pair.Particle->getStore();
+        const auto* generator = static_cast<const TParticleForceGenerator*>(pair.ParticleForceGenerator);
+        generator->applyForce(particleStore, particleStore.getIndex(pair.Particle->getHandle()));
+    }
+}
+
+}   // End of anonymous namespace
+
+FParticleForcePairHandle FParticleForcePairManager::add(FParticle* particle, FParticleForceGenerator* particleForceGenerator)
+{
+    const EParticleForceGeneratorType type = particleForceGenerator->getType();
+    FGroupedPairs& groupedPairs = getGroupedPairs(type);
+    const uint32_t pairIndex = static_cast<uint32_t>(groupedPairs.Pairs.size());
+    
+    // Reuse a free slot, if any.
+    uint32_t slotIndex = FirstFreeSlot;
+    if (slotIndex != FParticleForcePairHandle::InvalidIndex)
+    {
+        FirstFreeSlot = Slots[slotIndex].Index;
+        Slots[slotIndex].Index = pairIndex;
+        Slots[slotIndex].Type = type;
+    }
+    else
+    {
+        slotIndex = static_cast<uint32_t>(Slots.size());
+        Slots.push_back(FSlot{ .Index = pairIndex, .Generation = 0, .Type = type });
+    }
+    
+    // The pair waits after the grouped ones until the next merge.
+    groupedPairs.Pairs.push_back(FParticleForcePair{particle, particleForceGenerator, particle->getStore(), particle->getHandle().Index, slotIndex});
+    ++groupedPairs.NumberOfLivePairs;
+    
+    return FParticleForcePairHandle{ .Index = slotIndex, .Generation = Slots[slotIndex].Generation };
+}
 
-void FParticleForcePairManager::add(FParticle* particle, FParticleForceGenerator* particleForceGenerator)
+void FParticleForcePairManager::remove(FParticleForcePairHandle handle)
 {
-    ParticleForcePairs.emplace_back(FParticleForcePair{particle, particleForceGenerator});
+    CHECK(contains(handle))
+    
+    const FSlot& slot = Slots[handle.Index];
+    removeAt(getGroupedPairs(slot.Type), slot.Index);
+    mergeMostlyDeadPairs();
 }
 
 void FParticleForcePairManager::remove(FParticle* particle, FParticleForceGenerator* particleForceGenerator)
 {
-    auto isEqualPredicate = [=](FParticleForcePair& pair)
+    // Removed pairs are only marked dead, so nothing moves while scanning.
+    for (FGroupedPairs& groupedPairs : getGroupedPairs())
     {
-        return (pair.Particle == particle) && (pair.ParticleForceGenerator == particleForceGenerator);
-    };
-    std::erase_if(ParticleForcePairs, isEqualPredicate);
+        for (size_t pairIndex = 0; pairIndex < groupedPairs.Pairs.size(); ++pairIndex)
+        {
+            const FParticleForcePair& pair = groupedPairs.Pairs[pairIndex];
+            if ((pair.Particle == particle) && (pair.ParticleForceGenerator == particleForceGenerator))
+            {
+                removeAt(groupedPairs, pairIndex);
+            }
+        }
+    }
+    mergeMostlyDeadPairs();
+}
+
+void FParticleForcePairManager::removeAll(std::span<const FParticle> particles)
+{
+    // Different views (FParticle objects) may refer to the same particle, so compare the particles themselves.
+    std::unordered_set<FParticleKey, FParticleKeyHash> particlesToRemove;
+    particlesToRemove.reserve(particles.size());
+    for (const FParticle& particle : particles)
+    {
+        particlesToRemove.insert(FParticleKey{ .Store = particle.getStore(), .Handle = particle.getHandle() });
+    }
+    if (particlesToRemove.empty())
+    {
+        return;
+    }
+    
+    // Removed pairs are only marked dead, so nothing moves while scanning.
+    for (FGroupedPairs& groupedPairs : getGroupedPairs())
+    {
+        for (size_t pairIndex = 0; pairIndex < groupedPairs.Pairs.size(); ++pairIndex)
+        {
+            const FParticle* particle = groupedPairs.Pairs[pairIndex].Particle;
+            if ((particle != nullptr) && particlesToRemove.contains(FParticleKey{ .Store = particle->getStore(), .Handle = particle->getHandle() }))
+            {
+                removeAt(groupedPairs, pairIndex);
+            }
+        }
+    }
+    mergeMostlyDeadPairs();
+}
+
+bool FParticleForcePairManager::contains(FParticleForcePairHandle handle) const
+{
+    return (handle.Index < Slots.size()) && (Slots[handle.Index].Generation == handle.Generation);
+}
+
+size_t FParticleForcePairManager::size() const
+{
+    if (Dispatch == EParticleForceDispatch::Bucketed)
+    {
+        size_t numberOfPairs = 0;
+        for (const FGroupedPairs& bucket : Buckets)
+        {
+            numberOfPairs += bucket.NumberOfLivePairs;
+        }
+        return numberOfPairs;
+    }
+    
+    return AllPairs.NumberOfLivePairs;
 }
 
 void FParticleForcePairManager::clear()
 {
-    ParticleForcePairs.clear();
+    for (FGroupedPairs& groupedPairs : getGroupedPairs())
+    {
+        for (size_t pairIndex = 0; pairIndex < groupedPairs.Pairs.size(); ++pairIndex)
+        {
+            if (groupedPairs.Pairs[pairIndex].Particle != nullptr)
+            {
+                removeAt(groupedPairs, pairIndex);
+            }
+        }
+        groupedPairs = FGroupedPairs{};
+    }
 }
 
 void FParticleForcePairManager::updateForces(FReal deltaTime)
 {
-    for (FParticleForcePair& pair : ParticleForcePairs)
+    for (FGroupedPairs& groupedPairs : getGroupedPairs())
+    {
+        mergeChanges(groupedPairs);
+    }
+    
+    if (Dispatch == EParticleForceDispatch::Bucketed)
+    {
+        for (size_t bucketIndex = 0; bucketIndex < NumberOfBuckets; ++bucketIndex)
+        {
+            const auto type = static_cast<EParticleForceGeneratorType>(bucketIndex);
+            updateForces(type, 0, getNumberOfGroups(type), deltaTime);
+        }
+        return;
+    }
+    
+    // The pairs are grouped by particle, as when spread across jobs, so the forces are summed in the same order.
+    for (FParticleForcePair& pair : AllPairs.Pairs)
     {
         pair.ParticleForceGenerator->updateForce(pair.Particle, deltaTime);
     }
 }
 
+void FParticleForcePairManager::updateForces(FReal deltaTime, Core::FJobSystem& jobSystem)
+{
+    for (FGroupedPairs& groupedPairs : getGroupedPairs())
+    {
+        mergeChanges(groupedPairs);
+    }
+    
+    if (Dispatch == EParticleForceDispatch::Bucketed)
+    {
+        // One bucket after the other, so each particle is written by one thread at a time, in the same order as updateForces(deltaTime).
+        for (size_t bucketIndex = 0; bucketIndex < NumberOfBuckets; ++bucketIndex)
+        {
+            const auto type = static_cast<EParticleForceGeneratorType>(bucketIndex);
+            jobSystem.parallelFor(getNumberOfGroups(type), 64, [&](size_t beginGroup, size_t endGroup)
+            {
+                updateForces(type, beginGroup, endGroup, deltaTime);
+            });
+        }
+        return;
+    }
+    
+    const std::vector<uint32_t>& groupBegins = AllPairs.GroupBegins;
+    jobSystem.parallelFor(groupBegins.size() - 1, 1, [&](size_t beginGroup, size_t endGroup)
+    {
+        for (size_t pairIndex = groupBegins[beginGroup]; pairIndex < groupBegins[endGroup]; ++pairIndex)
+        {
+            FParticleForcePair& pair = AllPairs.Pairs[pairIndex];
+            pair.ParticleForceGenerator->updateForce(pair.Particle, deltaTime);
+        }
+    });
+}
+
+void FParticleForcePairManager::setDispatch(EParticleForceDispatch dispatch)
+{
+    if (dispatch == Dispatch)
+    {
+        return;
+    }
+    
+    // Move the live pairs over, after the grouped ones, so the next update groups them.
+    const std::span<FGroupedPairs> previousGroupedPairs = getGroupedPairs();
+    Dispatch = dispatch;
+    for (FGroupedPairs& groupedPairs : previousGroupedPairs)
+    {
+        for (const FParticleForcePair& pair : groupedPairs.Pairs)
+        {
+            if (pair.Particle != nullptr)
+            {
+                FGroupedPairs& newGroupedPairs = getGroupedPairs(Slots[pair.SlotIndex].Type);
+                Slots[pair.SlotIndex].Index = static_cast<uint32_t>(newGroupedPairs.Pairs.size());
+                newGroupedPairs.Pairs.push_back(pair);
+                ++newGroupedPairs.NumberOfLivePairs;
+            }
+        }
+        groupedPairs = FGroupedPairs{};
+    }
+}
+
+EParticleForceDispatch FParticleForcePairManager::getDispatch() const
+{
+    return Dispatch;
+}
+
+void FParticleForcePairManager::updateForces(EParticleForceGeneratorType type, size_t beginGroup, size_t endGroup, FReal deltaTime)
+{
+    const FGroupedPairs& bucket = Buckets[static_cast<size_t>(type)];
+    const std::span<const FParticleForcePair> pairs = std::span{bucket.Pairs}.subspan(bucket.GroupBegins[beginGroup], bucket.GroupBegins[endGroup] - bucket.GroupBegins[beginGroup]);
+    switch (type)
+    {
+        case EParticleForceGeneratorType::Gravity:
+            applyForces<FParticleGravityGenerator>(pairs);
+            break;
+        case EParticleForceGeneratorType::Spring:
+            applyForces<FParticleSpringGenerator>(pairs);
+            break;
+        case EParticleForceGeneratorType::Buoyancy:
+            applyForces<FParticleBuoyancyGenerator>(pairs);
+            break;
+        case EParticleForceGeneratorType::Custom:
+            for (const FParticleForcePair& pair : pairs)
+            {
+                pair.ParticleForceGenerator->updateForce(pair.Particle, deltaTime);
+            }
+            break;
+    }
+}
+
+size_t FParticleForcePairManager::getNumberOfGroups(EParticleForceGeneratorType type) const
+{
+    return Buckets[static_cast<size_t>(type)].GroupBegins.size() - 1;
+}
+
+FParticleForcePairManager::FGroupedPairs& FParticleForcePairManager::getGroupedPairs(EParticleForceGeneratorType type)
+{
+    return (Dispatch == EParticleForceDispatch::Bucketed)? Buckets[static_cast<size_t>(type)] : AllPairs;
+}
+
+std::span<FParticleForcePairManager::FGroupedPairs> FParticleForcePairManager::getGroupedPairs()
+{
+    return (Dispatch == EParticleForceDispatch::Bucketed)? std::span<FGroupedPairs>{Buckets} : std::span<FGroupedPairs>{&AllPairs, 1};
+}
+
+void FParticleForcePairManager::removeAt(FGroupedPairs& groupedPairs, size_t pairIndex)
+{
+    CHECK((pairIndex < groupedPairs.Pairs.size()) && (groupedPairs.Pairs[pairIndex].Particle != nullptr))
+    
+    FParticleForcePair& pair = groupedPairs.Pairs[pairIndex];
+    pair.Particle = nullptr;
+    --groupedPairs.NumberOfLivePairs;
+    
+    // Invalidate the handle and put its slot in the free list.
+    FSlot& slot = Slots[pair.SlotIndex];
+    ++slot.Generation;
+    slot.Index = FirstFreeSlot;
+    FirstFreeSlot = pair.SlotIndex;
+}
+
+void FParticleForcePairManager::mergeChanges(FGroupedPairs& groupedPairs)
+{
+    std::vector<FParticleForcePair>& pairs = groupedPairs.Pairs;
+    if ((groupedPairs.NumberOfGroupedPairs == pairs.size()) && (groupedPairs.NumberOfLivePairs == pairs.size()))
+    {
+        return;
+    }
+    
+    // Drop the dead pairs, keeping the order of the live ones.
+    size_t numberOfGroupedPairs = 0;
+    size_t numberOfLivePairs = 0;
+    for (size_t pairIndex = 0; pairIndex < pairs.size(); ++pairIndex)
+    {
+        if (pairs[pairIndex].Particle != nullptr)
+        {
+            numberOfGroupedPairs += (pairIndex < groupedPairs.NumberOfGroupedPairs)? 1 : 0;
+            pairs[numberOfLivePairs++] = pairs[pairIndex];
+        }
+    }
+    pairs.resize(numberOfLivePairs);
+    
+    // Different views (FParticle objects) may refer to the same particle, so compare the particles themselves.
+    // Both steps are stable and the grouped pairs come first, so the pairs of a particle stay in the order they were added.
+    const auto isBefore = [](const FParticleForcePair& lhs, const FParticleForcePair& rhs)
+    {
+        return std::make_pair(lhs.ParticleStore, lhs.ParticleSlotIndex) < std::make_pair(rhs.ParticleStore, rhs.ParticleSlotIndex);
+    };
+    std::stable_sort(pairs.begin() + numberOfGroupedPairs, pairs.end(), isBefore);
+    std::inplace_merge(pairs.begin(), pairs.begin() + numberOfGroupedPairs, pairs.end(), isBefore);
+    
+    groupedPairs.GroupBegins.clear();
+    for (size_t pairIndex = 0; pairIndex < pairs.size(); ++pairIndex)
+    {
+        Slots[pairs[pairIndex].SlotIndex].Index = static_cast<uint32_t>(pairIndex);
+        if ((pairIndex == 0) || isBefore(pairs[pairIndex - 1], pairs[pairIndex]))
+        {
+            groupedPairs.GroupBegins.push_back(static_cast<uint32_t>(pairIndex));
+        }
+    }
+    groupedPairs.GroupBegins.push_back(static_cast<uint32_t>(pairs.size()));
+    groupedPairs.NumberOfGroupedPairs = pairs.size();
+}
+
+void FParticleForcePairManager::mergeMostlyDeadPairs()
+{
+    for (FGroupedPairs& groupedPairs : getGroupedPairs())
+    {
+        const size_t numberOfDeadPairs = groupedPairs.Pairs.size() - groupedPairs.NumberOfLivePairs;
+        if ((numberOfDeadPairs > groupedPairs.NumberOfLivePairs) && (numberOfDeadPairs >= 64))
+        {
+            mergeChanges(groupedPairs);
+        }
+    }
+}
+
+size_t FParticleForcePairManager::FParticleKeyHash::operator()(const FParticleKey& key) const
+{
+    const size_t storeHash = std::hash<const FParticleStore*>{}(key.Store);
+    const size_t handleHash = (static_cast<size_t>(key.Handle.Generation) << 32) ^ key.Handle.Index;
+    return storeHash ^ (handleHash * 0x9E3779B97F4A7C15ull);
+}
+
 }   // End of namespace Physics
 }   // End of namespace GE
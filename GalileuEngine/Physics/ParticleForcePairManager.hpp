@@ -12,8 +12,13 @@
 #include "Vector3.hpp"
 #include "Particle.hpp"
 #include "ParticleForceGenerator.hpp"
+#include "JobSystem.hpp"
 
 // STD library includes.
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
 #include <vector>
 
 namespace GE
@@ -23,24 +28,91 @@ namespace Physics
 using Math::FVector3;
 using Math::FReal;
 
+/**
+ * A stable reference to a particle-force pair registered in a FParticleForcePairManager.
+ * It remains valid until the pair is removed, even when the manager moves its pairs around.
+ */
+struct FParticleForcePairHandle
+{
+    /** The value of Index for a handle that does not refer to any pair. */
+    static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+    
+    /** Stores the slot of the pair in the manager's indirection table. */
+    uint32_t Index = InvalidIndex;
+    
+    /** Stores the slot's generation, so that handles to removed pairs can be told apart from handles to newer ones reusing the slot. */
+    uint32_t Generation = 0;
+    
+    bool operator==(const FParticleForcePairHandle&) const = default;
+};
+
+/**
+ * The ways FParticleForcePairManager can call the force generators.
+ */
+enum class EParticleForceDispatch
+{
+    /**
+     * One virtual updateForce() call per pair, grouped by particle. The pairs of a particle run in the order they were added, or,
+     * for the pairs added before switching from Bucketed, by type then in the order they were added.
+     */
+    Virtual,
+    
+    /**
+     * The pairs are bucketed by the type of their generator (see EParticleForceGeneratorType) and grouped by particle, the groups
+     * sorted by particle slot (see FParticleHandle), then each bucket runs the inlined kernel of its type over its pairs, without virtual calls.
+     * The Custom bucket falls back to updateForce(). Within a bucket, the pairs of a particle run in the order they were added.
+     * The buckets run in the order of the types, so the forces of a particle may be summed in a different order than with Virtual, and differ by rounding.
+     */
+    Bucketed
+};
+
 /**
  * Stores all the force generators and the particles they act upon.
+ * Adding and removing a pair take constant time. The pairs are kept grouped by particle, and bucketed with the Bucketed dispatch: the next update
+ * merges the pairs added since the previous one into the groups, in one pass over the pairs, so pairs can come and go every frame.
  */
 class FParticleForcePairManager
 {
 public:
     /**
      * Registers a particle-force pair.
+     *
+     * @return A handle to the pair, to remove it in constant time.
      */
-    void add(FParticle* particle, FParticleForceGenerator* particleForceGenerator);
+    FParticleForcePairHandle add(FParticle* particle, FParticleForceGenerator* particleForceGenerator);
+    
+    /**
+     * Unregisters a particle-force pair in constant time.
+     * No particle, or force, will be deleted, only the relation between them will be deleted.
+     *
+     * @param handle The handle returned by add(). The pair must still be registered.
+     */
+    void remove(FParticleForcePairHandle handle);
     
     /**
      * Tries to unresgister a particle-force pair.
      * No particle, or force, will be deleted, only the relation between them will be deleted.
      * There will be no effect in case the pair is not registered.
+     * This scans every pair; prefer remove(handle).
      */
     void remove(FParticle* particle, FParticleForceGenerator* particleForceGenerator);
     
+    /**
+     * Unregisters every pair of the given particles, in a single pass over the pairs.
+     * No particle, or force, will be deleted, only the relations between them will be deleted.
+     *
+     * @param particles The particles. Different views of the same particle are treated as the same particle.
+     */
+    void removeAll(std::span<const FParticle> particles);
+    
+    /**
+     * Checks whether a handle refers to a pair that is still registered.
+     */
+    bool contains(FParticleForcePairHandle handle) const;
+    
+    /** Returns the number of registered pairs. */
+    size_t size() const;
+    
     /**
      * Deletes all particle-force pairs at once.
      * No particle, or force, will be deleted, only the relation between them will be deleted.
@@ -54,20 +126,151 @@ public:
      */
     void updateForces(FReal deltaTime);
     
+    /**
+     * Requests all force generators to update the forces acting on their respective particles, spreading the particles across jobs.
+     * The pairs of a particle are all handled by the same thread, in the same order as by updateForces(deltaTime), so the results are the same.
+     * Generators must only write to the particle they are asked about, and must not have mutable state shared between particles.
+     *
+     * @param deltaTime The integration time.
+     * @param jobSystem The job system to run on.
+     */
+    void updateForces(FReal deltaTime, Core::FJobSystem& jobSystem);
+    
+    /**
+     * Sets how the force generators are called. See EParticleForceDispatch.
+     * Changing it moves the pairs over, and the next update groups them all again.
+     *
+     * @param dispatch The new way, Virtual by default.
+     */
+    void setDispatch(EParticleForceDispatch dispatch);
+    
+    /** Returns how the force generators are called. */
+    EParticleForceDispatch getDispatch() const;
+    
+private:
+    /**
+     * Updates the forces of some particle groups of a bucket.
+     *
+     * @param type The type of the bucket.
+     * @param beginGroup The first group.
+     * @param endGroup One past the last group.
+     * @param deltaTime The integration time.
+     */
+    void updateForces(EParticleForceGeneratorType type, size_t beginGroup, size_t endGroup, FReal deltaTime);
+    
+    /** Returns the number of particle groups of the bucket of the given type. */
+    size_t getNumberOfGroups(EParticleForceGeneratorType type) const;
+    
 private:
     /**
      * Keeps track of the force generator and the particle it applies to.
      */
     struct FParticleForcePair
     {
+        /** The particle, or nullptr once the pair has been removed. */
         FParticle* Particle;
         FParticleForceGenerator* ParticleForceGenerator;
+        
+        /** The store of the particle, cached with its slot (see FParticleHandle) to group the pairs without reading the particles. */
+        const FParticleStore* ParticleStore;
+        uint32_t ParticleSlotIndex;
+        
+        /** The slot that refers to the pair in the indirection table. */
+        uint32_t SlotIndex;
+    };
+    
+    /**
+     * An entry of the indirection table. While the pair is registered, Index is its position inside its grouped pairs, otherwise it is the next free slot.
+     */
+    struct FSlot
+    {
+        uint32_t Index;
+        uint32_t Generation;
+        
+        /** The type of the pair's generator, i.e. its bucket. */
+        EParticleForceGeneratorType Type;
     };
     
     /**
-     * Stores the particle-force pairs.
+     * Pairs grouped by particle, the groups sorted by store and particle slot, so the pairs of a particle are contiguous and can all be handed
+     * to one thread. Added pairs are appended after the grouped ones and removed ones are only marked dead, so both take constant time,
+     * then mergeChanges() fixes the groups up before the next update.
+     */
+    struct FGroupedPairs
+    {
+        /** Stores the grouped pairs, then the pairs added since the last merge, in the order they were added. Both may contain dead pairs. */
+        std::vector<FParticleForcePair> Pairs;
+        
+        /** Stores the number of grouped pairs, at the beginning of Pairs. */
+        size_t NumberOfGroupedPairs = 0;
+        
+        /** Stores the number of pairs that have not been removed. */
+        size_t NumberOfLivePairs = 0;
+        
+        /** Stores where the pairs of each particle begin in Pairs, plus one past the last pair. Only valid right after a merge. */
+        std::vector<uint32_t> GroupBegins = {0};
+    };
+    
+    /**
+     * Gets the grouped pairs of the current dispatch holding the pairs of the given type: AllPairs, or the bucket of the type.
+     */
+    FGroupedPairs& getGroupedPairs(EParticleForceGeneratorType type);
+    
+    /**
+     * Gets all the grouped pairs of the current dispatch: AllPairs, or every bucket.
+     */
+    std::span<FGroupedPairs> getGroupedPairs();
+    
+    /**
+     * Marks the pair at the given position as removed, and frees its slot.
      */
-    std::vector<FParticleForcePair> ParticleForcePairs;
+    void removeAt(FGroupedPairs& groupedPairs, size_t pairIndex);
+    
+    /**
+     * Merges the pairs added since the last merge into the groups, and drops the dead pairs, if there were any changes.
+     * It stable sorts the added pairs, then merges them after the grouped pairs of their particles in one pass, instead of sorting all the pairs again.
+     */
+    void mergeChanges(FGroupedPairs& groupedPairs);
+    
+    /**
+     * Merges the changes of the grouped pairs that are mostly dead, so removing pairs without updating the forces does not keep growing them.
+     */
+    void mergeMostlyDeadPairs();
+    
+    /**
+     * Identifies a particle, whichever view of it is used.
+     */
+    struct FParticleKey
+    {
+        const FParticleStore* Store;
+        FParticleHandle Handle;
+        
+        bool operator==(const FParticleKey&) const = default;
+    };
+    
+    struct FParticleKeyHash
+    {
+        size_t operator()(const FParticleKey& key) const;
+    };
+    
+private:
+    /** Stores the particle-force pairs, with the Virtual dispatch. */
+    FGroupedPairs AllPairs;
+    
+    /** Stores the indirection table, indexed by FParticleForcePairHandle::Index. */
+    std::vector<FSlot> Slots;
+    
+    /** Stores the first free slot of the indirection table. */
+    uint32_t FirstFreeSlot = FParticleForcePairHandle::InvalidIndex;
+    
+    /** The number of types of generators, thus of buckets. */
+    static constexpr size_t NumberOfBuckets = static_cast<size_t>(EParticleForceGeneratorType::Buoyancy) + 1;
+    
+    /** Stores the particle-force pairs bucketed by the type of their generator, with the Bucketed dispatch. Indexed by EParticleForceGeneratorType. */
+    std::array<FGroupedPairs, NumberOfBuckets> Buckets;
+    
+    /** Stores how the force generators are called. */
+    EParticleForceDispatch Dispatch = EParticleForceDispatch::Virtual;
 };
 
 }   // End of namespace Physics
@@ -0,0 +1,220 @@
+//
+//  ParticleIntegrators.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "ParticleIntegrators.hpp"
+
+// GE includes.
+#include "ParticleBatchIntegrator.hpp"
+
+// STD library includes.
+#include <cassert>
+
+namespace GE
+{
+namespace Physics
+{
+
+namespace
+{
+
+/**
+ * Calls kernel(index, acceleration, dampingPower) for each movable particle in the range [begin, end).
+ * The acceleration sums the same terms, in the same order, as FParticleBatchIntegrator.
+ */
+template<typename TKernel>
+FORCE_INLINE void forEachMovableParticle(const FParticleIntegrationContext& context, size_t begin, size_t end, const TKernel& kernel)
+{
+    const FParticleStore& store = *context.ParticleStore;
+    const std::span<const FParticleVector3> accelerations = store.getAccelerations();
+    const std::span<const FParticleVector3> accumulatedForces = store.getAccumulatedForces();
+    const std::span<const FReal> inverseMasses = store.getInverseMasses();
+    const std::span<const FReal> dampings = store.getDampings();
+    FParticleDampingPowerCache dampingPowerCache{context.DeltaTime};
+    
+    for (size_t index = begin; index < end; ++index)
+    {
+        const FReal inverseMass = inverseMasses[index];
+    
+        // Check whether the particle is immovable or not.
+        if (inverseMass <= Math::Zero)
+        {
+            continue;
+        }
+    
+        FVector3 acceleration = accelerations[index] + context.UniformAcceleration;
+        acceleration.addScaledVector(inverseMass, accumulatedForces[index]);
+        kernel(index, acceleration, dampingPowerCache.get(dampings[index]));
+    }
+}
+
+/** Runs one of the stages of a Runge-Kutta step, the stage being a template parameter so that the kernel is branch free. */
+template<unsigned Stage>
+void integrateRungeKutta4Stage(const FParticleIntegrationContext& context, size_t begin, size_t end)
+{
+    // Each stage adds its slopes to the increments with weights 1, 2, 2, 1, then moves the particle to where the next slopes are evaluated:
+    // half a step along the current slopes for the second and third stages, a full step for the fourth, and along the weighted mean at the end.
+    const std::span<FParticlePositionVector3> positions = context.ParticleStore->getPositions();
+    const std::span<FParticleVector3> velocities = context.ParticleStore->getVelocities();
+    const FReal deltaTime = context.DeltaTime;
+    
+    forEachMovableParticle(context, begin, end, [&](size_t index, const FVector3& acceleration, FReal dampingPower)
+    {
+        FParticlePositionVector3& position = positions[index];
+        FParticleVector3& velocity = velocities[index];
+    
+        if constexpr (Stage == 0)
+        {
+            context.StartPositions[index] = position;
+            context.StartVelocities[index] = velocity;
+            context.PositionIncrements[index] = velocity;
+            context.VelocityIncrements[index] = acceleration;
+        }
+        else
+        {
+            constexpr FReal weight = (Stage == 3)? Math::One : (FReal) 2.0;
+            context.PositionIncrements[index].addScaledVector(weight, velocity);
+            context.VelocityIncrements[index].addScaledVector(weight, acceleration);
+        }
+    
+        if constexpr (Stage < 3)
+        {
+            const FReal stageTime = (Stage == 2)? deltaTime : deltaTime * (FReal) 0.5;
+            position = context.StartPositions[index] + velocity * stageTime;
+            velocity = context.StartVelocities[index] + acceleration * stageTime;
+        }
+        else
+        {
+            const FReal meanTime = deltaTime / (FReal) 6.0;
+            position = context.StartPositions[index] + context.PositionIncrements[index] * meanTime;
+            velocity = context.StartVelocities[index] + context.VelocityIncrements[index] * meanTime;
+    
+            // Apply drag.
+            velocity *= dampingPower;
+        }
+    });
+}
+
+}   // End of anonymous namespace
+
+void FParticleExplicitEulerIntegrator::beginStep(const FParticleIntegrationContext&, size_t, size_t)
+{
+    // Nothing to do.
+}
+
+void FParticleExplicitEulerIntegrator::integrateStage(const FParticleIntegrationContext& context, unsigned stage, size_t begin, size_t end)
+{
+    assert(stage == 0);
+    FParticleBatchIntegrator::integrate(*context.ParticleStore, begin, end, context.DeltaTime, context.UniformAcceleration);
+}
+
+void FParticleSemiImplicitEulerIntegrator::beginStep(const FParticleIntegrationContext&, size_t, size_t)
+{
+    // Nothing to do.
+}
+
+void FParticleSemiImplicitEulerIntegrator::integrateStage(const FParticleIntegrationContext& context, unsigned stage, size_t begin, size_t end)
+{
+    assert(stage == 0);
+    const std::span<FParticlePositionVector3> positions = context.ParticleStore->getPositions();
+    const std::span<FParticleVector3> velocities = context.ParticleStore->getVelocities();
+    const FReal deltaTime = context.DeltaTime;
+    
+    forEachMovableParticle(context, begin, end, [&](size_t index, const FVector3& acceleration, FReal dampingPower)
+    {
+        FParticleVector3& velocity = velocities[index];
+        velocity.addScaledVector(deltaTime, acceleration);
+        velocity *= dampingPower;
+        positions[index].addScaledVector(deltaTime, velocity);
+    });
+}
+
+void FParticlePositionVerletIntegrator::beginStep(const FParticleIntegrationContext& context, size_t begin, size_t end)
+{
+    const std::span<FParticlePositionVector3> positions = context.ParticleStore->getPositions();
+    const std::span<const FParticleVector3> velocities = context.ParticleStore->getVelocities();
+    const std::span<const FReal> inverseMasses = context.ParticleStore->getInverseMasses();
+    const FReal halfDeltaTime = context.DeltaTime * (FReal) 0.5;
+    
+    for (size_t index = begin; index < end; ++index)
+    {
+        if (inverseMasses[index] > Math::Zero)
+        {
+            positions[index].addScaledVector(halfDeltaTime, velocities[index]);
+        }
+    }
+}
+
+void FParticlePositionVerletIntegrator::integrateStage(const FParticleIntegrationContext& context, unsigned stage, size_t begin, size_t end)
+{
+    assert(stage == 0);
+    const std::span<FParticlePositionVector3> positions = context.ParticleStore->getPositions();
+    const std::span<FParticleVector3> velocities = context.ParticleStore->getVelocities();
+    const FReal deltaTime = context.DeltaTime;
+    const FReal halfDeltaTime = deltaTime * (FReal) 0.5;
+    
+    forEachMovableParticle(context, begin, end, [&](size_t index, const FVector3& acceleration, FReal dampingPower)
+    {
+        FParticleVector3& velocity = velocities[index];
+        velocity.addScaledVector(deltaTime, acceleration);
+        velocity *= dampingPower;
+        positions[index].addScaledVector(halfDeltaTime, velocity);
+    });
+}
+
+void FParticleVelocityVerletIntegrator::beginStep(const FParticleIntegrationContext&, size_t, size_t)
+{
+    // Nothing to do.
+}
+
+void FParticleVelocityVerletIntegrator::integrateStage(const FParticleIntegrationContext& context, unsigned stage, size_t begin, size_t end)
+{
+    const std::span<FParticlePositionVector3> positions = context.ParticleStore->getPositions();
+    const std::span<FParticleVector3> velocities = context.ParticleStore->getVelocities();
+    const FReal deltaTime = context.DeltaTime;
+    const FReal halfDeltaTime = deltaTime * (FReal) 0.5;
+    
+    if (stage == 0)
+    {
+        forEachMovableParticle(context, begin, end, [&](size_t index, const FVector3& acceleration, FReal)
+        {
+            FParticleVector3& velocity = velocities[index];
+            velocity.addScaledVector(halfDeltaTime, acceleration);
+            positions[index].addScaledVector(deltaTime, velocity);
+        });
+    }
+    else
+    {
+        assert(stage == 1);
+        forEachMovableParticle(context, begin, end, [&](size_t index, const FVector3& acceleration, FReal dampingPower)
+        {
+            FParticleVector3& velocity = velocities[index];
+            velocity.addScaledVector(halfDeltaTime, acceleration);
+            velocity *= dampingPower;
+        });
+    }
+}
+
+void FParticleRungeKutta4Integrator::beginStep(const FParticleIntegrationContext&, size_t, size_t)
+{
+    // Nothing to do: the first stage saves the state at the beginning of the step.
+}
+
+void FParticleRungeKutta4Integrator::integrateStage(const FParticleIntegrationContext& context, unsigned stage, size_t begin, size_t end)
+{
+    assert(context.StartPositions.size() == context.ParticleStore->size());
+    
+    switch (stage)
+    {
+        case 0: integrateRungeKutta4Stage<0>(context, begin, end); break;
+        case 1: integrateRungeKutta4Stage<1>(context, begin, end); break;
+        case 2: integrateRungeKutta4Stage<2>(context, begin, end); break;
+        default: assert(stage == 3); integrateRungeKutta4Stage<3>(context, begin, end); break;
+    }
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
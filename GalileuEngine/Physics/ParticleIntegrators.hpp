@@ -0,0 +1,161 @@
+//
+//  ParticleIntegrators.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Math.hpp"
+#include "ParticleStore.hpp"
+#include "UtilMacros.hpp"
+#include "Vector3.hpp"
+
+// STD library includes.
+#include <concepts>
+#include <cstddef>
+#include <span>
+
+namespace GE
+{
+namespace Physics
+{
+using Math::FReal;
+using Math::FVector3;
+using Math::FPositionVector3;
+
+/**
+ * Everything an integrator policy needs to advance a range of particles through one stage of a step.
+ * The accelerations are read from the store: its Accelerations, plus UniformAcceleration, plus its AccumulatedForces times the inverse masses.
+ */
+struct FParticleIntegrationContext
+{
+    /** The particles to integrate. */
+    FParticleStore* ParticleStore;
+    
+    /** The integration time of the whole step. */
+    FReal DeltaTime;
+    
+    /** The acceleration added to every movable particle's. */
+    FVector3 UniformAcceleration;
+    
+    /** Per-particle scratch arrays for the integrators whose IsScratchNeeded is true, sized like the store. They must be kept from one stage to the next. */
+    std::span<FPositionVector3> StartPositions;
+    std::span<FVector3> StartVelocities;
+    std::span<FVector3> PositionIncrements;
+    std::span<FVector3> VelocityIncrements;
+};
+
+/**
+ * A policy advancing particles in time, used as a template parameter, e.g. by FParticleWorld::runPhysics().
+ * A step is made of NumberOfStages stages: beginStep() runs first, then each stage is preceded by an evaluation of the forces at the particles' current state.
+ * Both functions are called on ranges of particles, possibly concurrently on disjoint ranges; they take the stage as an argument and dispatch on it once per range, never per particle.
+ */
+template<typename T>
+concept ParticleIntegrator = requires(const FParticleIntegrationContext& context, unsigned stage, size_t begin, size_t end)
+{
+    { T::NumberOfStages } -> std::convertible_to<unsigned>;
+    { T::IsScratchNeeded } -> std::convertible_to<bool>;
+    T::beginStep(context, begin, end);
+    T::integrateStage(context, stage, begin, end);
+};
+
+/**
+ * The method of FParticleStore::integrate(), and the default one: the position moves with the velocity at the beginning of the step, then the velocity is updated.
+ * It is first order and gains energy, so undamped oscillations grow, but it is the cheapest: it runs on FParticleBatchIntegrator.
+ */
+struct FParticleExplicitEulerIntegrator
+{
+    static constexpr unsigned NumberOfStages = 1;
+    static constexpr bool IsScratchNeeded = false;
+    
+    static void beginStep(const FParticleIntegrationContext& context, size_t begin, size_t end);
+    static void integrateStage(const FParticleIntegrationContext& context, unsigned stage, size_t begin, size_t end);
+};
+
+/**
+ * Semi-implicit (symplectic) Euler: the velocity is updated first, then the position moves with the new velocity.
+ * It is first order, as cheap as explicit Euler, but symplectic: the energy of oscillations stays bounded.
+ */
+struct FParticleSemiImplicitEulerIntegrator
+{
+    static constexpr unsigned NumberOfStages = 1;
+    static constexpr bool IsScratchNeeded = false;
+    
+    static void beginStep(const FParticleIntegrationContext& context, size_t begin, size_t end);
+    static void integrateStage(const FParticleIntegrationContext& context, unsigned stage, size_t begin, size_t end);
+};
+
+/**
+ * Position Verlet, i.e. drift-kick-drift leapfrog: the position moves half a step, the forces are evaluated there and kick the velocity, then the position moves the other half.
+ * It is second order and symplectic, with a single force evaluation per step.
+ */
+struct FParticlePositionVerletIntegrator
+{
+    static constexpr unsigned NumberOfStages = 1;
+    static constexpr bool IsScratchNeeded = false;
+    
+    static void beginStep(const FParticleIntegrationContext& context, size_t begin, size_t end);
+    static void integrateStage(const FParticleIntegrationContext& context, unsigned stage, size_t begin, size_t end);
+};
+
+/**
+ * Velocity Verlet, i.e. kick-drift-kick leapfrog: the velocity gets half a kick from the forces at the beginning of the step, the position moves,
+ * then the velocity gets the other half from the forces at the end of the step. It is second order and symplectic, with two force evaluations per step.
+ */
+struct FParticleVelocityVerletIntegrator
+{
+    static constexpr unsigned NumberOfStages = 2;
+    static constexpr bool IsScratchNeeded = false;
+    
+    static void beginStep(const FParticleIntegrationContext& context, size_t begin, size_t end);
+    static void integrateStage(const FParticleIntegrationContext& context, unsigned stage, size_t begin, size_t end);
+};
+
+/**
+ * The classic fourth order Runge-Kutta method, with four force evaluations per step.
+ * It is the most accurate for smooth forces, but not symplectic: undamped oscillations slowly lose energy.
+ */
+struct FParticleRungeKutta4Integrator
+{
+    static constexpr unsigned NumberOfStages = 4;
+    static constexpr bool IsScratchNeeded = true;
+    
+    static void beginStep(const FParticleIntegrationContext& context, size_t begin, size_t end);
+    static void integrateStage(const FParticleIntegrationContext& context, unsigned stage, size_t begin, size_t end);
+};
+
+/**
+ * Remembers the last pow(damping, deltaTime) computed, since most particles share the same damping.
+ */
+class FParticleDampingPowerCache
+{
+public:
+    explicit FParticleDampingPowerCache(FReal deltaTime)
+        : DeltaTime{deltaTime}, LastDamping{Math::One}, LastPower{Math::One}
+    {
+    }
+    
+    FORCE_INLINE FReal get(FReal damping)
+    {
+        if (damping != LastDamping)
+        {
+            LastDamping = damping;
+            LastPower = Math::pow(damping, DeltaTime);
+        }
+        return LastPower;
+    }
+    
+    FORCE_INLINE FReal getLastDamping() const { return LastDamping; }
+    FORCE_INLINE FReal getLastPower() const { return LastPower; }
+    
+private:
+    const FReal DeltaTime;
+    FReal LastDamping;
+    FReal LastPower;
+};
+
+}   // End of namespace Physics
+}   // End of namespace GE
@@ -0,0 +1,674 @@
+//
+//  ParticleSpringNetwork.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "ParticleSpringNetwork.hpp"
+
+// GE includes.
+#include "SimdReal.hpp"
+#include "UtilMacros.hpp"
+#include "Vector3.hpp"
+#include "Vector3xN.hpp"
+
+// STD library includes.
+#include <algorithm>
+#include <bit>
+#include <iostream>
+#include <span>
+
+namespace GE
+{
+namespace Physics
+{
+using Math::FMaskN;
+using Math::FRealN;
+using Math::FVector3xN;
+
+size_t FParticleSpringNetwork::add(const FParticle& particleA, const FParticle& particleB, FReal springConstant, FReal restLength)
+{
+    CHECK(particleA.getStore() == particleB.getStore())
+    CHECK((ParticleStore == nullptr) || (ParticleStore == particleA.getStore()))
+    
+    ParticleStore = particleA.getStore();
+    HandlesA.push_back(particleA.getHandle());
+    HandlesB.push_back(particleB.getHandle());
+    SpringConstants.push_back(springConstant);
+    RestLengths.push_back(restLength);
+    IsColoringValid = false;
+    
+    return HandlesA.size() - 1;
+}
+
+void FParticleSpringNetwork::clear()
+{
+    ParticleStore = nullptr;
+    HandlesA.clear();
+    HandlesB.clear();
+    SpringConstants.clear();
+    RestLengths.clear();
+    IsColoringValid = false;
+}
+
+size_t FParticleSpringNetwork::size() const
+{
+    return HandlesA.size();
+}
+
+void FParticleSpringNetwork::updateForces(FReal deltaTime)
+{
+    updateForces(deltaTime, nullptr);
+}
+
+void FParticleSpringNetwork::updateForces(FReal deltaTime, Core::FJobSystem& jobSystem)
+{
+    updateForces(deltaTime, &jobSystem);
+}
+
+void FParticleSpringNetwork::setIntegration(EParticleSpringIntegration integration)
+{
+    Integration = integration;
+}
+
+EParticleSpringIntegration FParticleSpringNetwork::getIntegration() const
+{
+    return Integration;
+}
+
+void FParticleSpringNetwork::setNormalization(ENormalization normalization)
+{
+    Normalization = normalization;
+}
+
+ENormalization FParticleSpringNetwork::getNormalization() const
+{
+    return Normalization;
+}
+
+void FParticleSpringNetwork::setMaxNumberOfIterations(unsigned maxNumberOfIterations)
+{
+    MaxNumberOfIterations = maxNumberOfIterations;
+}
+
+void FParticleSpringNetwork::setTolerance(FReal tolerance)
+{
+    Tolerance = tolerance;
+}
+
+unsigned FParticleSpringNetwork::getNumberOfIterations() const
+{
+    return NumberOfIterations;
+}
+
+bool FParticleSpringNetwork::hasConverged() const
+{
+    return HasConverged;
+}
+
+void FParticleSpringNetwork::setUniformAcceleration(const FVector3& acceleration)
+{
+    UniformAcceleration = acceleration;
+}
+
+void FParticleSpringNetwork::updateForces(FReal deltaTime, Core::FJobSystem* jobSystem)
+{
+    // Without springs there is no store to read from, see clear().
+    if ((size() == 0) || (ParticleStore == nullptr))
+    {
+        return;
+    }
+    
+    prepareUpdate();
+    
+    const bool isImplicit = (Integration == EParticleSpringIntegration::Implicit);
+    const bool isFast = (Normalization == ENormalization::Fast);
+    const auto computeRange = [this, isImplicit, isFast](size_t begin, size_t end)
+    {
+        if (isImplicit && isFast)
+        {
+            computeSpringForces<true, ENormalization::Fast>(begin, end);
+        }
+        else if (isImplicit)
+        {
+            computeSpringForces<true, ENormalization::Exact>(begin, end);
+        }
+        else if (isFast)
+        {
+            computeSpringForces<false, ENormalization::Fast>(begin, end);
+        }
+        else
+        {
+            computeSpringForces<false, ENormalization::Exact>(begin, end);
+        }
+    };
+    if (jobSystem)
+    {
+        jobSystem->parallelFor(size(), ChunkSize, computeRange);
+    }
+    else
+    {
+        computeRange(0, size());
+    }
+    
+    if (isImplicit)
+    {
+        solveImplicitly(deltaTime, jobSystem);
+        return;
+    }
+    
+    // The springs of a color share no particle, so they can be applied at the same time.
+    for (unsigned color = 0; color <= MaxNumberOfColors; ++color)
+    {
+        const size_t colorBegin = ColorBegins[color];
+        const size_t colorEnd = ColorBegins[color + 1];
+        if (!jobSystem || (color == MaxNumberOfColors))
+        {
+            applySpringForces(colorBegin, colorEnd);
+        }
+        else if (colorEnd > colorBegin)
+        {
+            jobSystem->parallelFor(colorEnd - colorBegin, ChunkSize, [this, colorBegin](size_t begin, size_t end)
+            {
+                applySpringForces(colorBegin + begin, colorBegin + end);
+            });
+        }
+    }
+}
+
+size_t FParticleSpringNetwork::getNumberOfColors() const
+{
+    size_t numberOfColors = 0;
+    for (size_t color = 0; color + 1 < ColorBegins.size(); ++color)
+    {
+        numberOfColors += (ColorBegins[color + 1] > ColorBegins[color]) ? 1 : 0;
+    }
+    return numberOfColors;
+}
+
+void FParticleSpringNetwork::prepareUpdate()
+{
+    if (!IsColoringValid)
+    {
+        colorSprings();
+        indexParticles();
+    }
+    
+    ForcesX.resize(size());
+    ForcesY.resize(size());
+    ForcesZ.resize(size());
+    if (Integration == EParticleSpringIntegration::Implicit)
+    {
+        Directions.resize(size());
+        StiffnessCoefficients.resize(size());
+    }
+}
+
+void FParticleSpringNetwork::colorSprings()
+{
+    const uint32_t numberOfSprings = static_cast<uint32_t>(size());
+    
+    // Greedy coloring: each spring takes the lowest color neither of its particles has yet, or the extra sequential color.
+    std::vector<uint8_t> springColors(numberOfSprings);
+    std::vector<uint64_t> particleColorMasks(ParticleStore ? ParticleStore->getNumberOfSlots() : 0, 0);
+    ColorBegins.assign(MaxNumberOfColors + 2, 0);
+    for (uint32_t springIndex = 0; springIndex < numberOfSprings; ++springIndex)
+    {
+        uint64_t& colorMaskA = particleColorMasks[HandlesA[springIndex].Index];
+        uint64_t& colorMaskB = particleColorMasks[HandlesB[springIndex].Index];
+        const uint64_t usedColors = colorMaskA | colorMaskB;
+        const unsigned color = (usedColors == ~uint64_t{0}) ? MaxNumberOfColors : static_cast<unsigned>(std::countr_one(usedColors));
+        if (color < MaxNumberOfColors)
+        {
+            colorMaskA |= uint64_t{1} << color;
+            colorMaskB |= uint64_t{1} << color;
+        }
+        springColors[springIndex] = static_cast<uint8_t>(color);
+        ++ColorBegins[color + 1];
+    }
+    
+    // Counting sort by color, keeping the springs' order within each color.
+    for (unsigned color = 0; color <= MaxNumberOfColors; ++color)
+    {
+        ColorBegins[color + 1] += ColorBegins[color];
+    }
+    std::vector<size_t> nextPositions(ColorBegins.begin(), ColorBegins.end() - 1);
+    ColoredSprings.resize(numberOfSprings);
+    for (uint32_t springIndex = 0; springIndex < numberOfSprings; ++springIndex)
+    {
+        ColoredSprings[nextPositions[springColors[springIndex]]++] = springIndex;
+    }
+    
+    IsColoringValid = true;
+}
+
+void FParticleSpringNetwork::indexParticles()
+{
+    constexpr uint32_t NoLocalIndex = UINT32_MAX;
+    std::vector<uint32_t> localIndices(ParticleStore ? ParticleStore->getNumberOfSlots() : 0, NoLocalIndex);
+    const auto getLocalIndex = [&](FParticleHandle handle)
+    {
+        uint32_t& localIndex = localIndices[handle.Index];
+        if (localIndex == NoLocalIndex)
+        {
+            localIndex = static_cast<uint32_t>(Particles.size());
+            Particles.push_back(handle);
+        }
+        return localIndex;
+    };
+    
+    Particles.clear();
+    LocalIndicesA.resize(size());
+    LocalIndicesB.resize(size());
+    for (size_t springIndex = 0; springIndex < size(); ++springIndex)
+    {
+        LocalIndicesA[springIndex] = getLocalIndex(HandlesA[springIndex]);
+        LocalIndicesB[springIndex] = getLocalIndex(HandlesB[springIndex]);
+    }
+    
+    // The previous solution of the implicit integration no longer matches the particles.
+    VelocityChanges.clear();
+}
+
+template<bool IsJacobianNeeded, ENormalization Accuracy>
+void FParticleSpringNetwork::computeSpringForces(size_t begin, size_t end)
+{
+    const std::span<const FParticlePositionVector3> positions = ParticleStore->getPositions();
+    FReal* const forcesX = ForcesX.data();
+    FReal* const forcesY = ForcesY.data();
+    FReal* const forcesZ = ForcesZ.data();
+    const FReal* const springConstants = SpringConstants.data();
+    const FReal* const restLengths = RestLengths.data();
+    
+    for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += ChunkSize)
+    {
+        const size_t chunkEnd = std::min(chunkBegin + ChunkSize, end);
+        
+        // Gather the deltas between the ends of each spring.
+        for (size_t springIndex = chunkBegin; springIndex < chunkEnd; ++springIndex)
+        {
+            const FParticlePositionVector3& positionA = positions[ParticleStore->getIndex(HandlesA[springIndex])];
+            const FParticlePositionVector3& positionB = positions[ParticleStore->getIndex(HandlesB[springIndex])];
+            forcesX[springIndex] = static_cast<FReal>(positionA.X - positionB.X);
+            forcesY[springIndex] = static_cast<FReal>(positionA.Y - positionB.Y);
+            forcesZ[springIndex] = static_cast<FReal>(positionA.Z - positionB.Z);
+        }
+        
+        // Hooke's law, a packet of springs at a time. The last packet of a chunk may be partial, yet it goes through the same arithmetic,
+        // so each spring's force does not depend on where the ranges begin. Springs of zero length have no direction, thus no force.
+        for (size_t springIndex = chunkBegin; springIndex < chunkEnd; springIndex += FVector3xN::NumberOfLanes)
+        {
+            const size_t count = std::min(FVector3xN::NumberOfLanes, chunkEnd - springIndex);
+            const bool isPartial = (count < FVector3xN::NumberOfLanes);
+            const FVector3xN delta = isPartial ? FVector3xN::loadPartial(forcesX + springIndex, forcesY + springIndex, forcesZ + springIndex, count)
+                                               : FVector3xN::load(forcesX + springIndex, forcesY + springIndex, forcesZ + springIndex);
+            const FRealN springConstant = isPartial ? FRealN::loadPartial(springConstants + springIndex, count) : FRealN::load(springConstants + springIndex);
+            const FRealN restLength = isPartial ? FRealN::loadPartial(restLengths + springIndex, count) : FRealN::load(restLengths + springIndex);
+            
+            // Zero lengths are replaced by one, so that no lane divides by zero.
+            const FRealN squareLength = delta.squareMagnitude();
+            const FMaskN hasLength = squareLength > Math::Zero;
+            const FRealN safeSquareLength = FRealN::select(hasLength, squareLength, Math::One);
+            FRealN safeLength;
+            FRealN safeInverseLength;
+            FRealN scale;
+            if constexpr (Accuracy == ENormalization::Fast)
+            {
+                safeInverseLength = Math::fastInverseSqrt(safeSquareLength);
+                safeLength = safeSquareLength * safeInverseLength;
+                scale = FRealN::select(hasLength, springConstant * (restLength - safeLength) * safeInverseLength, Math::Zero);
+            }
+            else
+            {
+                safeLength = Math::sqrt(safeSquareLength);
+                safeInverseLength = Math::One / safeLength;
+                scale = FRealN::select(hasLength, springConstant * (restLength - safeLength) / safeLength, Math::Zero);
+            }
+            const FVector3xN force = delta * scale;
+            if (isPartial)
+            {
+                force.storePartial(forcesX + springIndex, forcesY + springIndex, forcesZ + springIndex, count);
+            }
+            else
+            {
+                force.store(forcesX + springIndex, forcesY + springIndex, forcesZ + springIndex);
+            }
+            
+            if constexpr (IsJacobianNeeded)
+            {
+                // Stretched springs are stiff across their direction too, in proportion to their stretch; compressed ones are not, so the system stays definite.
+                const FRealN inverseLength = FRealN::select(hasLength, safeInverseLength, Math::Zero);
+                const FRealN transverseStiffness = springConstant * Math::max(Math::Zero, Math::One - restLength * inverseLength);
+                (delta * inverseLength).scatterPartial(&Directions[springIndex], count);
+                
+                FReal transverseStiffnesses[FRealN::NumberOfLanes];
+                FReal axialStiffnesses[FRealN::NumberOfLanes];
+                transverseStiffness.store(transverseStiffnesses);
+                (springConstant - transverseStiffness).store(axialStiffnesses);
+                for (size_t lane = 0; lane < count; ++lane)
+                {
+                    StiffnessCoefficients[springIndex + lane] = {transverseStiffnesses[lane], axialStiffnesses[lane]};
+                }
+            }
+        }
+    }
+}
+
+void FParticleSpringNetwork::applySpringForces(size_t begin, size_t end)
+{
+    const std::span<FParticleVector3> accumulatedForces = ParticleStore->getAccumulatedForces();
+    for (size_t position = begin; position < end; ++position)
+    {
+        const uint32_t springIndex = ColoredSprings[position];
+        const FVector3 force{ForcesX[springIndex], ForcesY[springIndex], ForcesZ[springIndex]};
+        accumulatedForces[ParticleStore->getIndex(HandlesA[springIndex])] += force;
+        accumulatedForces[ParticleStore->getIndex(HandlesB[springIndex])] -= force;
+    }
+}
+
+void FParticleSpringNetwork::solveImplicitly(FReal deltaTime, Core::FJobSystem* jobSystem)
+{
+    const size_t numberOfParticles = Particles.size();
+    const auto forEachParticle = [numberOfParticles, jobSystem](const Core::FJobSystem::FRangeTask& task)
+    {
+        if (jobSystem)
+        {
+            jobSystem->parallelFor(numberOfParticles, ParticleBlockSize, task);
+        }
+        else
+        {
+            task(0, numberOfParticles);
+        }
+    };
+    
+    // The conjugate gradient starts from the previous step's velocity changes, scaled to the new step, see indexParticles().
+    const bool isWarmStarted = (VelocityChanges.size() == numberOfParticles) && (PreviousDeltaTime > Math::Zero);
+    const FReal warmStartScale = isWarmStarted ? (deltaTime / PreviousDeltaTime) : Math::Zero;
+    PreviousDeltaTime = deltaTime;
+    VelocityChanges.resize(numberOfParticles, FVector3::ZeroVector);
+    Residuals.resize(numberOfParticles);
+    PreconditionedResiduals.resize(numberOfParticles);
+    SearchDirections.resize(numberOfParticles);
+    Products.resize(numberOfParticles);
+    Diagonals.resize(numberOfParticles);
+    OffDiagonals.resize(numberOfParticles);
+    Masses.resize(numberOfParticles);
+    ExternalForces.resize(numberOfParticles);
+    
+    const std::span<const FReal> inverseMasses = ParticleStore->getInverseMasses();
+    const std::span<const FParticleVector3> velocities = ParticleStore->getVelocities();
+    const std::span<const FParticleVector3> accelerations = ParticleStore->getAccelerations();
+    const std::span<FParticleVector3> accumulatedForces = ParticleStore->getAccumulatedForces();
+    const FReal squaredDeltaTime = deltaTime * deltaTime;
+    
+    // Right-hand side h (f + f_ext + h K v), gathering the velocities into SearchDirections first.
+    forEachParticle([&](size_t begin, size_t end)
+    {
+        for (size_t localIndex = begin; localIndex < end; ++localIndex)
+        {
+            const size_t index = ParticleStore->getIndex(Particles[localIndex]);
+            const FReal mass = (inverseMasses[index] > Math::Zero) ? (Math::One / inverseMasses[index]) : Math::Zero;
+            Masses[localIndex] = mass;
+            SearchDirections[localIndex] = velocities[index];
+            ExternalForces[localIndex] = (mass == Math::Zero) ? FVector3::ZeroVector
+                                                              : FVector3{accumulatedForces[index]} + (FVector3{accelerations[index]} + UniformAcceleration) * mass;
+        }
+    });
+    multiplyByNegativeStiffness(SearchDirections, Products, jobSystem);
+    scatterToParticles([this](size_t springIndex)
+    {
+        return FVector3{ForcesX[springIndex], ForcesY[springIndex], ForcesZ[springIndex]};
+    }, -Math::One, Residuals, jobSystem);
+    
+    // Diagonal blocks of M - h^2 K, for the preconditioner: their diagonals, then their XY, XZ and YZ entries.
+    scatterToParticles([this](size_t springIndex)
+    {
+        const FVector3& direction = Directions[springIndex];
+        const auto [transverseStiffness, axialStiffness] = StiffnessCoefficients[springIndex];
+        return FVector3{transverseStiffness + axialStiffness * direction.X * direction.X, transverseStiffness + axialStiffness * direction.Y * direction.Y,
+                        transverseStiffness + axialStiffness * direction.Z * direction.Z};
+    }, Math::One, Diagonals, jobSystem);
+    scatterToParticles([this](size_t springIndex)
+    {
+        const FVector3& direction = Directions[springIndex];
+        const FReal axialStiffness = StiffnessCoefficients[springIndex].second;
+        return FVector3{direction.X * direction.Y, direction.X * direction.Z, direction.Y * direction.Z} * axialStiffness;
+    }, Math::One, OffDiagonals, jobSystem);
+    
+    // Immovable particles keep their velocity: their rows are filtered out of the system.
+    forEachParticle([&](size_t begin, size_t end)
+    {
+        for (size_t localIndex = begin; localIndex < end; ++localIndex)
+        {
+            const FReal mass = Masses[localIndex];
+            if (mass == Math::Zero)
+            {
+                Residuals[localIndex] = FVector3::ZeroVector;
+                VelocityChanges[localIndex] = FVector3::ZeroVector;
+                Diagonals[localIndex] = FVector3{Math::One, Math::One, Math::One};
+                OffDiagonals[localIndex] = FVector3::ZeroVector;
+                continue;
+            }
+            
+            // Diagonals and OffDiagonals held the sum of the springs' stiffness blocks, and Residuals the spring forces.
+            Residuals[localIndex] = (Residuals[localIndex] + ExternalForces[localIndex] - Products[localIndex] * deltaTime) * deltaTime;
+            VelocityChanges[localIndex] *= warmStartScale;
+            
+            // The block is positive definite, so its inverse is its adjugate over its determinant.
+            const FVector3 diagonal = Diagonals[localIndex] * squaredDeltaTime + FVector3{mass, mass, mass};
+            const FVector3 offDiagonal = OffDiagonals[localIndex] * squaredDeltaTime;
+            const FVector3 adjugateDiagonal{diagonal.Y * diagonal.Z - offDiagonal.Z * offDiagonal.Z, diagonal.X * diagonal.Z - offDiagonal.Y * offDiagonal.Y,
+                                            diagonal.X * diagonal.Y - offDiagonal.X * offDiagonal.X};
+            const FVector3 adjugateOffDiagonal{offDiagonal.Y * offDiagonal.Z - offDiagonal.X * diagonal.Z, offDiagonal.X * offDiagonal.Z - offDiagonal.Y * diagonal.Y,
+                                               offDiagonal.X * offDiagonal.Y - offDiagonal.Z * diagonal.X};
+            const FReal inverseDeterminant = Math::One / (diagonal.X * adjugateDiagonal.X + offDiagonal.X * adjugateOffDiagonal.X + offDiagonal.Y * adjugateOffDiagonal.Y);
+            Diagonals[localIndex] = adjugateDiagonal * inverseDeterminant;
+            OffDiagonals[localIndex] = adjugateOffDiagonal * inverseDeterminant;
+        }
+    });
+    
+    const auto precondition = [&](size_t begin, size_t end)
+    {
+        for (size_t localIndex = begin; localIndex < end; ++localIndex)
+        {
+            const FVector3& residual = Residuals[localIndex];
+            const FVector3& diagonal = Diagonals[localIndex];
+            const FVector3& offDiagonal = OffDiagonals[localIndex];
+            PreconditionedResiduals[localIndex] = FVector3{diagonal.X * residual.X + offDiagonal.X * residual.Y + offDiagonal.Y * residual.Z,
+                                                           offDiagonal.X * residual.X + diagonal.Y * residual.Y + offDiagonal.Z * residual.Z,
+                                                           offDiagonal.Y * residual.X + offDiagonal.Z * residual.Y + diagonal.Z * residual.Z};
+        }
+    };
+    
+    // Computes Products = (M - h^2 K) vectors, filtered.
+    const auto multiplyBySystem = [&](std::span<const FVector3> vectors)
+    {
+        multiplyByNegativeStiffness(vectors, Products, jobSystem);
+        forEachParticle([&](size_t begin, size_t end)
+        {
+            for (size_t localIndex = begin; localIndex < end; ++localIndex)
+            {
+                const FReal mass = Masses[localIndex];
+                Products[localIndex] = (mass == Math::Zero) ? FVector3::ZeroVector : (vectors[localIndex] * mass + Products[localIndex] * squaredDeltaTime);
+            }
+        });
+    };
+    
+    // Preconditioned conjugate gradient. At rest the spring forces balance the external ones and the right-hand side vanishes,
+    // so the tolerance is relative to the external impulses when they are larger, whatever the starting point.
+    const FReal rightHandSideNorm = Math::sqrt(dotProduct(Residuals, Residuals, jobSystem));
+    const FReal toleratedResidualNorm = Tolerance * std::max(rightHandSideNorm, deltaTime * Math::sqrt(dotProduct(ExternalForces, ExternalForces, jobSystem)));
+    NumberOfIterations = 0;
+    HasConverged = true;
+    if (rightHandSideNorm == Math::Zero)
+    {
+        std::fill(VelocityChanges.begin(), VelocityChanges.end(), FVector3::ZeroVector);
+        return;
+    }
+    FReal residualNorm = rightHandSideNorm;
+    if (isWarmStarted)
+    {
+        // Starts from no velocity change instead if the previous solution is a worse guess.
+        SearchDirections = Residuals;
+        multiplyBySystem(VelocityChanges);
+        forEachParticle([&](size_t begin, size_t end)
+        {
+            for (size_t localIndex = begin; localIndex < end; ++localIndex)
+            {
+                Residuals[localIndex] -= Products[localIndex];
+            }
+        });
+        residualNorm = Math::sqrt(dotProduct(Residuals, Residuals, jobSystem));
+        if (residualNorm > rightHandSideNorm)
+        {
+            std::swap(Residuals, SearchDirections);
+            std::fill(VelocityChanges.begin(), VelocityChanges.end(), FVector3::ZeroVector);
+            residualNorm = rightHandSideNorm;
+        }
+    }
+    HasConverged = (residualNorm <= toleratedResidualNorm);
+    forEachParticle(precondition);
+    SearchDirections = PreconditionedResiduals;
+    FReal residualDotPreconditioned = dotProduct(Residuals, PreconditionedResiduals, jobSystem);
+    
+    while (!HasConverged && (NumberOfIterations < MaxNumberOfIterations))
+    {
+        ++NumberOfIterations;
+        multiplyBySystem(SearchDirections);
+        
+        const FReal curvature = dotProduct(SearchDirections, Products, jobSystem);
+        if (curvature <= Math::Zero)
+        {
+            break;
+        }
+        const FReal stepLength = residualDotPreconditioned / curvature;
+        forEachParticle([&](size_t begin, size_t end)
+        {
+            for (size_t localIndex = begin; localIndex < end; ++localIndex)
+            {
+                VelocityChanges[localIndex] += SearchDirections[localIndex] * stepLength;
+                Residuals[localIndex] -= Products[localIndex] * stepLength;
+            }
+        });
+        
+        HasConverged = (Math::sqrt(dotProduct(Residuals, Residuals, jobSystem)) <= toleratedResidualNorm);
+        if (HasConverged)
+        {
+            break;
+        }
+        
+        forEachParticle(precondition);
+        const FReal newResidualDotPreconditioned = dotProduct(Residuals, PreconditionedResiduals, jobSystem);
+        const FReal conjugationFactor = newResidualDotPreconditioned / residualDotPreconditioned;
+        residualDotPreconditioned = newResidualDotPreconditioned;
+        forEachParticle([&](size_t begin, size_t end)
+        {
+            for (size_t localIndex = begin; localIndex < end; ++localIndex)
+            {
+                SearchDirections[localIndex] = PreconditionedResiduals[localIndex] + SearchDirections[localIndex] * conjugationFactor;
+            }
+        });
+    }
+    
+#if GE_BUILD_DEBUG
+    if (!HasConverged)
+    {
+        std::cout << "The implicit springs have not converged in " << NumberOfIterations << " iterations." << std::endl;
+    }
+#endif
+    
+    // The forces that change the velocities by as much over the step, the external forces included: the integrator adds those.
+    const FReal inverseDeltaTime = Math::One / deltaTime;
+    forEachParticle([&](size_t begin, size_t end)
+    {
+        for (size_t localIndex = begin; localIndex < end; ++localIndex)
+        {
+            accumulatedForces[ParticleStore->getIndex(Particles[localIndex])] += VelocityChanges[localIndex] * (Masses[localIndex] * inverseDeltaTime) - ExternalForces[localIndex];
+        }
+    });
+}
+
+void FParticleSpringNetwork::multiplyByNegativeStiffness(std::span<const FVector3> vectors, std::span<FVector3> products, Core::FJobSystem* jobSystem) const
+{
+    scatterToParticles([this, vectors](size_t springIndex)
+    {
+        const FVector3 delta = vectors[LocalIndicesA[springIndex]] - vectors[LocalIndicesB[springIndex]];
+        const FVector3& direction = Directions[springIndex];
+        const auto [transverseStiffness, axialStiffness] = StiffnessCoefficients[springIndex];
+        return delta * transverseStiffness + direction * (axialStiffness * (direction | delta));
+    }, -Math::One, products, jobSystem);
+}
+
+template<typename TGetSpringVector>
+void FParticleSpringNetwork::scatterToParticles(const TGetSpringVector& getSpringVector, FReal particleBSign, std::span<FVector3> products, Core::FJobSystem* jobSystem) const
+{
+    std::fill(products.begin(), products.end(), FVector3::ZeroVector);
+    
+    const auto scatterRange = [&](size_t begin, size_t end)
+    {
+        for (size_t position = begin; position < end; ++position)
+        {
+            const uint32_t springIndex = ColoredSprings[position];
+            const FVector3 springVector = getSpringVector(springIndex);
+            products[LocalIndicesA[springIndex]] += springVector;
+            products[LocalIndicesB[springIndex]] += springVector * particleBSign;
+        }
+    };
+    
+    // The springs of a color share no particle, so they can be scattered at the same time.
+    for (unsigned color = 0; color <= MaxNumberOfColors; ++color)
+    {
+        const size_t colorBegin = ColorBegins[color];
+        const size_t colorEnd = ColorBegins[color + 1];
+        if (!jobSystem || (color == MaxNumberOfColors))
+        {
+            scatterRange(colorBegin, colorEnd);
+        }
+        else if (colorEnd > colorBegin)
+        {
+            jobSystem->parallelFor(colorEnd - colorBegin, ChunkSize, [&](size_t begin, size_t end)
+            {
+                scatterRange(colorBegin + begin, colorBegin + end);
+            });
+        }
+    }
+}
+
+FReal FParticleSpringNetwork::dotProduct(std::span<const FVector3> lhs, std::span<const FVector3> rhs, Core::FJobSystem* jobSystem) const
+{
+    const size_t numberOfBlocks = (lhs.size() + ParticleBlockSize - 1) / ParticleBlockSize;
+    PartialSums.resize(numberOfBlocks);
+    
+    const auto sumBlocks = [&](size_t beginBlock, size_t endBlock)
+    {
+        for (size_t block = beginBlock; block < endBlock; ++block)
+        {
+            const size_t end = std::min(lhs.size(), (block + 1) * ParticleBlockSize);
+            FReal partialSum = Math::Zero;
+            for (size_t index = block * ParticleBlockSize; index < end; ++index)
+            {
+                partialSum += lhs[index] | rhs[index];
+            }
+            PartialSums[block] = partialSum;
+        }
+    };
+    if (jobSystem)
+    {
+        jobSystem->parallelFor(numberOfBlocks, 1, sumBlocks);
+    }
+    else
+    {
+        sumBlocks(0, numberOfBlocks);
+    }
+    
+    FReal sum = Math::Zero;
+    for (const FReal partialSum : PartialSums)
+    {
+        sum += partialSum;
+    }
+    return sum;
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
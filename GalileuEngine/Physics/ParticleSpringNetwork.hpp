@@ -0,0 +1,330 @@
+//
+//  ParticleSpringNetwork.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "Math.hpp"
+#include "Particle.hpp"
+#include "ParticleStore.hpp"
+#include "JobSystem.hpp"
+#include "Vector3.hpp"
+
+// STD library includes.
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace GE
+{
+namespace Physics
+{
+using Math::ENormalization;
+using Math::FReal;
+using Math::FVector3;
+using Math::FPositionVector3;
+
+/**
+ * The ways FParticleSpringNetwork can integrate its springs.
+ */
+enum class EParticleSpringIntegration
+{
+    /** The spring forces are added as they are, so stiff springs need small time steps. */
+    Explicit,
+    
+    /**
+     * Backward Euler: the network solves for the velocity change that the spring forces at the end of the step would cause,
+     * and adds the forces producing it. This assumes the positions then move with the new velocities, so the world must integrate
+     * with FParticleSemiImplicitEulerIntegrator, which FParticleWorld::integrate() checks. Stiff springs then stay stable with large time steps, at the cost of some damping.
+     * The velocity change includes the external forces f_ext, those accumulated before the network's and the accelerations, see setUniformAcceleration(),
+     * so that the springs anticipate them: the network adds M dv / h - f_ext, and the particles come to rest where the forces balance.
+     * The linear system (M - h^2 K) dv = h (f + f_ext + h K v) is solved with a conjugate gradient preconditioned by the inverses of its 3x3 diagonal blocks,
+     * one per particle, and started from the previous step's solution. K is not assembled: its products are computed spring by spring.
+     * Compressed springs only contribute their axial stiffness, so the system stays positive definite.
+     */
+    Implicit
+};
+
+/**
+ * Stores many two-sided springs between particles of the same store, e.g. the edges of a cloth or soft body mesh, as a structure of arrays.
+ * Each spring pulls both of its particles with Hooke's law, computed once: the force is added to one particle and subtracted from the other.
+ *
+ * Forces are computed in two passes. The first one works on the springs alone, chunk by chunk, on FVector3xN packets. The second one
+ * adds the forces to the particles, color by color: the springs of a color share no particle, so each color can be spread across threads.
+ * Particles therefore receive their spring forces in the same order whatever the number of threads.
+ * See EParticleSpringIntegration for stiff springs.
+ */
+class FParticleSpringNetwork
+{
+public:
+    /**
+     * Adds a spring between two particles.
+     *
+     * @param particleA The particle at one end.
+     * @param particleB The particle at the other end. It must live in the same store as particleA, and as the other springs' particles.
+     * @param springConstant The spring constant used in the Hook's law.
+     * @param restLength The rest length of the spring.
+     * @return The index of the spring.
+     */
+    size_t add(const FParticle& particleA, const FParticle& particleB, FReal springConstant, FReal restLength);
+    
+    /** Removes every spring. */
+    void clear();
+    
+    /** Returns the number of springs. */
+    size_t size() const;
+    
+    /**
+     * Adds the force of every spring to its two particles' accumulated forces.
+     * All the particles must still be alive.
+     *
+     * @param deltaTime The integration time.
+     */
+    void updateForces(FReal deltaTime);
+    
+    /**
+     * Adds the force of every spring to its two particles' accumulated forces, spreading the springs across jobs.
+     * The results are the same as updateForces(deltaTime).
+     *
+     * @param deltaTime The integration time.
+     * @param jobSystem The job system to run on.
+     */
+    void updateForces(FReal deltaTime, Core::FJobSystem& jobSystem);
+    
+    /**
+     * Sets how the springs are integrated. See EParticleSpringIntegration.
+     *
+     * @param integration The new way, Explicit by default.
+     */
+    void setIntegration(EParticleSpringIntegration integration);
+    
+    /** Returns how the springs are integrated. */
+    EParticleSpringIntegration getIntegration() const;
+    
+    /**
+     * Sets how accurately the springs' lengths and directions are computed. See ENormalization.
+     *
+     * @param normalization The new accuracy, Exact by default.
+     */
+    void setNormalization(ENormalization normalization);
+    
+    /** Returns how accurately the springs' lengths and directions are computed. */
+    ENormalization getNormalization() const;
+    
+    /**
+     * Sets the maximum number of conjugate gradient iterations of the implicit integration.
+     *
+     * @param maxNumberOfIterations The new value, 64 by default.
+     */
+    void setMaxNumberOfIterations(unsigned maxNumberOfIterations);
+    
+    /**
+     * Sets when the conjugate gradient of the implicit integration stops: once the residual's norm falls below this fraction of the right-hand side's,
+     * or of the external impulses' when larger, see EParticleSpringIntegration::Implicit.
+     *
+     * @param tolerance The new value, 1e-4 by default.
+     */
+    void setTolerance(FReal tolerance);
+    
+    /** Returns the number of conjugate gradient iterations of the last implicit integration. */
+    unsigned getNumberOfIterations() const;
+    
+    /**
+     * Returns whether the conjugate gradient of the last implicit integration reached the tolerance. Otherwise it stopped at the maximum number of iterations,
+     * or on a direction of non-positive curvature, and the forces only approximate backward Euler: stiff springs then sag and stretch more than they should.
+     */
+    bool hasConverged() const;
+    
+    /**
+     * Sets the acceleration added to every particle by the integrator, e.g. gravity, which the implicit integration anticipates.
+     * FParticleWorld sets it to its uniform acceleration before each update.
+     *
+     * @param acceleration The new value, zero by default.
+     */
+    void setUniformAcceleration(const FVector3& acceleration);
+    
+    /** Returns the number of colors the springs have been split into by the last update, counting the sequential one. */
+    size_t getNumberOfColors() const;
+    
+private:
+    /** Common implementation of both updateForces(). */
+    void updateForces(FReal deltaTime, Core::FJobSystem* jobSystem);
+    
+    /** Recolors the springs if they changed, and sizes the force arrays. */
+    void prepareUpdate();
+    
+    /** Splits the springs into colors whose springs share no particle, then rebuilds ColoredSprings and ColorBegins. */
+    void colorSprings();
+    
+    /** Lists the particles the springs are attached to, then rebuilds LocalIndicesA and LocalIndicesB. */
+    void indexParticles();
+    
+    /**
+     * Computes the forces of the springs in the range [begin, end), into ForcesX, ForcesY and ForcesZ.
+     * With IsJacobianNeeded, also computes what their stiffness matrices are made of, into Directions and StiffnessCoefficients.
+     * Accuracy chooses how their inverse lengths are computed.
+     *
+     * @param begin The first spring's index.
+     * @param end One past the last spring's index.
+     */
+    template<bool IsJacobianNeeded, ENormalization Accuracy>
+    void computeSpringForces(size_t begin, size_t end);
+    
+    /**
+     * Adds the forces computed for the springs in the range [begin, end) of ColoredSprings to their particles.
+     *
+     * @param begin The first position in ColoredSprings.
+     * @param end One past the last position in ColoredSprings.
+     */
+    void applySpringForces(size_t begin, size_t end);
+    
+    /**
+     * Solves the implicit integration for the velocity changes of the particles, then adds the forces causing them.
+     *
+     * @param deltaTime The integration time.
+     * @param jobSystem The job system to run on, or null.
+     */
+    void solveImplicitly(FReal deltaTime, Core::FJobSystem* jobSystem);
+    
+    /**
+     * Computes -K u, K being the stiffness matrix of the springs, i.e. the derivative of their forces with respect to the particles' positions.
+     *
+     * @param vectors One vector per particle, by local index.
+     * @param products Receives one vector per particle, by local index.
+     * @param jobSystem The job system to run on, or null.
+     */
+    void multiplyByNegativeStiffness(std::span<const FVector3> vectors, std::span<FVector3> products, Core::FJobSystem* jobSystem) const;
+    
+    /**
+     * Computes a vector per spring and adds it to the spring's particle A, and to or from its particle B, color by color.
+     *
+     * @param getSpringVector Returns the vector of a spring, given its index.
+     * @param particleBSign Whether the vector is added to (1) or subtracted from (-1) particle B.
+     * @param products Receives one vector per particle, by local index. It is zeroed first.
+     * @param jobSystem The job system to run on, or null.
+     */
+    template<typename TGetSpringVector>
+    void scatterToParticles(const TGetSpringVector& getSpringVector, FReal particleBSign, std::span<FVector3> products, Core::FJobSystem* jobSystem) const;
+    
+    /**
+     * Computes the dot product of two vectors of per-particle vectors, summing blocks of particles in a fixed order.
+     *
+     * @param jobSystem The job system to run on, or null.
+     */
+    FReal dotProduct(std::span<const FVector3> lhs, std::span<const FVector3> rhs, Core::FJobSystem* jobSystem) const;
+    
+private:
+    /** The number of springs whose forces are computed together: their deltas are gathered first, then processed as flat arrays. */
+    static constexpr size_t ChunkSize = 256;
+    
+    /** The number of particles per job, and per partial sum of the dot products, in the implicit integration. */
+    static constexpr size_t ParticleBlockSize = 1024;
+    
+    /** The maximum number of colors. Springs that do not fit in any are applied last, by a single thread. */
+    static constexpr unsigned MaxNumberOfColors = 64;
+    
+    /** Stores the store where the particles live. */
+    FParticleStore* ParticleStore = nullptr;
+    
+    /** Stores the particle at one end of each spring. */
+    std::vector<FParticleHandle> HandlesA;
+    
+    /** Stores the particle at the other end of each spring. */
+    std::vector<FParticleHandle> HandlesB;
+    
+    /** Stores the spring constant of each spring. */
+    std::vector<FReal> SpringConstants;
+    
+    /** Stores the rest length of each spring. */
+    std::vector<FReal> RestLengths;
+    
+    /** Store the force each spring applies to its particle A, or the difference of its particles' positions while it is computed. */
+    std::vector<FReal> ForcesX;
+    std::vector<FReal> ForcesY;
+    std::vector<FReal> ForcesZ;
+    
+    /** Stores the direction from particle B to particle A of each spring, for the implicit integration. */
+    std::vector<FVector3> Directions;
+    
+    /**
+     * Stores, for each spring, the stiffness across its direction, then the stiffness along it minus the former, for the implicit integration.
+     * -K u for a spring is then (first u + second (n . u) n), n being its direction.
+     */
+    std::vector<std::pair<FReal, FReal>> StiffnessCoefficients;
+    
+    /** Stores the particles the springs are attached to, each once. The implicit integration works on them only. */
+    std::vector<FParticleHandle> Particles;
+    
+    /** Stores the position of particle A of each spring in Particles. */
+    std::vector<uint32_t> LocalIndicesA;
+    
+    /** Stores the position of particle B of each spring in Particles. */
+    std::vector<uint32_t> LocalIndicesB;
+    
+    /**
+     * Stores the vectors of the conjugate gradient, one element per particle: solution, residual, preconditioned residual, search direction, and its product.
+     * The solution is kept for the next step, which starts from it.
+     */
+    std::vector<FVector3> VelocityChanges;
+    std::vector<FVector3> Residuals;
+    std::vector<FVector3> PreconditionedResiduals;
+    std::vector<FVector3> SearchDirections;
+    std::vector<FVector3> Products;
+    
+    /**
+     * Stores the inverse of the system matrix's 3x3 diagonal block of each particle, as its diagonal and its XY, XZ and YZ entries.
+     * They hold the blocks themselves while they are summed.
+     */
+    std::vector<FVector3> Diagonals;
+    std::vector<FVector3> OffDiagonals;
+    
+    /** Stores the particles' masses; zero masses mark immovable particles. */
+    std::vector<FReal> Masses;
+    
+    /** Stores the external forces of the particles, see EParticleSpringIntegration::Implicit. */
+    std::vector<FVector3> ExternalForces;
+    
+    /** Stores the partial sums of the dot products, one per block of particles, so their sum is the same whatever the number of threads. */
+    mutable std::vector<FReal> PartialSums;
+    
+    /** Stores the indices of the springs, sorted by color. */
+    std::vector<uint32_t> ColoredSprings;
+    
+    /** Stores where each color begins in ColoredSprings, the sequential one last, plus one past the last spring. */
+    std::vector<size_t> ColorBegins;
+    
+    /** Indicates whether the colors still match the springs since the last call to colorSprings(). */
+    bool IsColoringValid = false;
+    
+    /** Stores how the springs are integrated. */
+    EParticleSpringIntegration Integration = EParticleSpringIntegration::Explicit;
+    
+    /** Stores how accurately the springs' lengths and directions are computed. */
+    ENormalization Normalization = ENormalization::Exact;
+    
+    /** Stores the maximum number of conjugate gradient iterations. */
+    unsigned MaxNumberOfIterations = 64;
+    
+    /** Stores the relative residual the conjugate gradient stops at. */
+    FReal Tolerance = (FReal) 1e-4;
+    
+    /** Stores the number of conjugate gradient iterations of the last implicit integration. */
+    unsigned NumberOfIterations = 0;
+    
+    /** Indicates whether the last implicit integration reached the tolerance. */
+    bool HasConverged = true;
+    
+    /** Stores the acceleration added to every particle by the integrator. */
+    FVector3 UniformAcceleration = FVector3::ZeroVector;
+    
+    /** Stores the integration time of the last implicit integration, to scale its solution into the next one's starting point. */
+    FReal PreviousDeltaTime = Math::Zero;
+};
+
+}   // End of namespace Physics
+}   // End of namespace GE
@@ -0,0 +1,164 @@
+//
+//  ParticleStore.cpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#include "ParticleStore.hpp"
+
+// STD library includes.
+#include <cmath>
+#include <cassert>
+
+namespace GE
+{
+namespace Physics
+{
+
+FParticleHandle FParticleStore::add()
+{
+    const uint32_t index = static_cast<uint32_t>(size());
+    
+    // Reuse a free slot, if any.
+    uint32_t slotIndex = FirstFreeSlot;
+    if (slotIndex != FParticleHandle::InvalidIndex)
+    {
+        FirstFreeSlot = Slots[slotIndex].Index;
+        Slots[slotIndex].Index = index;
+    }
+    else
+    {
+        slotIndex = static_cast<uint32_t>(Slots.size());
+        Slots.push_back(FSlot{ .Index = index, .Generation = 0 });
+    }
+    
+    Positions.push_back(FParticlePositionVector3::ZeroVector);
+    Velocities.push_back(FParticleVector3::ZeroVector);
+    Accelerations.push_back(FParticleVector3::ZeroVector);
+    AccumulatedForces.push_back(FParticleVector3::ZeroVector);
+    InverseMasses.push_back(Math::One);
+    Dampings.push_back(Math::One);
+    SlotIndices.push_back(slotIndex);
+    
+    return FParticleHandle{ .Index = slotIndex, .Generation = Slots[slotIndex].Generation };
+}
+
+void FParticleStore::remove(FParticleHandle handle)
+{
+    assert(contains(handle));
+    
+    const size_t index = getIndex(handle);
+    const size_t lastIndex = size() - 1;
+    
+    // Move the last particle into the hole, so the arrays stay densely packed.
+    if (index != lastIndex)
+    {
+        Positions[index] = Positions[lastIndex];
+        Velocities[index] = Velocities[lastIndex];
+        Accelerations[index] = Accelerations[lastIndex];
+        AccumulatedForces[index] = AccumulatedForces[lastIndex];
+        InverseMasses[index] = InverseMasses[lastIndex];
+        Dampings[index] = Dampings[lastIndex];
+        SlotIndices[index] = SlotIndices[lastIndex];
+        Slots[SlotIndices[index]].Index = static_cast<uint32_t>(index);
+    }
+    
+    Positions.pop_back();
+    Velocities.pop_back();
+    Accelerations.pop_back();
+    AccumulatedForces.pop_back();
+    InverseMasses.pop_back();
+    Dampings.pop_back();
+    SlotIndices.pop_back();
+    
+    // Invalidate the handle and put its slot in the free list.
+    FSlot& slot = Slots[handle.Index];
+    ++slot.Generation;
+    slot.Index = FirstFreeSlot;
+    FirstFreeSlot = handle.Index;
+}
+
+void FParticleStore::clear()
+{
+    while (size() > 0)
+    {
+        remove(getHandle(size() - 1));
+    }
+}
+
+void FParticleStore::reserve(size_t capacity)
+{
+    Positions.reserve(capacity);
+    Velocities.reserve(capacity);
+    Accelerations.reserve(capacity);
+    AccumulatedForces.reserve(capacity);
+    InverseMasses.reserve(capacity);
+    Dampings.reserve(capacity);
+    SlotIndices.reserve(capacity);
+    Slots.reserve(capacity);
+}
+
+bool FParticleStore::contains(FParticleHandle handle) const
+{
+    return (handle.Index < Slots.size()) && (Slots[handle.Index].Generation == handle.Generation);
+}
+
+FParticleHandle FParticleStore::getHandle(size_t index) const
+{
+    CHECK(index < size())
+    const uint32_t slotIndex = SlotIndices[index];
+    return FParticleHandle{ .Index = slotIndex, .Generation = Slots[slotIndex].Generation };
+}
+
+void FParticleStore::clearAccumulatedForces()
+{
+    clearAccumulatedForces(0, size());
+}
+
+void FParticleStore::clearAccumulatedForces(size_t begin, size_t end)
+{
+    CHECK(end <= size())
+    for (size_t index = begin; index < end; ++index)
+    {
+        AccumulatedForces[index].zeroOut();
+    }
+}
+
+void FParticleStore::integrate(FReal deltaTime)
+{
+    const size_t numberOfParticles = size();
+    for (size_t index = 0; index < numberOfParticles; ++index)
+    {
+        integrate(index, deltaTime);
+    }
+}
+
+void FParticleStore::integrate(size_t index, FReal deltaTime)
+{
+    const FReal inverseMass = InverseMasses[index];
+    
+    // Check whether the particle is immovable or not.
+    if (inverseMass <= Math::Zero)
+    {
+        return;
+    }
+    
+    assert(deltaTime > Math::Zero);
+    
+    FParticleVector3& velocity = Velocities[index];
+    
+    // Position integration.
+    Positions[index].addScaledVector(deltaTime, velocity);
+    
+    // Velocity integration.
+    FVector3 finalAcceleration = Accelerations[index];
+    finalAcceleration.addScaledVector(inverseMass, AccumulatedForces[index]);
+    velocity.addScaledVector(deltaTime, finalAcceleration);
+    
+    // Apply drag.
+    velocity *= Math::pow(Dampings[index], deltaTime);
+}
+
+}   // End of namespace Physics
+}   // End of namespace GE
@@ -0,0 +1,218 @@
+//
+//  ParticleStore.hpp
+//  GalileuEngine
+//
+//  Created by lrazevedo on 17/10/26.
+//
+
+#pragma once
+
+// GE includes.
+#include "AlignedAllocator.hpp"
+#include "Math.hpp"
+#include "Vector3.hpp"
+#include "UtilMacros.hpp"
+
+// STD library includes.
+#include <vector>
+#include <span>
+#include <cstdint>
+#include <limits>
+
+namespace GE
+{
+namespace Physics
+{
+using Math::FVector3;
+using Math::FPositionVector3;
+using Math::FReal;
+using Math::FPositionReal;
+
+// The layout of the particles' and contacts' vectors is chosen at build time, by defining GE_ALIGNED_PARTICLES to 1, e.g. in the preprocessor
+// macros of the build settings: they are then padded and aligned (see FAlignedVector3), so SIMD code moves each of them with one aligned load.
+// By default, they are packed: 12 bytes in single precision, so more of them fit in the caches.
+#if !defined(GE_ALIGNED_PARTICLES)
+    #define GE_ALIGNED_PARTICLES 0
+#endif
+
+/** The vector type of the particles' and contacts' arrays. */
+#if GE_ALIGNED_PARTICLES
+using FParticleVector3 = Math::FAlignedVector3;
+#else
+using FParticleVector3 = FVector3;
+#endif
+
+/** The vector type of the particles' positions. */
+#if GE_ALIGNED_PARTICLES
+using FParticlePositionVector3 = Math::FAlignedPositionVector3;
+#else
+using FParticlePositionVector3 = FPositionVector3;
+#endif
+
+/**
+ * A stable reference to a particle living in a FParticleStore.
+ * It remains valid while the particle is alive, even when the store moves the particle's data around its arrays.
+ */
+struct FParticleHandle
+{
+    /** The value of Index for a handle that does not refer to any particle. */
+    static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+    
+    /** Stores the slot of the particle in the store's indirection table. */
+    uint32_t Index = InvalidIndex;
+    
+    /** Stores the slot's generation, so that handles to removed particles can be told apart from handles to newer ones reusing the slot. */
+    uint32_t Generation = 0;
+    
+    bool operator==(const FParticleHandle&) const = default;
+};
+
+/**
+ * Stores the state of many particles as a structure of arrays, i.e. one contiguous array per attribute, each beginning on a cache line.
+ * Particles are densely packed: the i-th element of every array belongs to the same particle, so loops over all particles stream linearly through memory.
+ * Removing a particle moves the last one into the hole; handles are kept valid through an indirection table.
+ */
+class FParticleStore
+{
+public:
+    /**
+     * Creates a new particle with unit mass, unit damping and every vector set to zero.
+     *
+     * @return A handle to the new particle.
+     */
+    FParticleHandle add();
+    
+    /**
+     * Destroys the particle referred by the given handle. The handle, and any copy of it, becomes invalid.
+     *
+     * @param handle A valid handle.
+     */
+    void remove(FParticleHandle handle);
+    
+    /**
+     * Destroys all particles at once. Every handle becomes invalid.
+     */
+    void clear();
+    
+    /**
+     * Reserves memory for the given number of particles.
+     *
+     * @param capacity The number of particles.
+     */
+    void reserve(size_t capacity);
+    
+    /**
+     * Checks whether the handle refers to a particle alive in this store.
+     */
+    bool contains(FParticleHandle handle) const;
+    
+    /**
+     * Gets the current position of the particle inside the arrays. It might change after a removal.
+     *
+     * @param handle A valid handle.
+     */
+    FORCE_INLINE size_t getIndex(FParticleHandle handle) const
+    {
+        CHECK(contains(handle))
+        return Slots[handle.Index].Index;
+    }
+    
+    /**
+     * Gets the handle of the particle at the given position of the arrays.
+     */
+    FParticleHandle getHandle(size_t index) const;
+    
+    /** Returns the number of particles alive. */
+    FORCE_INLINE size_t size() const { return Positions.size(); }
+    
+    /** Returns the number of slots in the indirection table, i.e. an upper bound for any FParticleHandle::Index. */
+    FORCE_INLINE size_t getNumberOfSlots() const { return Slots.size(); }
+    
+    /**
+     * Clears all the forces applied to every particle.
+     */
+    void clearAccumulatedForces();
+    
+    /**
+     * Clears all the forces applied to the particles in the range [begin, end) of the arrays.
+     *
+     * @param begin The first particle's index.
+     * @param end One past the last particle's index.
+     */
+    void clearAccumulatedForces(size_t begin, size_t end);
+    
+    /**
+     * Advances every particle forward in time. See FParticle::integrate().
+     *
+     * @param deltaTime The integration time.
+     */
+    void integrate(FReal deltaTime);
+    
+    /**
+     * Advances a single particle forward in time. See FParticle::integrate().
+     *
+     * @param index The position of the particle inside the arrays.
+     * @param deltaTime The integration time.
+     */
+    void integrate(size_t index, FReal deltaTime);
+    
+public:
+    std::span<FParticlePositionVector3> getPositions() { return Positions; }
+    std::span<const FParticlePositionVector3> getPositions() const { return Positions; }
+    std::span<FParticleVector3> getVelocities() { return Velocities; }
+    std::span<const FParticleVector3> getVelocities() const { return Velocities; }
+    std::span<FParticleVector3> getAccelerations() { return Accelerations; }
+    std::span<const FParticleVector3> getAccelerations() const { return Accelerations; }
+    std::span<FParticleVector3> getAccumulatedForces() { return AccumulatedForces; }
+    std::span<const FParticleVector3> getAccumulatedForces() const { return AccumulatedForces; }
+    std::span<FReal> getInverseMasses() { return InverseMasses; }
+    std::span<const FReal> getInverseMasses() const { return InverseMasses; }
+    std::span<FReal> getDampings() { return Dampings; }
+    std::span<const FReal> getDampings() const { return Dampings; }
+    
+protected:
+    /** Stores the linear position of each particle in world space. */
+    Core::TCacheAlignedVector<FParticlePositionVector3> Positions;
+    
+    /** Stores the linear velocity of each particle in world space. */
+    Core::TCacheAlignedVector<FParticleVector3> Velocities;
+    
+    /**
+     * Stores the linear acceleration of each particle in world space.
+     * Primarily used to define acceleration due to gravity, but it can also be used for any other constant acceleration.
+     */
+    Core::TCacheAlignedVector<FParticleVector3> Accelerations;
+    
+    /**
+     * Stores the accumulated force of each particle to be used by the integrator. See FParticle::addForce().
+     */
+    Core::TCacheAlignedVector<FParticleVector3> AccumulatedForces;
+    
+    /** Stores (1.0 / Mass) of each particle. See FParticle::setInverseMass(). */
+    Core::TCacheAlignedVector<FReal> InverseMasses;
+    
+    /** Stores the damping factor applied to linear motion of each particle. See FParticle::setDamping(). */
+    Core::TCacheAlignedVector<FReal> Dampings;
+    
+private:
+    /**
+     * An entry of the indirection table. While alive, Index is the particle's position inside the arrays, otherwise it is the next free slot.
+     */
+    struct FSlot
+    {
+        uint32_t Index;
+        uint32_t Generation;
+    };
+    
+    /** Stores the indirection table, indexed by FParticleHandle::Index. */
+    std::vector<FSlot> Slots;
+    
+    /** Stores, for each particle in the arrays, the slot that refers to it. */
+    std::vector<uint32_t> SlotIndices;
+    
+    /** Stores the first free slot of the indirection table. */
+    uint32_t FirstFreeSlot = FParticleHandle::InvalidIndex;
+};
+
+}   // End of namespace Physics
+}   // End of namespace GE
@@ -11,8 +11,12 @@
 #include "Math.hpp"
 #include "UtilMacros.hpp"
 #include "Particle.hpp"
+#include "ParticleBatchIntegrator.hpp"
 
 // STD library includes.
+#include <algorithm>
+#include <cassert>
+#include <cstring>
 #include <optional>
 #include <iostream>
 
@@ -21,69 +25,306 @@ namespace GE
 namespace Physics
 {
 
-FParticleWorld::FParticleWorld(unsigned maxNumberOfContacts, std::optional<unsigned> numberOfIterations)
+FParticleWorld::FParticleWorld(unsigned initialNumberOfContacts, std::optional<unsigned> numberOfIterations)
     :
     isContactResolverIterationsCalculated{ !numberOfIterations.has_value() },
     ParticleContactResolver{ numberOfIterations.has_value()? *numberOfIterations : 0 },
-    ParticleContacts{maxNumberOfContacts}
+    ParticleContactArena{initialNumberOfContacts}
 {
 }
 
+FParticle FParticleWorld::createParticle()
+{
+    return FParticle{ &ParticleStore, ParticleStore.add() };
+}
+
+void FParticleWorld::destroyParticle(const FParticle& particle)
+{
+    CHECK(particle.getStore() == &ParticleStore)
+    ParticleStore.remove(particle.getHandle());
+}
+
+void FParticleWorld::setJobSystem(Core::FJobSystem* jobSystem)
+{
+    JobSystem = jobSystem;
+}
+
+Core::FJobSystem* FParticleWorld::getJobSystem() const
+{
+    return JobSystem;
+}
+
+void FParticleWorld::setContactSolver(EParticleContactSolver solver, unsigned maxNumberOfSweeps)
+{
+    CHECK((solver != EParticleContactSolver::Sequential) || (ContactWarmStartFactor == Math::Zero))
+    
+    ParticleContactResolver.setSolver(solver);
+    ParticleContactResolver.setMaxNumberOfSweeps(maxNumberOfSweeps);
+}
+
+EParticleContactSolver FParticleWorld::getContactSolver() const
+{
+    return ParticleContactResolver.getSolver();
+}
+
+unsigned FParticleWorld::getNumberOfContactIterations() const
+{
+    // The resolver does not run on frames without contacts.
+    return (ParticleContactArena.size() > 0) ? ParticleContactResolver.getNumberOfIterations() : 0;
+}
+
+void FParticleWorld::setForceDispatch(EParticleForceDispatch dispatch)
+{
+    ParticleForcePairManager.setDispatch(dispatch);
+}
+
+EParticleForceDispatch FParticleWorld::getForceDispatch() const
+{
+    return ParticleForcePairManager.getDispatch();
+}
+
+size_t FParticleWorld::addUniformAccelerationField(const FVector3& acceleration)
+{
+    UniformAccelerationFields.push_back(acceleration);
+    return UniformAccelerationFields.size() - 1;
+}
+
+void FParticleWorld::setUniformAccelerationField(size_t fieldIndex, const FVector3& acceleration)
+{
+    CHECK(fieldIndex < UniformAccelerationFields.size())
+    UniformAccelerationFields[fieldIndex] = acceleration;
+}
+
+FVector3 FParticleWorld::getUniformAcceleration() const
+{
+    FVector3 uniformAcceleration = FVector3::ZeroVector;
+    for (const FVector3& field : UniformAccelerationFields)
+    {
+        uniformAcceleration += field;
+    }
+    return uniformAcceleration;
+}
+
+void FParticleWorld::setMaxNumberOfContacts(std::optional<unsigned> maxNumberOfContacts)
+{
+    ParticleContactArena.setMaxCapacity(maxNumberOfContacts);
+}
+
+const FParticleContactArena& FParticleWorld::getParticleContactArena() const
+{
+    return ParticleContactArena;
+}
+
+void FParticleWorld::setContactWarmStartFactor(FReal factor)
+{
+    CHECK((factor >= Math::Zero) && (factor <= Math::One))
+    CHECK((factor == Math::Zero) || (ParticleContactResolver.getSolver() != EParticleContactSolver::Sequential))
+    
+    ContactWarmStartFactor = factor;
+}
+
+FReal FParticleWorld::getContactWarmStartFactor() const
+{
+    return ContactWarmStartFactor;
+}
+
+void FParticleWorld::setDeterministic(bool isDeterministic)
+{
+    IsDeterministic = isDeterministic;
+}
+
+bool FParticleWorld::isDeterministic() const
+{
+    return IsDeterministic;
+}
+
+uint64_t FParticleWorld::computeStateHash() const
+{
+    // FNV-1a, over the components only: padded vectors have an unused fourth one.
+    uint64_t hash = 14695981039346656037ull;
+    const auto hashComponent = [&hash](const auto component)
+    {
+        unsigned char bytes[sizeof(component)];
+        std::memcpy(bytes, &component, sizeof(component));
+        for (const unsigned char byte : bytes)
+        {
+            hash = (hash ^ byte) * 1099511628211ull;
+        }
+    };
+    
+    const std::span<const FParticlePositionVector3> positions = ParticleStore.getPositions();
+    const std::span<const FParticleVector3> velocities = ParticleStore.getVelocities();
+    for (size_t index = 0; index < ParticleStore.size(); ++index)
+    {
+        hashComponent(positions[index].X);
+        hashComponent(positions[index].Y);
+        hashComponent(positions[index].Z);
+        hashComponent(velocities[index].X);
+        hashComponent(velocities[index].Y);
+        hashComponent(velocities[index].Z);
+    }
+    
+    return hash;
+}
+
 void FParticleWorld::startFrame()
 {
-    for (FParticle* particle : Particles)
+    if (JobSystem)
     {
-        particle->clearAccumulatedForces();
+        JobSystem->parallelFor(ParticleStore.size(), FParticleBatchIntegrator::getBatchSize(), [this](size_t begin, size_t end)
+        {
+            ParticleStore.clearAccumulatedForces(begin, end);
+        });
+    }
+    else
+    {
+        ParticleStore.clearAccumulatedForces();
     }
 }
 
 unsigned FParticleWorld::generateContacts()
 {
-    unsigned numberOfAvailableContacts = static_cast<unsigned>(ParticleContacts.size());
-    unsigned firstContactIndex = 0;
-    for (FParticleContactGenerator* generator : ParticleContactGenerators)
+    ParticleContactCache.beginFrame();
+    ParticleContactArena.clear();
+    
+    if (JobSystem)
     {
-        const std::span<FParticleContact> availableParticleContacts{ ParticleContacts.begin() + firstContactIndex, numberOfAvailableContacts };
-        const unsigned numberOfContactsUsed = generator->addContacts(availableParticleContacts);
-        numberOfAvailableContacts -= numberOfContactsUsed;
-        firstContactIndex += numberOfContactsUsed;
-        
-        if (numberOfAvailableContacts <= 0)
+        ParticleContactArena.addContacts(ParticleContactGenerators, *JobSystem);
+    }
+    else
+    {
+        for (const FParticleContactGenerator* generator : ParticleContactGenerators)
         {
-#if GE_BUILD_DEBUG
-            std::cout << "Some contacts might be missing because the world has run out of contacts to fill." << std::endl;
-#endif
-            break;
+            ParticleContactArena.addContacts(*generator);
         }
     }
     
-    const unsigned totalNumberOfContactsUsed = static_cast<unsigned>(ParticleContacts.size()) - numberOfAvailableContacts;
-    return totalNumberOfContactsUsed;
+    // Each generator's contacts are a batch, in the order of the generators.
+    for (size_t generatorIndex = 0; generatorIndex < ParticleContactGenerators.size(); ++generatorIndex)
+    {
+        ParticleContactCache.warmStart(ParticleContactArena.getBatch(generatorIndex), ParticleContactGenerators[generatorIndex], ContactWarmStartFactor);
+    }
+    
+#if GE_BUILD_DEBUG
+    if (ParticleContactArena.getNumberOfOverflows() > 0)
+    {
+        std::cout << "Some contacts might be missing because the world has reached its maximum number of contacts." << std::endl;
+    }
+#endif
+    
+    return ParticleContactArena.size();
 }
 
-void FParticleWorld::integrate(FReal deltaTime)
+void FParticleWorld::updateForces(FReal deltaTime)
 {
-    for (FParticle* particle : Particles)
+    const FVector3 uniformAcceleration = getUniformAcceleration();
+    for (FParticleSpringNetwork* particleSpringNetwork : ParticleSpringNetworks)
+    {
+        particleSpringNetwork->setUniformAcceleration(uniformAcceleration);
+    }
+    
+    if (JobSystem)
     {
-        particle->integrate(deltaTime);
+        ParticleForcePairManager.updateForces(deltaTime, *JobSystem);
+        for (FParticleSpringNetwork* particleSpringNetwork : ParticleSpringNetworks)
+        {
+            particleSpringNetwork->updateForces(deltaTime, *JobSystem);
+        }
+    }
+    else
+    {
+        ParticleForcePairManager.updateForces(deltaTime);
+        for (FParticleSpringNetwork* particleSpringNetwork : ParticleSpringNetworks)
+        {
+            particleSpringNetwork->updateForces(deltaTime);
+        }
     }
 }
 
-void FParticleWorld::runPhysics(FReal deltaTime)
+bool FParticleWorld::isAnySpringNetworkImplicit() const
 {
-    ParticleForcePairManager.updateForces(deltaTime);
-    integrate(deltaTime);
-    
-    if (unsigned totalNumberOfContactsUsed = generateContacts())
+    return std::any_of(ParticleSpringNetworks.begin(), ParticleSpringNetworks.end(), [](const FParticleSpringNetwork* particleSpringNetwork)
+    {
+        return particleSpringNetwork->getIntegration() == EParticleSpringIntegration::Implicit;
+    });
+}
+
+void FParticleWorld::resolveContacts(FReal deltaTime)
+{
+    const unsigned totalNumberOfContactsUsed = generateContacts();
+    const std::span<FParticleContact> particleContacts = ParticleContactArena.getContacts();
+    if (totalNumberOfContactsUsed > 0)
     {
         if (isContactResolverIterationsCalculated)
         {
             ParticleContactResolver.setMaxNumberOfIterations(totalNumberOfContactsUsed * 2);
         }
         
-        ParticleContactResolver.resolveContacts(ParticleContacts, deltaTime);
+        if (JobSystem)
+        {
+            ParticleContactResolver.resolveContacts(particleContacts, deltaTime, *JobSystem);
+        }
+        else
+        {
+            ParticleContactResolver.resolveContacts(particleContacts, deltaTime);
+        }
+    }
+    
+    ParticleContactCache.endFrame(particleContacts);
+}
+
+FParticleIntegrationContext FParticleWorld::makeIntegrationContext(FReal deltaTime, bool isScratchNeeded)
+{
+    assert(deltaTime > Math::Zero);
+    
+    if (isScratchNeeded)
+    {
+        const size_t numberOfParticles = ParticleStore.size();
+        StartPositions.resize(numberOfParticles);
+        StartVelocities.resize(numberOfParticles);
+        PositionIncrements.resize(numberOfParticles);
+        VelocityIncrements.resize(numberOfParticles);
+    }
+    
+    return FParticleIntegrationContext
+    {
+        .ParticleStore = &ParticleStore,
+        .DeltaTime = deltaTime,
+        .UniformAcceleration = getUniformAcceleration(),
+        .StartPositions = StartPositions,
+        .StartVelocities = StartVelocities,
+        .PositionIncrements = PositionIncrements,
+        .VelocityIncrements = VelocityIncrements,
+    };
+}
+
+void FParticleWorld::saveExternalForces()
+{
+    const std::span<const FParticleVector3> accumulatedForces = ParticleStore.getAccumulatedForces();
+    ExternalForces.assign(accumulatedForces.begin(), accumulatedForces.end());
+}
+
+void FParticleWorld::restoreExternalForces()
+{
+    std::copy(ExternalForces.begin(), ExternalForces.end(), ParticleStore.getAccumulatedForces().begin());
+}
+
+void FParticleWorld::forEachParticleRange(const Core::FJobSystem::FRangeTask& task)
+{
+    if (JobSystem)
+    {
+        JobSystem->parallelFor(ParticleStore.size(), FParticleBatchIntegrator::getBatchSize(), task);
+    }
+    else
+    {
+        task(0, ParticleStore.size());
     }
 }
 
+Core::FFloatingPointEnvironment FParticleWorld::getFloatingPointEnvironment() const
+{
+    return IsDeterministic? Core::FFloatingPointEnvironment::getDefault() : Core::FFloatingPointEnvironment::get();
+}
+
 }   // End of namespace Physics
 }   // End of namespace GE
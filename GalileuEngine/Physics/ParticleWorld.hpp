@@ -10,36 +10,164 @@
 // GE includes.
 #include "Math.hpp"
 #include "Particle.hpp"
+#include "ParticleStore.hpp"
+#include "ParticleIntegrators.hpp"
 #include "ParticleForcePairManager.hpp"
+#include "ParticleSpringNetwork.hpp"
 #include "ParticleContactResolver.hpp"
 #include "ContactGenerators/ParticleContactGenerator.hpp"
 #include "ParticleContact.hpp"
+#include "ParticleContactCache.hpp"
+#include "ParticleContactArena.hpp"
+#include "JobSystem.hpp"
+#include "FloatingPointEnvironment.hpp"
 
 // STD library includes.
+#include <cstdint>
 #include <vector>
 #include <optional>
+#include <type_traits>
 
 namespace GE
 {
 namespace Physics
 {
 using Math::FReal;
+using Math::FVector3;
 
 /** 
  * Manages a collection of particles and provides methods to update them collectively.
  * So, this is a particle simulator.
+ *
+ * Its results do not depend on the job system nor on its number of workers: particles are split at fixed boundaries, forces and contact impulses
+ * are summed in a fixed order, and contacts are kept in the order of their generators. See setDeterministic() to also pin the floating-point environment.
  */
 class FParticleWorld
 {
 public:
     /**
-     * Creates a world that can handle at most the given number of contacts per frame.
+     * Creates a world whose contact storage starts with the given number of contacts and grows as needed, see FParticleContactArena.
      * The number of contact-resolution iterations may be specified.
      *
-     * @param maxNumberOfContacts The maximum number of contacts per frame allowed.
+     * @param initialNumberOfContacts The number of contacts to allocate up front.
      * @param numberOfIterations The maximum number of iteratons allowed while resolving contacts. The default value is: 2*(number of contacts).
      */
-    FParticleWorld(unsigned maxNumberOfContacts, std::optional<unsigned> numberOfIterations = std::nullopt);
+    FParticleWorld(unsigned initialNumberOfContacts, std::optional<unsigned> numberOfIterations = std::nullopt);
+    
+    /**
+     * Creates a new particle owned by this world. See FParticleStore::add().
+     *
+     * @return A view of the new particle.
+     */
+    FParticle createParticle();
+    
+    /**
+     * Destroys a particle owned by this world. Every view of it becomes invalid.
+     * It must not be referenced by any force pair or contact generator anymore.
+     *
+     * @param particle A view of the particle.
+     */
+    void destroyParticle(const FParticle& particle);
+    
+    /**
+     * Sets the job system running the phases that process particles independently: clearing forces, updating force pairs and integrating.
+     * Contact generators also run concurrently with each other, so they must not share mutable state; the contacts keep the same order.
+     * Without one, the default, everything runs on the thread calling runPhysics().
+     * See FParticleForcePairManager::updateForces() for the requirements on force generators.
+     *
+     * @param jobSystem The job system, or null. It must outlive the world, or be replaced before being destroyed.
+     */
+    void setJobSystem(Core::FJobSystem* jobSystem);
+    
+    /** Returns the job system running the parallel phases, if any. */
+    Core::FJobSystem* getJobSystem() const;
+    
+    /**
+     * Sets the algorithm resolving the contacts. See EParticleContactSolver.
+     * The parallel solvers run on the job system, if any, and are limited by the number of sweeps instead of the number of iterations.
+     * Sequential does not support warm starting, so the warm-start factor must be zero to select it, see setContactWarmStartFactor().
+     *
+     * @param solver The new algorithm.
+     * @param maxNumberOfSweeps The maximum number of sweeps over all contacts performed by the parallel solvers.
+     */
+    void setContactSolver(EParticleContactSolver solver, unsigned maxNumberOfSweeps = 16);
+    
+    /** Returns the algorithm resolving the contacts. */
+    EParticleContactSolver getContactSolver() const;
+    
+    /** Returns the number of contact resolutions the last frame took, see FParticleContactResolver::getNumberOfIterations(). */
+    unsigned getNumberOfContactIterations() const;
+    
+    /**
+     * Sets how the force generators are called. See EParticleForceDispatch.
+     *
+     * @param dispatch The new way, Virtual by default.
+     */
+    void setForceDispatch(EParticleForceDispatch dispatch);
+    
+    /** Returns how the force generators are called. */
+    EParticleForceDispatch getForceDispatch() const;
+    
+    /**
+     * Adds a uniform acceleration field, e.g. gravity or wind. The integrator adds it to every movable particle,
+     * so it needs neither a force generator nor a pair per particle.
+     *
+     * @param acceleration The acceleration of the field.
+     * @return The index of the field, to change it with setUniformAccelerationField().
+     */
+    size_t addUniformAccelerationField(const FVector3& acceleration);
+    
+    /**
+     * Changes a uniform acceleration field. Set it to zero to disable it.
+     *
+     * @param fieldIndex The index returned by addUniformAccelerationField().
+     * @param acceleration The new acceleration of the field.
+     */
+    void setUniformAccelerationField(size_t fieldIndex, const FVector3& acceleration);
+    
+    /** Returns the sum of the uniform acceleration fields, which is what the integrator applies. */
+    FVector3 getUniformAcceleration() const;
+    
+    /**
+     * Sets the maximum number of contacts per frame, for real-time budgets. The contacts beyond it are lost, but counted by the contact arena.
+     *
+     * @param maxNumberOfContacts The new value. None, the default, lets the contact storage grow without bounds.
+     */
+    void setMaxNumberOfContacts(std::optional<unsigned> maxNumberOfContacts);
+    
+    /** Returns the contact storage, and its statistics: high-water mark, overflows, and so on. */
+    const FParticleContactArena& getParticleContactArena() const;
+    
+    /**
+     * Sets how much of the impulse a contact needed in the previous frame the resolver starts from. See FParticleContactCache.
+     * Zero, the default, disables warm starting. Only the parallel solvers support it, see EParticleContactSolver.
+     *
+     * @param factor The fraction of the previous impulse, in [0, 1]. It must be zero while the solver is Sequential.
+     */
+    void setContactWarmStartFactor(FReal factor);
+    
+    /** Returns the fraction of the previous impulse contacts are warm-started with. */
+    FReal getContactWarmStartFactor() const;
+    
+    /**
+     * Sets whether runPhysics() runs with the default floating-point environment, see FFloatingPointEnvironment::getDefault(),
+     * instead of the calling thread's one, e.g. with denormals flushed to zero by the application or a library.
+     * The same scene, built the same way and stepped with the same time steps, then gives bit-identical results on every run of the same binary,
+     * whatever the number of threads, as replays and lockstep networking need. Other binaries must be built with the same options, without floating-point contraction (-ffp-contract=off)
+     * nor fast-math, and run on the same SIMD backend, see FSimdBackend.
+     *
+     * @param isDeterministic The new value, false by default.
+     */
+    void setDeterministic(bool isDeterministic);
+    
+    /** Returns whether the world runs with the default floating-point environment. */
+    bool isDeterministic() const;
+    
+    /**
+     * Returns a hash of the particles' positions and velocities, e.g. to detect that replays or lockstep peers have diverged.
+     * It depends on the order the particles were created and destroyed in, and on the precision of the build.
+     */
+    uint64_t computeStateHash() const;
     
     /**
      * Prepares the world for a simulation frame by clearing the force accumulators for all particles.
@@ -50,26 +178,64 @@ public:
     /** Invokes each registered contact generator to report contacts and returns the total number of contacts generated. */
     unsigned generateContacts();
     
-    /** Advances all particles in the world forward in time by the specified duration.
+    /**
+     * Advances all particles in the world forward in time by the specified duration.
+     * The forces of the force pairs and spring networks are evaluated before each stage of the integrator, on top of the forces applied since startFrame().
      *
+     * @tparam TParticleIntegrator The integration method, see ParticleIntegrator. It is chosen at compile time, so its kernels are inlined in the loops over the particles.
+     *                             It must be FParticleSemiImplicitEulerIntegrator if any spring network is implicit, see EParticleSpringIntegration::Implicit.
      * @param deltaTime The integration time.
      */
+    template<ParticleIntegrator TParticleIntegrator = FParticleExplicitEulerIntegrator>
     void integrate(FReal deltaTime);
     
     /**
      * Executes all physics calculations for the particle world.
      *
+     * @tparam TParticleIntegrator The integration method, see integrate().
      * @param deltaTime The integration time.
      */
+    template<ParticleIntegrator TParticleIntegrator = FParticleExplicitEulerIntegrator>
     void runPhysics(FReal deltaTime);
     
 public: // TEMPORARY
-    std::vector<FParticle*>& getParticles(){ return Particles; }
+    FParticleStore& getParticleStore(){ return ParticleStore; }
     FParticleForcePairManager& getParticleForcePairManager(){ return ParticleForcePairManager; };
+    std::vector<FParticleContactGenerator*>& getParticleContactGenerators(){ return ParticleContactGenerators; }
+    std::vector<FParticleSpringNetwork*>& getParticleSpringNetworks(){ return ParticleSpringNetworks; }
+    
+private:
+    /** Adds the forces of the force pairs and of the spring networks to the particles' accumulated forces. */
+    void updateForces(FReal deltaTime);
+    
+    /** Returns whether any spring network is integrated implicitly. */
+    bool isAnySpringNetworkImplicit() const;
+    
+    /** Generates the contacts, resolves them and remembers their impulses. */
+    void resolveContacts(FReal deltaTime);
+    
+    /**
+     * Prepares what an integrator needs for a step, including its scratch arrays.
+     *
+     * @param isScratchNeeded Whether the scratch arrays must be sized.
+     */
+    FParticleIntegrationContext makeIntegrationContext(FReal deltaTime, bool isScratchNeeded);
+    
+    /** Copies the accumulated forces into ExternalForces, so that every stage of an integrator starts from them. */
+    void saveExternalForces();
+    
+    /** Copies ExternalForces back into the accumulated forces. */
+    void restoreExternalForces();
+    
+    /** Runs the task on every range of particles, on the job system if any. */
+    void forEachParticleRange(const Core::FJobSystem::FRangeTask& task);
+    
+    /** Returns the floating-point environment the world runs with: the default one if it is deterministic, the calling thread's one otherwise. */
+    Core::FFloatingPointEnvironment getFloatingPointEnvironment() const;
     
 protected:
-    /** The collection of particles being managed. */
-    std::vector<FParticle*> Particles;
+    /** The collection of particles being managed, stored as a structure of arrays. */
+    FParticleStore ParticleStore;
     
     /** Indicates whether the world should determine the number of iterations for the contact resolver each frame. */
     const bool isContactResolverIterationsCalculated;
@@ -77,15 +243,82 @@ protected:
     /** Stores the force generators associated with the particles in this world. */
     FParticleForcePairManager ParticleForcePairManager;
     
+    /** Stores the spring networks acting on the particles, updated after the force generators. */
+    std::vector<FParticleSpringNetwork*> ParticleSpringNetworks;
+    
     /** Stores the particle contact resolver. */
     FParticleContactResolver ParticleContactResolver;
     
     /** Stores the particle contact generators */
     std::vector<FParticleContactGenerator*> ParticleContactGenerators;
     
-    /** Stores the list of particle contacts. */
-    std::vector<FParticleContact> ParticleContacts;
+    /** Stores the particle contacts of the current frame. */
+    FParticleContactArena ParticleContactArena;
+    
+    /** Stores the impulses of the previous frame's contacts. */
+    FParticleContactCache ParticleContactCache;
+    
+    /** Stores the fraction of the previous impulse contacts are warm-started with. */
+    FReal ContactWarmStartFactor = Math::Zero;
+    
+    /** Stores the uniform acceleration fields. */
+    std::vector<FVector3> UniformAccelerationFields;
+    
+    /** Stores the forces applied since startFrame(), for integrators evaluating the forces more than once per step. */
+    std::vector<FVector3> ExternalForces;
+    
+    /** Stores the scratch arrays of the integrators whose IsScratchNeeded is true, see FParticleIntegrationContext. */
+    std::vector<FPositionVector3> StartPositions;
+    std::vector<FVector3> StartVelocities;
+    std::vector<FVector3> PositionIncrements;
+    std::vector<FVector3> VelocityIncrements;
+    
+    /** Stores the job system running the parallel phases. It is null when the world is single-threaded. */
+    Core::FJobSystem* JobSystem = nullptr;
+    
+    /** Indicates whether the world runs with the default floating-point environment. */
+    bool IsDeterministic = false;
 };
 
+template<ParticleIntegrator TParticleIntegrator>
+void FParticleWorld::integrate(FReal deltaTime)
+{
+    // Implicit springs assume that the positions move with the velocities at the end of the step.
+    CHECK((std::is_same_v<TParticleIntegrator, FParticleSemiImplicitEulerIntegrator>) || !isAnySpringNetworkImplicit())
+    
+    const FParticleIntegrationContext context = makeIntegrationContext(deltaTime, TParticleIntegrator::IsScratchNeeded);
+    forEachParticleRange([&context](size_t begin, size_t end)
+    {
+        TParticleIntegrator::beginStep(context, begin, end);
+    });
+    
+    if constexpr (TParticleIntegrator::NumberOfStages > 1)
+    {
+        saveExternalForces();
+    }
+    
+    for (unsigned stage = 0; stage < TParticleIntegrator::NumberOfStages; ++stage)
+    {
+        if (stage > 0)
+        {
+            restoreExternalForces();
+        }
+        
+        updateForces(deltaTime);
+        forEachParticleRange([&context, stage](size_t begin, size_t end)
+        {
+            TParticleIntegrator::integrateStage(context, stage, begin, end);
+        });
+    }
+}
+
+template<ParticleIntegrator TParticleIntegrator>
+void FParticleWorld::runPhysics(FReal deltaTime)
+{
+    const Core::FScopedFloatingPointEnvironment scopedEnvironment{getFloatingPointEnvironment()};
+    integrate<TParticleIntegrator>(deltaTime);
+    resolveContacts(deltaTime);
+}
+
 }   // End of namespace Physics
 }   // End of namespace GE
@@ -1,14 +1,35 @@
 #include "Application.hpp"
 #include <iostream>
 #include "Vector3.hpp"
+#include "Vector3xN.hpp"
 #include "Particle.hpp"
-#include "ParticleGravityGenerator.hpp"
+#include "ParticleStore.hpp"
+#include "ParticleBatchIntegrator.hpp"
 #include "ParticleWorld.hpp"
+#include "JobSystem.hpp"
+#include "ParticleGravityGenerator.hpp"
+#include "ParticleSpringGenerator.hpp"
+#include "ParticleSpringNetwork.hpp"
+#include "ParticleHashGridCollider.hpp"
+#include "ParticleSweepAndPruneCollider.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cfenv>
 #include <cmath>
 #include <cassert>
 #include <thread>
 #include <chrono>
+#include <iomanip>
+#include <functional>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 void debugParticle(const GE::Physics::FParticle& particle)
 {
@@ -18,43 +39,1386 @@ void debugParticle(const GE::Physics::FParticle& particle)
     std::cout << "Velocity: " << particle.getVelocity() << std::endl;
 }
 
-void updatePhysics(bool& isPhysicsEnabled)
+/**
+ * Times FParticleStore::integrate(), one particle at a time, against FParticleBatchIntegrator on 1k, 100k and 1M particles,
+ * and measures how far apart their positions end up.
+ */
+void benchmarkBatchIntegrator()
 {
     using namespace GE::Math;
     using namespace GE::Physics;
     
-    FReal timeSinceStart = 0.0f;
-    FReal deltaTime = 1.0f / 60.0f;
+    const FReal deltaTime = 1.0f / 60.0f;
+    
+    // Every 17th particle is immovable, and every 100th one has a different damping, so the batch integrator recomputes its damping power.
+    auto fill = [](FParticleStore& store, size_t numberOfParticles)
+    {
+        store.reserve(numberOfParticles);
+        for (size_t index = 0; index < numberOfParticles; ++index)
+        {
+            store.add();
+        }
+        for (size_t index = 0; index < numberOfParticles; ++index)
+        {
+            store.getPositions()[index] = FVector3{(FReal) std::sin(index), (FReal) std::cos(0.7*index), (FReal) std::sin(1.9*index)};
+            store.getVelocities()[index] = FVector3{(FReal) std::cos(1.3*index), (FReal) std::sin(0.3*index), (FReal) std::cos(2.1*index)};
+            store.getAccelerations()[index] = FVector3{0.0, -10.0, 0.0};
+            store.getAccumulatedForces()[index] = FVector3{(FReal) std::sin(0.1*index), (FReal) 0.5, (FReal) std::cos(0.9*index)};
+            store.getInverseMasses()[index] = (index % 17 == 0) ? Zero : (FReal) 1.0 + (FReal) 0.5 * (FReal) std::sin(0.5*index);
+            store.getDampings()[index] = (index % 100 == 0) ? (FReal) 0.9 : (FReal) 0.99;
+        }
+    };
+    
+    std::cout << "==== FParticleBatchIntegrator: ns per particle per step, " << RealName << " reals with "
+              << FParticleBatchIntegrator::getBatchSize() << " particles per batch ====" << std::endl;
+    std::cout << std::right << std::setw(12) << "Particles" << std::setw(12) << "Scalar" << std::setw(12) << "Batch"
+              << std::setw(12) << "Speedup" << std::setw(12) << "Max diff." << std::endl;
+    for (const size_t numberOfParticles : {size_t{1000}, size_t{100000}, size_t{1000000}})
+    {
+        FParticleStore scalarStore;
+        FParticleStore batchStore;
+        fill(scalarStore, numberOfParticles);
+        fill(batchStore, numberOfParticles);
+        
+        // About as many particle steps for each size.
+        const unsigned numberOfSteps = (unsigned) std::max<size_t>(10, 2000000 / numberOfParticles);
+        auto measureTimePerParticle = [&](const auto& step)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            for (unsigned stepIndex = 0; stepIndex < numberOfSteps; ++stepIndex)
+            {
+                step();
+            }
+            const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+            return elapsed.count() / ((double) numberOfSteps * numberOfParticles);
+        };
+        const double scalarTime = measureTimePerParticle([&]{ scalarStore.integrate(deltaTime); });
+        const double batchTime = measureTimePerParticle([&]{ FParticleBatchIntegrator::integrate(batchStore, deltaTime); });
+        
+        double maxDifference = 0.0;
+        for (size_t index = 0; index < numberOfParticles; ++index)
+        {
+            const TVector3<double> scalarPosition{scalarStore.getPositions()[index]};
+            const TVector3<double> batchPosition{batchStore.getPositions()[index]};
+            maxDifference = std::max(maxDifference, (scalarPosition - batchPosition).magnitude() / std::max(1.0, scalarPosition.magnitude()));
+        }
+        
+        std::cout << std::right << std::setw(12) << numberOfParticles << std::setprecision(3)
+                  << std::setw(12) << scalarTime
+                  << std::setw(12) << batchTime
+                  << std::setw(12) << scalarTime / batchTime
+                  << std::setw(12) << maxDifference << std::endl;
+    }
+    std::cout << "=============================================" << std::endl;
+}
+
+/**
+ * A collider testing every pair of particles, the reference of benchmarkColliders().
+ */
+class FParticleBruteForceCollider : public GE::Physics::FParticleCollider
+{
+private:
+    virtual unsigned addContactsImplementation(std::span<GE::Physics::FParticleContact> particleContacts) const override
+    {
+        gatherParticles();
+        unsigned numberOfContacts = 0;
+        for (size_t firstIndex = 0; firstIndex < Particles.size(); ++firstIndex)
+        {
+            for (size_t secondIndex = firstIndex + 1; secondIndex < Particles.size(); ++secondIndex)
+            {
+                testPair(firstIndex, secondIndex, particleContacts, numberOfContacts);
+            }
+        }
+        return numberOfContacts;
+    }
+};
+
+/**
+ * Times the sweep-and-prune and hash grid colliders against brute force, on particles with radii spanning two orders of magnitude,
+ * in a static scene and in scenes jittered every frame, and checks that both find the same pairs as brute force.
+ * Then times the hash grid alone on 200k particles of similar radii, against the budget of a 60 Hz frame.
+ *
+ * @return Whether the pairs matched in every scene.
+ */
+bool benchmarkColliders()
+{
+    using namespace GE::Math;
+    using namespace GE::Physics;
+    
+    constexpr unsigned numberOfFrames = 10;
+    
+    // Each pair of particles, the lowest address first, so contact orders and normals do not matter.
+    auto getPairs = [](std::span<const FParticleContact> particleContacts)
+    {
+        std::set<std::pair<const FParticle*, const FParticle*>> pairs;
+        for (const FParticleContact& contact : particleContacts)
+        {
+            pairs.insert(std::minmax<const FParticle*>(contact.Particles[0], contact.Particles[1]));
+        }
+        return pairs;
+    };
+    
+    std::cout << "==== Colliders: ms per frame, lognormal radii, particles jittered by the given distance per frame ====" << std::endl;
+    std::cout << std::right << std::setw(12) << "Particles" << std::setw(12) << "Jitter" << std::setw(12) << "SAP" << std::setw(12) << "Hash grid"
+              << std::setw(12) << "Brute force" << std::setw(12) << "Contacts" << std::setw(12) << "Same pairs" << std::endl;
+    bool isCorrect = true;
+    for (const unsigned numberOfParticles : {2000u, 20000u})
+    {
+        for (const float jitter : {0.0f, 0.02f, 0.5f})
+        {
+            std::mt19937 generator{1};
+            std::uniform_real_distribution<float> uniform{-1.0f, 1.0f};
+            std::lognormal_distribution<float> lognormal{-2.0f, 1.0f};
+            const float halfExtent = std::cbrt((float) numberOfParticles) * 1.5f;
+            
+            FParticleStore store;
+            std::vector<FParticle> particles;
+            particles.reserve(numberOfParticles);
+            FParticleSweepAndPruneCollider sweepAndPrune;
+            FParticleHashGridCollider hashGrid;
+            FParticleBruteForceCollider bruteForce;
+            for (unsigned index = 0; index < numberOfParticles; ++index)
+            {
+                FParticle& particle = particles.emplace_back(&store, store.add());
+                particle.setPosition(FVector3{uniform(generator) * halfExtent, uniform(generator) * halfExtent, uniform(generator) * halfExtent});
+                const FReal radius = std::min(lognormal(generator), 4.0f);
+                sweepAndPrune.add(&particle, radius);
+                hashGrid.add(&particle, radius);
+                bruteForce.add(&particle, radius);
+            }
+            
+            std::vector<FParticleContact> sweepAndPruneContacts(16 * numberOfParticles);
+            std::vector<FParticleContact> hashGridContacts(16 * numberOfParticles);
+            std::vector<FParticleContact> bruteForceContacts(16 * numberOfParticles);
+            
+            // The first frame sorts the sweep and prune from scratch, the following ones only fix it up.
+            unsigned numberOfContacts = sweepAndPrune.addContacts(sweepAndPruneContacts);
+            unsigned numberOfHashGridContacts = 0;
+            double sweepAndPruneTime = 0.0;
+            double hashGridTime = 0.0;
+            for (unsigned frame = 0; frame < numberOfFrames; ++frame)
+            {
+                for (FParticle& particle : particles)
+                {
+                    particle.setPosition(particle.getPosition() + FVector3{uniform(generator), uniform(generator), uniform(generator)} * jitter);
+                }
+                
+                auto start = std::chrono::steady_clock::now();
+                numberOfContacts = sweepAndPrune.addContacts(sweepAndPruneContacts);
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                sweepAndPruneTime += elapsed.count() / numberOfFrames;
+                
+                start = std::chrono::steady_clock::now();
+                numberOfHashGridContacts = hashGrid.addContacts(hashGridContacts);
+                elapsed = std::chrono::steady_clock::now() - start;
+                hashGridTime += elapsed.count() / numberOfFrames;
+            }
+            
+            // Brute force is too slow to run every frame, only the last one is compared.
+            const auto start = std::chrono::steady_clock::now();
+            const unsigned numberOfBruteForceContacts = bruteForce.addContacts(bruteForceContacts);
+            const std::chrono::duration<double, std::milli> bruteForceTime = std::chrono::steady_clock::now() - start;
+            
+            const auto bruteForcePairs = getPairs(std::span{bruteForceContacts}.first(numberOfBruteForceContacts));
+            const bool arePairsSame = (sweepAndPrune.getNumberOfOverflowedContacts() == 0) && (hashGrid.getNumberOfOverflowedContacts() == 0)
+                && (bruteForce.getNumberOfOverflowedContacts() == 0)
+                && (getPairs(std::span{sweepAndPruneContacts}.first(numberOfContacts)) == bruteForcePairs)
+                && (getPairs(std::span{hashGridContacts}.first(numberOfHashGridContacts)) == bruteForcePairs);
+            isCorrect = isCorrect && arePairsSame;
+            
+            std::cout << std::right << std::setw(12) << numberOfParticles << std::setprecision(3)
+                      << std::setw(12) << jitter
+                      << std::setw(12) << sweepAndPruneTime
+                      << std::setw(12) << hashGridTime
+                      << std::setw(12) << bruteForceTime.count()
+                      << std::setw(12) << numberOfContacts
+                      << std::setw(12) << (arePairsSame ? "yes" : "NO!") << std::endl;
+        }
+    }
+    
+    // The hash grid's target: 200k colliding particles at 60 Hz on one core, moving a little every frame.
+    {
+        constexpr unsigned numberOfParticles = 200000;
+        constexpr double frameBudget = 1000.0 / 60.0;
+        std::mt19937 generator{1};
+        std::uniform_real_distribution<float> uniform{-1.0f, 1.0f};
+        std::uniform_real_distribution<float> radii{0.1f, 0.5f};
+        const float halfExtent = std::cbrt((float) numberOfParticles) * 1.6f;
+        
+        FParticleStore store;
+        std::vector<FParticle> particles;
+        particles.reserve(numberOfParticles);
+        FParticleHashGridCollider hashGrid;
+        for (unsigned index = 0; index < numberOfParticles; ++index)
+        {
+            FParticle& particle = particles.emplace_back(&store, store.add());
+            particle.setPosition(FVector3{uniform(generator) * halfExtent, uniform(generator) * halfExtent, uniform(generator) * halfExtent});
+            hashGrid.add(&particle, radii(generator));
+        }
+        
+        std::vector<FParticleContact> hashGridContacts(numberOfParticles);
+        unsigned numberOfContacts = hashGrid.addContacts(hashGridContacts);
+        double hashGridTime = 0.0;
+        for (unsigned frame = 0; frame < numberOfFrames; ++frame)
+        {
+            for (FParticle& particle : particles)
+            {
+                particle.setPosition(particle.getPosition() + FVector3{uniform(generator), uniform(generator), uniform(generator)} * 0.02f);
+            }
+            
+            const auto start = std::chrono::steady_clock::now();
+            numberOfContacts = hashGrid.addContacts(hashGridContacts);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            hashGridTime += elapsed.count() / numberOfFrames;
+        }
+        
+        std::cout << std::setprecision(3) << "Hash grid, " << numberOfParticles << " particles of radii 0.1 to 0.5, " << numberOfContacts << " contacts: "
+                  << hashGridTime << " ms per frame, " << (hashGridTime <= frameBudget ? "within" : "OVER") << " the " << frameBudget << " ms budget of 60 Hz." << std::endl;
+    }
+    std::cout << "=============================================" << std::endl;
+    return isCorrect;
+}
+
+/**
+ * Simulates resting stacks with and without warm starting the contacts from the previous frame, see FParticleWorld::setContactWarmStartFactor(),
+ * for several budgets of sweeps, and reports how deep the contacts remain, how fast the particles still move, and how many sweeps were used.
+ */
+void benchmarkContactWarmStarting()
+{
+    using namespace GE::Math;
+    using namespace GE::Physics;
+    
+    constexpr int NumberOfColumns = 100;
+    constexpr int ColumnHeight = 15;
+    constexpr unsigned NumberOfFrames = 600;
+    constexpr unsigned NumberOfSettlingFrames = 300;
+    
+    struct FResult
+    {
+        double Penetration;
+        double Speed;
+        double NumberOfSweeps;
+        double FrameTime;
+    };
+    auto simulate = [&](EParticleContactSolver solver, unsigned maxNumberOfSweeps, FReal warmStartFactor)
+    {
+        FParticleWorld world{1 << 16};
+        world.setContactSolver(solver, maxNumberOfSweeps);
+        world.setContactWarmStartFactor(warmStartFactor);
+        world.addUniformAccelerationField(FVector3{0.0, -10.0, 0.0});
+        
+        FParticleHashGridCollider collider;
+        collider.RestitutionCoefficient = Zero;
+        collider.ContactMargin = (FReal) 0.02;
+        std::vector<FParticle> particles;
+        particles.reserve(NumberOfColumns * (ColumnHeight + 1));
+        for (int column = 0; column < NumberOfColumns; ++column)
+        {
+            for (int level = 0; level <= ColumnHeight; ++level)
+            {
+                FParticle particle = world.createParticle();
+                particle.setPosition(FVector3{(FReal) (3 * (column % 10)), (FReal) (0.99 * level), (FReal) (3 * (column / 10))});
+                particle.setDamping((FReal) 0.99);
+                if (level == 0)
+                {
+                    particle.setInverseMass(Zero);
+                }
+                particles.push_back(particle);
+            }
+        }
+        for (FParticle& particle : particles)
+        {
+            collider.add(&particle, (FReal) 0.5);
+        }
+        world.getParticleContactGenerators().push_back(&collider);
+        
+        // Average over the frames after the stacks have settled.
+        FResult result{0.0, 0.0, 0.0, 0.0};
+        std::vector<FParticleContact> contacts(1 << 16);
+        std::chrono::duration<double, std::milli> elapsed{0.0};
+        for (unsigned frame = 0; frame < NumberOfFrames; ++frame)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            world.startFrame();
+            world.runPhysics<FParticleSemiImplicitEulerIntegrator>((FReal) (1.0 / 60.0));
+            elapsed += std::chrono::steady_clock::now() - start;
+            if (frame < NumberOfSettlingFrames)
+            {
+                continue;
+            }
+            
+            // Regenerates the contacts to see how deep the resolution left them.
+            const unsigned numberOfContacts = collider.addContacts(contacts);
+            double penetration = 0.0;
+            for (unsigned contactIndex = 0; contactIndex < numberOfContacts; ++contactIndex)
+            {
+                penetration = std::max(penetration, (double) contacts[contactIndex].PenetrationDepth);
+            }
+            double speed = 0.0;
+            for (const FParticle& particle : particles)
+            {
+                speed = std::max(speed, (double) particle.getVelocity().magnitude());
+            }
+            result.Penetration += penetration;
+            result.Speed += speed;
+            result.NumberOfSweeps += (double) world.getNumberOfContactIterations() / std::max(world.getParticleContactArena().size(), 1u);
+        }
+        constexpr unsigned numberOfMeasuredFrames = NumberOfFrames - NumberOfSettlingFrames;
+        result.Penetration /= numberOfMeasuredFrames;
+        result.Speed /= numberOfMeasuredFrames;
+        result.NumberOfSweeps /= numberOfMeasuredFrames;
+        result.FrameTime = elapsed.count() / NumberOfFrames;
+        return result;
+    };
+    
+    // The stacks count as resting once both stay under these.
+    constexpr double MaxRestingPenetration = 0.01;
+    constexpr double MaxRestingSpeed = 0.01;
+    constexpr unsigned SweepBudgets[] = {1, 2, 4, 8, 16, 32};
+    
+    std::cout << "==== Warm starting: " << NumberOfColumns << " resting columns of " << ColumnHeight << " particles at 60 Hz, averages over frames "
+              << NumberOfSettlingFrames << "-" << NumberOfFrames << ", with " << RealName << " reals ====" << std::endl;
+    std::cout << std::left << std::setw(22) << "Solver" << std::setw(8) << "Start" << std::right << std::setw(12) << "Max sweeps"
+              << std::setw(12) << "Sweeps" << std::setw(14) << "Penetration" << std::setw(12) << "Max speed" << std::setw(12) << "ms/frame" << std::endl;
+    for (const EParticleContactSolver solver : {EParticleContactSolver::ColoredGaussSeidel, EParticleContactSolver::Jacobi})
+    {
+        const char* solverName = (solver == EParticleContactSolver::Jacobi) ? "Jacobi" : "Colored Gauss-Seidel";
+        unsigned sweepsToRest[2] = {0, 0};
+        for (const FReal warmStartFactor : {Zero, One})
+        {
+            for (const unsigned maxNumberOfSweeps : SweepBudgets)
+            {
+                const FResult result = simulate(solver, maxNumberOfSweeps, warmStartFactor);
+                std::cout << std::left << std::setw(22) << solverName
+                          << std::setw(8) << ((warmStartFactor > Zero) ? "warm" : "cold") << std::right << std::setprecision(3)
+                          << std::setw(12) << maxNumberOfSweeps
+                          << std::setw(12) << result.NumberOfSweeps
+                          << std::setw(14) << result.Penetration
+                          << std::setw(12) << result.Speed
+                          << std::setw(12) << result.FrameTime << std::endl;
+                
+                unsigned& sweeps = sweepsToRest[(warmStartFactor > Zero) ? 1 : 0];
+                if ((sweeps == 0) && (result.Penetration < MaxRestingPenetration) && (result.Speed < MaxRestingSpeed))
+                {
+                    sweeps = maxNumberOfSweeps;
+                }
+            }
+        }
+        
+        const auto printSweeps = [&](unsigned sweeps)
+        {
+            if (sweeps > 0)
+            {
+                std::cout << sweeps;
+            }
+            else
+            {
+                std::cout << "more than " << SweepBudgets[std::size(SweepBudgets) - 1];
+            }
+        };
+        std::cout << solverName << " rests under " << MaxRestingPenetration << " m and " << MaxRestingSpeed << " m/s with ";
+        printSweeps(sweepsToRest[0]);
+        std::cout << " sweeps cold, ";
+        printSweeps(sweepsToRest[1]);
+        std::cout << " warm." << std::endl;
+    }
+    std::cout << "=============================================" << std::endl;
+}
+
+/**
+ * Times integration and each contact solver with the particle layout of this build, see GE_ALIGNED_PARTICLES.
+ * The layout is chosen at build time, so comparing packed and padded vectors takes one build of each.
+ */
+void benchmarkParticleLayout()
+{
+    using namespace GE::Math;
+    using namespace GE::Physics;
+    
+    constexpr unsigned numberOfIntegratedParticles = 1000000;
+    constexpr unsigned numberOfSteps = 20;
+    constexpr unsigned cubeWidth = 24;
+    constexpr unsigned numberOfResolutions = 10;
+    const FReal deltaTime = 1.0f / 60.0f;
+    
+    std::cout << "==== Particle layout: GE_ALIGNED_PARTICLES=" << GE_ALIGNED_PARTICLES << ", " << sizeof(FParticleVector3) << "-byte vectors, "
+              << sizeof(FParticleContact) << "-byte contacts, with " << RealName << " reals ====" << std::endl;
+    std::cout << std::left << std::setw(24) << "Phase" << std::right << std::setw(12) << "Items" << std::setw(12) << "ms" << std::setw(16) << "ns per item" << std::endl;
+    
+    {
+        FParticleStore store;
+        store.reserve(numberOfIntegratedParticles);
+        for (unsigned index = 0; index < numberOfIntegratedParticles; ++index)
+        {
+            store.add();
+            store.getVelocities()[index] = FVector3{(FReal) std::cos(1.3*index), (FReal) std::sin(0.3*index), (FReal) std::cos(2.1*index)};
+            store.getAccumulatedForces()[index] = FVector3{(FReal) std::sin(0.1*index), (FReal) 0.5, (FReal) std::cos(0.9*index)};
+            store.getDampings()[index] = (FReal) 0.99;
+        }
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned step = 0; step < numberOfSteps; ++step)
+        {
+            FParticleBatchIntegrator::integrate(store, deltaTime);
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << std::left << std::setw(24) << "Integration" << std::right << std::setprecision(3)
+                  << std::setw(12) << numberOfIntegratedParticles
+                  << std::setw(12) << elapsed.count() * 1e-6 / numberOfSteps
+                  << std::setw(16) << elapsed.count() / ((double) numberOfSteps * numberOfIntegratedParticles) << std::endl;
+    }
     
+    // A cube of overlapping particles, resolved from the same state every time.
+    FParticleWorld world{64};
     std::vector<FParticle> particles;
+    particles.reserve(cubeWidth*cubeWidth*cubeWidth);
+    for (unsigned index = 0; index < cubeWidth*cubeWidth*cubeWidth; ++index)
+    {
+        FParticle particle = world.createParticle();
+        particle.setPosition(FVector3{(FReal) (0.9 * (index % cubeWidth)), (FReal) (0.9 * (index / (cubeWidth*cubeWidth))), (FReal) (0.9 * ((index / cubeWidth) % cubeWidth))});
+        particle.setVelocity(FVector3{(FReal) std::sin(index), (FReal) std::cos(0.7*index), (FReal) std::sin(1.9*index)});
+        particles.push_back(particle);
+    }
+    FParticleHashGridCollider collider;
+    collider.RestitutionCoefficient = (FReal) 0.3;
+    for (FParticle& particle : particles)
+    {
+        collider.add(&particle, (FReal) 0.5);
+    }
+    std::vector<FParticleContact> generatedContacts(1 << 20);
+    generatedContacts.resize(collider.addContacts(generatedContacts));
+    
+    FParticleStore& store = world.getParticleStore();
+    const std::vector<FParticlePositionVector3> startPositions(store.getPositions().begin(), store.getPositions().end());
+    const std::vector<FParticleVector3> startVelocities(store.getVelocities().begin(), store.getVelocities().end());
+    for (const EParticleContactSolver solver : {EParticleContactSolver::Sequential, EParticleContactSolver::Jacobi, EParticleContactSolver::ColoredGaussSeidel})
+    {
+        FParticleContactResolver resolver{(unsigned) generatedContacts.size() * 2};
+        resolver.setSolver(solver);
+        resolver.setMaxNumberOfSweeps(8);
+        std::vector<FParticleContact> contacts;
+        std::chrono::duration<double, std::nano> elapsed{0.0};
+        unsigned numberOfIterations = 0;
+        for (unsigned resolution = 0; resolution < numberOfResolutions; ++resolution)
+        {
+            std::copy(startPositions.begin(), startPositions.end(), store.getPositions().begin());
+            std::copy(startVelocities.begin(), startVelocities.end(), store.getVelocities().begin());
+            contacts = generatedContacts;
+            const auto start = std::chrono::steady_clock::now();
+            resolver.resolveContacts(contacts, deltaTime);
+            elapsed += std::chrono::steady_clock::now() - start;
+            numberOfIterations += resolver.getNumberOfIterations();
+        }
+        const char* solverName = (solver == EParticleContactSolver::Sequential) ? "Sequential"
+                               : (solver == EParticleContactSolver::Jacobi) ? "Jacobi" : "Colored Gauss-Seidel";
+        std::cout << std::left << std::setw(24) << solverName << std::right << std::setprecision(3)
+                  << std::setw(12) << generatedContacts.size()
+                  << std::setw(12) << elapsed.count() * 1e-6 / numberOfResolutions
+                  << std::setw(16) << elapsed.count() / numberOfIterations << std::endl;
+    }
+    std::cout << "=============================================" << std::endl;
+}
+
+/**
+ * Simulates many copies of two problems with known solutions, and reports the error of the integration method against its cost:
+ * a projectile under a uniform acceleration field, and a particle orbiting an anchor on a zero-length spring, i.e. a harmonic oscillator.
+ */
+template<GE::Physics::ParticleIntegrator TParticleIntegrator>
+void benchmarkIntegrator(const char* integratorName, GE::Math::FReal deltaTime)
+{
+    using namespace GE::Math;
+    using namespace GE::Physics;
+    
+    const unsigned numberOfParticles = 1000;
+    const unsigned numberOfSteps = (unsigned) std::lround(5.0 / (double) deltaTime);
+    const FReal finalTime = deltaTime * numberOfSteps;
     
-    struct FFlyingParticle
+    auto measureStepTime = [numberOfSteps, deltaTime](FParticleWorld& world)
     {
-        size_t particleIndex;
-        FVector3 InitialPosition;
-        FVector3 InitialVelocity;
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned step = 0; step < numberOfSteps; ++step)
+        {
+            world.startFrame();
+            world.runPhysics<TParticleIntegrator>(deltaTime);
+        }
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / numberOfSteps;
     };
-    std::optional<FFlyingParticle> flyingParticle{std::nullopt};
     
-    // Add a dummy particle.
+    // Projectile.
+    const FPositionVector3 initialPosition{5.2, 2.0, 9.2};
+    const FVector3 initialVelocity{3.0, 5.5, -4.0f};
+    const FVector3 gravityVector{0.03, -10.0, 0.2};
+    FReal projectileError = Zero;
+    double projectileStepTime = 0.0;
     {
-        flyingParticle = FFlyingParticle
+        FParticleWorld world{0};
+        world.addUniformAccelerationField(gravityVector);
+        std::vector<FParticle> particles;
+        for (unsigned index = 0; index < numberOfParticles; ++index)
         {
-            .InitialPosition = {5.2, 2.0, 9.2},
-            .InitialVelocity = {3.0, 5.5, -4.0f},
+            FParticle particle = world.createParticle();
+            particle.setMass(1.0f);
+            particle.setPosition(initialPosition);
+            particle.setVelocity(initialVelocity);
+            particles.push_back(particle);
+        }
+        
+        projectileStepTime = measureStepTime(world);
+        
+        const FPositionVector3 finalPosition = initialPosition + initialVelocity*finalTime + gravityVector*(finalTime*finalTime / (FReal)2.0);
+        projectileError = (finalPosition - particles.front().getPosition()).magnitude() / finalPosition.magnitude() * 100.0;
+    }
+    
+    // Harmonic oscillator.
+    const FReal springConstant = 40.0;
+    const FVector3 initialOffset{1.0, 0.0, 0.0};
+    const FVector3 initialOrbitVelocity{0.0, 2.0, 0.0};
+    FReal oscillatorError = Zero;
+    double oscillatorStepTime = 0.0;
+    {
+        FParticleWorld world{0};
+        std::vector<FParticle> particles;
+        auto anchor = std::make_shared<FParticle>(world.createParticle());
+        anchor->setInverseMass(Zero);
+        FParticleSpringGenerator spring{anchor, springConstant, Zero};
+        for (unsigned index = 0; index < numberOfParticles; ++index)
+        {
+            FParticle particle = world.createParticle();
+            particle.setMass(1.0f);
+            particle.setPosition(initialOffset);
+            particle.setVelocity(initialOrbitVelocity);
+            particles.push_back(particle);
+        }
+        for (FParticle& particle : particles)
+        {
+            world.getParticleForcePairManager().add(&particle, &spring);
+        }
+        
+        oscillatorStepTime = measureStepTime(world);
+        
+        const FReal angularFrequency = sqrt(springConstant);
+        const double phase = (double) (angularFrequency*finalTime);
+        const FPositionVector3 finalPosition = initialOffset*(FReal) std::cos(phase) + initialOrbitVelocity*((FReal) std::sin(phase) / angularFrequency);
+        oscillatorError = (finalPosition - particles.front().getPosition()).magnitude() / initialOffset.magnitude() * 100.0;
+    }
+    
+    std::cout << std::left << std::setw(20) << integratorName << std::right
+              << std::setw(8) << (unsigned) std::lround(1.0 / (double) deltaTime)
+              << std::setw(8) << TParticleIntegrator::NumberOfStages
+              << std::setw(12) << std::setprecision(4) << projectileError
+              << std::setw(12) << projectileStepTime
+              << std::setw(12) << oscillatorError
+              << std::setw(12) << oscillatorStepTime << std::endl;
+}
+
+void benchmarkIntegrators()
+{
+    using namespace GE::Physics;
+    
+    std::cout << "==== Integrators: error against cost, " << 1000 << " particles over 5s, with " << GE::Math::RealName << " reals and "
+              << 8*sizeof(GE::Math::FPositionReal) << "-bit positions, see Precision.hpp ====" << std::endl;
+    std::cout << std::left << std::setw(20) << "Integrator" << std::right
+              << std::setw(8) << "Hz" << std::setw(8) << "Forces"
+              << std::setw(12) << "Proj. err%" << std::setw(12) << "Proj. us"
+              << std::setw(12) << "Osc. err%" << std::setw(12) << "Osc. us" << std::endl;
+    for (const GE::Math::FReal deltaTime : {1.0f / 30.0f, 1.0f / 120.0f})
+    {
+        benchmarkIntegrator<FParticleExplicitEulerIntegrator>("Explicit Euler", deltaTime);
+        benchmarkIntegrator<FParticleSemiImplicitEulerIntegrator>("Semi-implicit Euler", deltaTime);
+        benchmarkIntegrator<FParticlePositionVerletIntegrator>("Position Verlet", deltaTime);
+        benchmarkIntegrator<FParticleVelocityVerletIntegrator>("Velocity Verlet", deltaTime);
+        benchmarkIntegrator<FParticleRungeKutta4Integrator>("Runge-Kutta 4", deltaTime);
+    }
+    std::cout << "=============================================" << std::endl;
+}
+
+/**
+ * Churns 10% of a million force pairs per frame, removing them through their handles and adding as many to random particles,
+ * then updates the forces, with each dispatch, without and with a job system. Three quarters of the pairs are gravity, the rest springs.
+ * Checks that the job system gives the same forces as the calling thread alone after the churn.
+ *
+ * @return Whether the forces matched for every dispatch.
+ */
+bool benchmarkForcePairChurn()
+{
+    using namespace GE::Math;
+    using namespace GE::Physics;
+    
+    constexpr size_t NumberOfPairs = 1000000;
+    constexpr size_t NumberOfParticles = NumberOfPairs / 4;
+    constexpr size_t NumberOfChurnedPairs = NumberOfPairs / 10;
+    constexpr unsigned NumberOfFrames = 10;
+    
+    FParticleWorld world{4};
+    std::vector<FParticle> particles;
+    particles.reserve(NumberOfParticles);
+    for (size_t index = 0; index < NumberOfParticles; ++index)
+    {
+        particles.push_back(world.createParticle());
+        particles.back().setPosition(FVector3{(FReal) std::sin(index), (FReal) std::cos(0.7*index), (FReal) std::sin(1.9*index)});
+    }
+    std::vector<FParticleGravityGenerator> gravityGenerators;
+    for (int index = 1; index <= 3; ++index)
+    {
+        gravityGenerators.emplace_back(FVector3{0.0, (FReal) -index, 0.0});
+    }
+    std::vector<std::unique_ptr<FParticleSpringGenerator>> springGenerators;
+    for (size_t index = 0; index < 16; ++index)
+    {
+        springGenerators.push_back(std::make_unique<FParticleSpringGenerator>(std::make_shared<FParticle>(particles[index]), (FReal) 2.0, (FReal) 0.5));
+    }
+    auto getGenerator = [&](size_t pairIndex) -> FParticleForceGenerator*
+    {
+        return (pairIndex % 4 < 3) ? static_cast<FParticleForceGenerator*>(&gravityGenerators[pairIndex % 4]) : springGenerators[pairIndex % 16].get();
+    };
+    
+    GE::Core::FJobSystem jobSystem{3};
+    FParticleForcePairManager& forcePairManager = world.getParticleForcePairManager();
+    auto computeForces = [&](GE::Core::FJobSystem* updateJobSystem)
+    {
+        world.startFrame();
+        if (updateJobSystem)
+        {
+            forcePairManager.updateForces((FReal) 0.01, *updateJobSystem);
+        }
+        else
+        {
+            forcePairManager.updateForces((FReal) 0.01);
+        }
+        const std::span<const FParticleVector3> forces = world.getParticleStore().getAccumulatedForces();
+        return std::vector<FParticleVector3>(forces.begin(), forces.end());
+    };
+    
+    std::cout << "==== Force pairs: ms per frame with " << NumberOfChurnedPairs << " of " << NumberOfPairs << " pairs replaced every frame ====" << std::endl;
+    std::cout << std::left << std::setw(12) << "Dispatch" << std::setw(12) << "Jobs" << std::right
+              << std::setw(12) << "remove()" << std::setw(12) << "add()" << std::setw(16) << "updateForces()" << std::endl;
+    bool areForcesEqual = true;
+    for (const EParticleForceDispatch dispatch : {EParticleForceDispatch::Virtual, EParticleForceDispatch::Bucketed})
+    {
+        for (GE::Core::FJobSystem* updateJobSystem : {(GE::Core::FJobSystem*) nullptr, &jobSystem})
+        {
+            forcePairManager.clear();
+            forcePairManager.setDispatch(dispatch);
+            std::vector<FParticleForcePairHandle> handles;
+            handles.reserve(NumberOfPairs);
+            for (size_t pairIndex = 0; pairIndex < NumberOfPairs; ++pairIndex)
+            {
+                handles.push_back(forcePairManager.add(&particles[pairIndex / 4], getGenerator(pairIndex)));
+            }
+            computeForces(updateJobSystem);
+            
+            std::mt19937 randomEngine{1};
+            double removeTime = 0.0;
+            double addTime = 0.0;
+            double updateTime = 0.0;
+            for (unsigned frame = 0; frame < NumberOfFrames; ++frame)
+            {
+                // Move the churned handles to the back, so the new ones replace them.
+                for (size_t churnIndex = 0; churnIndex < NumberOfChurnedPairs; ++churnIndex)
+                {
+                    const size_t position = NumberOfPairs - 1 - churnIndex;
+                    std::swap(handles[position], handles[std::uniform_int_distribution<size_t>{0, position}(randomEngine)]);
+                }
+                
+                auto start = std::chrono::steady_clock::now();
+                for (size_t churnIndex = 0; churnIndex < NumberOfChurnedPairs; ++churnIndex)
+                {
+                    forcePairManager.remove(handles[NumberOfPairs - 1 - churnIndex]);
+                }
+                std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+                removeTime += elapsed.count();
+                
+                start = std::chrono::steady_clock::now();
+                for (size_t churnIndex = 0; churnIndex < NumberOfChurnedPairs; ++churnIndex)
+                {
+                    const size_t pairIndex = randomEngine() % NumberOfPairs;
+                    handles[NumberOfPairs - 1 - churnIndex] = forcePairManager.add(&particles[pairIndex / 4], getGenerator(pairIndex));
+                }
+                elapsed = std::chrono::steady_clock::now() - start;
+                addTime += elapsed.count();
+                
+                start = std::chrono::steady_clock::now();
+                computeForces(updateJobSystem);
+                elapsed = std::chrono::steady_clock::now() - start;
+                updateTime += elapsed.count();
+            }
+            
+            if (updateJobSystem)
+            {
+                const std::vector<FParticleVector3> forces = computeForces(nullptr);
+                const std::vector<FParticleVector3> jobForces = computeForces(updateJobSystem);
+                areForcesEqual &= std::equal(forces.begin(), forces.end(), jobForces.begin(), [](const FParticleVector3& lhs, const FParticleVector3& rhs)
+                {
+                    return (lhs.X == rhs.X) && (lhs.Y == rhs.Y) && (lhs.Z == rhs.Z);
+                });
+            }
+            
+            std::cout << std::left << std::setw(12) << ((dispatch == EParticleForceDispatch::Virtual) ? "Virtual" : "Bucketed")
+                      << std::setw(12) << (updateJobSystem ? "3 workers" : "none") << std::right << std::setprecision(3)
+                      << std::setw(12) << removeTime / NumberOfFrames
+                      << std::setw(12) << addTime / NumberOfFrames
+                      << std::setw(16) << updateTime / NumberOfFrames << std::endl;
+        }
+    }
+    std::cout << (areForcesEqual ? "Same forces with and without jobs." : "THE FORCES DIFFER WITH JOBS.") << std::endl;
+    std::cout << "=============================================" << std::endl;
+    
+    return areForcesEqual;
+}
+
+/**
+ * Hangs a 64x64 cloth of 1 g particles by its top row, with structural and shear springs, and simulates it for 10 s at 60 Hz with
+ * FParticleSemiImplicitEulerIntegrator, the integrator implicit springs need. Explicit springs use the fewest power-of-two substeps
+ * keeping the cloth bounded, implicit ones a single step per frame. The sag is how far the middle of the bottom row hangs below its rest position:
+ * the damped cloths have come to rest by then, so both integrations must agree on it. Implicit rows report the average number of conjugate
+ * gradient iterations per step, and the number of steps that stopped before reaching the tolerance.
+ */
+void benchmarkSpringNetworks()
+{
+    using namespace GE::Math;
+    using namespace GE::Physics;
+    
+    constexpr int ClothSize = 64;
+    constexpr unsigned NumberOfFrames = 600;
+    const FReal spacing = (FReal) 0.02;
+    
+    struct FResult
+    {
+        bool IsBounded;
+        double FrameTime;
+        double Sag;
+        double NumberOfIterations;
+        unsigned NumberOfUnconvergedSteps;
+    };
+    auto simulate = [&](FReal springConstant, FReal damping, EParticleSpringIntegration integration, unsigned numberOfSubsteps)
+    {
+        FParticleWorld world{4};
+        world.addUniformAccelerationField(FVector3{0.0, -9.8, 0.0});
+        std::vector<FParticle> particles;
+        particles.reserve(ClothSize * ClothSize);
+        for (int row = 0; row < ClothSize; ++row)
+        {
+            for (int column = 0; column < ClothSize; ++column)
+            {
+                FParticle particle = world.createParticle();
+                particle.setPosition(FVector3{column * spacing, -row * spacing, 0.0});
+                particle.setMass((FReal) 0.001);
+                particle.setDamping(damping);
+                if (row == 0)
+                {
+                    particle.setInverseMass(Zero);
+                }
+                particles.push_back(particle);
+            }
+        }
+        
+        FParticleSpringNetwork springNetwork;
+        springNetwork.setIntegration(integration);
+        auto getParticle = [&](int column, int row) -> FParticle& { return particles[row * ClothSize + column]; };
+        const FReal diagonalSpacing = spacing * (FReal) std::sqrt(2.0);
+        for (int row = 0; row < ClothSize; ++row)
+        {
+            for (int column = 0; column < ClothSize; ++column)
+            {
+                if (column + 1 < ClothSize)
+                {
+                    springNetwork.add(getParticle(column, row), getParticle(column + 1, row), springConstant, spacing);
+                }
+                if (row + 1 < ClothSize)
+                {
+                    springNetwork.add(getParticle(column, row), getParticle(column, row + 1), springConstant, spacing);
+                }
+                if ((column + 1 < ClothSize) && (row + 1 < ClothSize))
+                {
+                    springNetwork.add(getParticle(column, row), getParticle(column + 1, row + 1), springConstant, diagonalSpacing);
+                    springNetwork.add(getParticle(column + 1, row), getParticle(column, row + 1), springConstant, diagonalSpacing);
+                }
+            }
+        }
+        world.getParticleSpringNetworks().push_back(&springNetwork);
+        
+        const FReal deltaTime = (FReal) (1.0 / (60.0 * numberOfSubsteps));
+        FResult result{true, 0.0, 0.0, 0.0, 0};
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned frame = 0; (frame < NumberOfFrames) && result.IsBounded; ++frame)
+        {
+            for (unsigned substep = 0; substep < numberOfSubsteps; ++substep)
+            {
+                world.startFrame();
+                world.runPhysics<FParticleSemiImplicitEulerIntegrator>(deltaTime);
+                result.NumberOfIterations += springNetwork.getNumberOfIterations();
+                result.NumberOfUnconvergedSteps += springNetwork.hasConverged() ? 0 : 1;
+            }
+            result.IsBounded = std::all_of(particles.begin(), particles.end(), [](const FParticle& particle)
+            {
+                const FVector3 velocity = particle.getVelocity();
+                return std::isfinite((double) velocity.X) && (velocity.magnitude() < (FReal) 100.0);
+            });
+        }
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        result.FrameTime = elapsed.count() / NumberOfFrames;
+        result.NumberOfIterations /= NumberOfFrames * numberOfSubsteps;
+        result.Sag = -(double) getParticle(ClothSize / 2, ClothSize - 1).getPosition().Y - (ClothSize - 1) * (double) spacing;
+        return result;
+    };
+    
+    std::cout << "==== Spring networks: explicit substeps against one implicit step, " << ClothSize << "x" << ClothSize
+              << " cloth for 10s at 60 Hz, with " << RealName << " reals ====" << std::endl;
+    std::cout << std::left << std::setw(10) << "k (N/m)" << std::setw(10) << "Damping" << std::setw(10) << "Springs" << std::right
+              << std::setw(10) << "Substeps" << std::setw(12) << "ms/frame" << std::setw(12) << "Sag (m)" << std::setw(12) << "CG it." << std::setw(14) << "Unconverged" << std::endl;
+    for (const FReal damping : {(FReal) 0.2, (FReal) 1.0})
+    {
+        for (const FReal springConstant : {(FReal) 50.0, (FReal) 1000.0, (FReal) 20000.0})
+        {
+            FResult explicitResult{};
+            unsigned numberOfSubsteps = 1;
+            for (; numberOfSubsteps <= 1024; numberOfSubsteps *= 2)
+            {
+                explicitResult = simulate(springConstant, damping, EParticleSpringIntegration::Explicit, numberOfSubsteps);
+                if (explicitResult.IsBounded)
+                {
+                    break;
+                }
+            }
+            const FResult implicitResult = simulate(springConstant, damping, EParticleSpringIntegration::Implicit, 1);
+            
+            const auto printRow = [&](const char* integrationName, unsigned substeps, const FResult& result, bool isIterative)
+            {
+                std::cout << std::left << std::setprecision(6) << std::setw(10) << springConstant << std::setw(10) << damping << std::setw(10) << integrationName << std::right
+                          << std::setw(10) << substeps << std::setprecision(3)
+                          << std::setw(12) << result.FrameTime
+                          << std::setw(12) << (result.IsBounded ? result.Sag : std::nan(""));
+                if (isIterative)
+                {
+                    std::cout << std::setw(12) << result.NumberOfIterations << std::setw(14) << result.NumberOfUnconvergedSteps << std::endl;
+                }
+                else
+                {
+                    std::cout << std::setw(12) << "-" << std::setw(14) << "-" << std::endl;
+                }
+            };
+            printRow("Explicit", explicitResult.IsBounded ? numberOfSubsteps : 0, explicitResult, false);
+            printRow("Implicit", 1, implicitResult, true);
+        }
+    }
+    std::cout << "=============================================" << std::endl;
+}
+
+/**
+ * Times the same operations on FVector3 and on FVector3xN packets, over arrays of vectors small enough to stay in the L1 cache.
+ * The vectors are stored as an array of structures for the former, as a structure of arrays for the latter.
+ */
+void benchmarkVector3xN()
+{
+    using namespace GE::Math;
+    
+    constexpr size_t numberOfVectors = 512;
+    constexpr unsigned numberOfRepetitions = 4000;
+    const FReal scale = (FReal) 0.25;
+    static_assert(numberOfVectors % FVector3xN::NumberOfLanes == 0, "The vectors must fill whole packets.");
+    
+    std::vector<FVector3> lhs(numberOfVectors);
+    std::vector<FVector3> rhs(numberOfVectors);
+    std::vector<FVector3> results(numberOfVectors);
+    std::vector<FReal> lhsX(numberOfVectors), lhsY(numberOfVectors), lhsZ(numberOfVectors);
+    std::vector<FReal> rhsX(numberOfVectors), rhsY(numberOfVectors), rhsZ(numberOfVectors);
+    std::vector<FReal> resultsX(numberOfVectors), resultsY(numberOfVectors), resultsZ(numberOfVectors);
+    for (size_t index = 0; index < numberOfVectors; ++index)
+    {
+        // The first vector is zero, so normalize() has a lane to leave unchanged.
+        lhs[index] = (index == 0) ? FVector3::ZeroVector : FVector3{(FReal) std::sin(index), (FReal) std::cos(0.7*index), (FReal) (index % 7) - (FReal) 3.0};
+        rhs[index] = FVector3{(FReal) std::cos(1.3*index), (FReal) (index % 5) - (FReal) 2.0, (FReal) std::sin(0.3*index)};
+        lhsX[index] = lhs[index].X; lhsY[index] = lhs[index].Y; lhsZ[index] = lhs[index].Z;
+        rhsX[index] = rhs[index].X; rhsY[index] = rhs[index].Y; rhsZ[index] = rhs[index].Z;
+    }
+    
+    auto measureTimePerVector = [](const auto& kernel)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned repetition = 0; repetition < numberOfRepetitions; ++repetition)
+        {
+            kernel();
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / (numberOfRepetitions * numberOfVectors);
+    };
+    
+    // Runs both kernels, then checks that they agree.
+    auto compare = [&](const char* operationName, const auto& scalarKernel, const auto& packetKernel)
+    {
+        std::fill(results.begin(), results.end(), FVector3::ZeroVector);
+        std::fill(resultsX.begin(), resultsX.end(), Zero);
+        std::fill(resultsY.begin(), resultsY.end(), Zero);
+        std::fill(resultsZ.begin(), resultsZ.end(), Zero);
+        const double scalarTime = measureTimePerVector(scalarKernel);
+        const double packetTime = measureTimePerVector(packetKernel);
+        
+        FReal maxDifference = Zero;
+        for (size_t index = 0; index < numberOfVectors; ++index)
+        {
+            maxDifference = std::max(maxDifference, (results[index] - FVector3{resultsX[index], resultsY[index], resultsZ[index]}).magnitude());
+        }
+        
+        std::cout << std::left << std::setw(20) << operationName << std::right << std::setprecision(3)
+                  << std::setw(12) << scalarTime
+                  << std::setw(12) << packetTime
+                  << std::setw(12) << scalarTime / packetTime
+                  << std::setw(12) << maxDifference << std::endl;
+    };
+    
+    std::cout << "==== FVector3 against FVector3xN: ns per vector, " << FVector3xN::NumberOfLanes << " lanes of " << RealName << " reals with "
+              << getInstructionSetName(FSimdBackend::InstructionSet) << " ====" << std::endl;
+    std::cout << std::left << std::setw(20) << "Operation" << std::right
+              << std::setw(12) << "FVector3" << std::setw(12) << "FVector3xN"
+              << std::setw(12) << "Speedup" << std::setw(12) << "Max diff." << std::endl;
+    
+    compare("addScaledVector",
+        [&]
+        {
+            for (size_t index = 0; index < numberOfVectors; ++index)
+            {
+                results[index] = lhs[index];
+                results[index].addScaledVector(scale, rhs[index]);
+            }
+        },
+        [&]
+        {
+            for (size_t index = 0; index < numberOfVectors; index += FVector3xN::NumberOfLanes)
+            {
+                FVector3xN result = FVector3xN::load(&lhsX[index], &lhsY[index], &lhsZ[index]);
+                result.addScaledVector(scale, FVector3xN::load(&rhsX[index], &rhsY[index], &rhsZ[index]));
+                result.store(&resultsX[index], &resultsY[index], &resultsZ[index]);
+            }
+        });
+    
+    compare("Dot product",
+        [&]
+        {
+            for (size_t index = 0; index < numberOfVectors; ++index)
+            {
+                results[index].X = lhs[index] | rhs[index];
+            }
+        },
+        [&]
+        {
+            for (size_t index = 0; index < numberOfVectors; index += FVector3xN::NumberOfLanes)
+            {
+                const FRealN result = FVector3xN::load(&lhsX[index], &lhsY[index], &lhsZ[index]) | FVector3xN::load(&rhsX[index], &rhsY[index], &rhsZ[index]);
+                result.store(&resultsX[index]);
+            }
+        });
+    
+    compare("Cross product",
+        [&]
+        {
+            for (size_t index = 0; index < numberOfVectors; ++index)
+            {
+                results[index] = lhs[index] ^ rhs[index];
+            }
+        },
+        [&]
+        {
+            for (size_t index = 0; index < numberOfVectors; index += FVector3xN::NumberOfLanes)
+            {
+                const FVector3xN result = FVector3xN::load(&lhsX[index], &lhsY[index], &lhsZ[index]) ^ FVector3xN::load(&rhsX[index], &rhsY[index], &rhsZ[index]);
+                result.store(&resultsX[index], &resultsY[index], &resultsZ[index]);
+            }
+        });
+    
+    compare("normalize",
+        [&]
+        {
+            for (size_t index = 0; index < numberOfVectors; ++index)
+            {
+                results[index] = lhs[index];
+                results[index].normalize();
+            }
+        },
+        [&]
+        {
+            for (size_t index = 0; index < numberOfVectors; index += FVector3xN::NumberOfLanes)
+            {
+                FVector3xN result = FVector3xN::load(&lhsX[index], &lhsY[index], &lhsZ[index]);
+                result.normalize();
+                result.store(&resultsX[index], &resultsY[index], &resultsZ[index]);
+            }
+        });
+    std::cout << "=============================================" << std::endl;
+}
+
+/**
+ * Times each accuracy of normalize(), vector by vector and through normalize(std::span<FVector3>), and measures its error against a double precision reference.
+ * The vectors' lengths span six orders of magnitude, the first one being zero.
+ */
+void benchmarkNormalization()
+{
+    using namespace GE::Math;
+    
+    constexpr size_t numberOfVectors = 512;
+    constexpr unsigned numberOfRepetitions = 4000;
+    
+    std::vector<FVector3> vectors(numberOfVectors);
+    std::vector<FVector3> results(numberOfVectors);
+    for (size_t index = 1; index < numberOfVectors; ++index)
+    {
+        const double length = std::pow(10.0, 6.0 * index / numberOfVectors - 3.0);
+        vectors[index] = FVector3{(FReal) (length * std::sin(index)), (FReal) (length * std::cos(0.7*index)), (FReal) (length * std::sin(1.9*index))};
+    }
+    vectors[0] = FVector3::ZeroVector;
+    
+    auto measure = [&](const char* name, const auto& kernel)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned repetition = 0; repetition < numberOfRepetitions; ++repetition)
+        {
+            results = vectors;
+            kernel();
+        }
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        
+        // The error of a unit vector is both absolute and relative.
+        double maxError = 0.0;
+        for (size_t index = 1; index < numberOfVectors; ++index)
+        {
+            const TVector3<double> vector{vectors[index]};
+            const TVector3<double> reference = vector * (1.0 / vector.magnitude());
+            maxError = std::max(maxError, (TVector3<double>{results[index]} - reference).magnitude());
+        }
+        
+        std::cout << std::left << std::setw(20) << name << std::right << std::setprecision(3)
+                  << std::setw(12) << elapsed.count() / (numberOfRepetitions * numberOfVectors)
+                  << std::setw(12) << maxError << std::endl;
+    };
+    
+    std::cout << "==== normalize(): ns per vector, " << RealName << " reals with " << getInstructionSetName(FSimdBackend::InstructionSet) << " ====" << std::endl;
+    std::cout << std::left << std::setw(20) << "Accuracy" << std::right << std::setw(12) << "Time" << std::setw(12) << "Max error" << std::endl;
+    
+    measure("Exact", [&]
+    {
+        for (FVector3& result : results)
+        {
+            result.normalize();
+        }
+    });
+    measure("Fast", [&]
+    {
+        for (FVector3& result : results)
+        {
+            result.normalize(ENormalization::Fast);
+        }
+    });
+    measure("Exact, span", [&] { normalize(std::span<FVector3>{results}, ENormalization::Exact); });
+    measure("Fast, span", [&] { normalize(std::span<FVector3>{results}, ENormalization::Fast); });
+    std::cout << "=============================================" << std::endl;
+}
+
+/**
+ * Stresses the job system with trees of nested jobs, checks that an exception thrown deep in a tree is rethrown by wait(),
+ * and times the creation and execution of empty jobs, for several numbers of workers.
+ *
+ * @return Whether every job ran and the exception was rethrown.
+ */
+bool benchmarkJobSystem()
+{
+    using namespace GE::Core;
+    
+    constexpr unsigned numberOfChildren = 4;
+    constexpr unsigned depth = 7;
+    constexpr unsigned numberOfLeaves = 16384;
+    constexpr unsigned numberOfTrees = 20;
+    constexpr unsigned numberOfEmptyJobs = 200000;
+    
+    std::cout << "==== Job system: " << numberOfTrees << " trees of " << numberOfLeaves << " nested jobs, and ns per empty job ====" << std::endl;
+    std::cout << std::left << std::setw(12) << "Workers" << std::setw(12) << "Trees" << std::setw(12) << "Exception" << std::right << std::setw(12) << "ns/job" << std::endl;
+    bool isCorrect = true;
+    for (const unsigned numberOfWorkers : {0u, 1u, 3u, 7u, 31u})
+    {
+        FJobSystem jobSystem{numberOfWorkers};
+        
+        // Jobs spawned by a job are its children, so waiting for the root waits for the whole tree.
+        std::atomic<unsigned> numberOfLeavesRun{0};
+        std::function<void(unsigned)> spawn = [&](unsigned level)
+        {
+            if (level == depth)
+            {
+                numberOfLeavesRun.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            for (unsigned child = 0; child < numberOfChildren; ++child)
+            {
+                jobSystem.run([&spawn, level]{ spawn(level + 1); });
+            }
         };
+        bool areTreesComplete = true;
+        for (unsigned tree = 0; tree < numberOfTrees; ++tree)
+        {
+            numberOfLeavesRun = 0;
+            FJobCounter counter;
+            jobSystem.run([&]{ spawn(0); }, &counter);
+            jobSystem.wait(counter);
+            areTreesComplete = areTreesComplete && (numberOfLeavesRun == numberOfLeaves);
+        }
         
-        FParticle particle{};
+        // The throwing job has no counter of its own, so the exception goes to its parent's one.
+        bool isExceptionRethrown = false;
+        {
+            FJobCounter counter;
+            jobSystem.run([&]{ jobSystem.run([]{ throw std::runtime_error{"Job failure."}; }); }, &counter);
+            try
+            {
+                jobSystem.wait(counter);
+            }
+            catch (const std::runtime_error&)
+            {
+                isExceptionRethrown = true;
+            }
+        }
+        
+        std::atomic<unsigned> numberOfEmptyJobsRun{0};
+        FJobCounter counter;
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned job = 0; job < numberOfEmptyJobs; ++job)
+        {
+            jobSystem.run([&]{ numberOfEmptyJobsRun.fetch_add(1, std::memory_order_relaxed); }, &counter);
+        }
+        jobSystem.wait(counter);
+        const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        areTreesComplete = areTreesComplete && (numberOfEmptyJobsRun == numberOfEmptyJobs);
+        isCorrect = isCorrect && areTreesComplete && isExceptionRethrown;
+        
+        std::cout << std::left << std::setw(12) << numberOfWorkers
+                  << std::setw(12) << (areTreesComplete ? "complete" : "INCOMPLETE!")
+                  << std::setw(12) << (isExceptionRethrown ? "rethrown" : "LOST!")
+                  << std::right << std::setw(12) << std::setprecision(4) << elapsed.count() / numberOfEmptyJobs << std::endl;
+    }
+    std::cout << "=============================================" << std::endl;
+    return isCorrect;
+}
+
+/**
+ * Times the parallel phases of FParticleWorld, clearing the forces in startFrame(), updating the force pairs and integrating,
+ * on 1 thread up to the number of hardware threads, and reports each phase's speedup over 1 thread.
+ * The force pairs live in a manager of their own, so that integrate() only integrates.
+ */
+void benchmarkWorldScaling()
+{
+    using namespace GE::Math;
+    using namespace GE::Physics;
+    
+    constexpr unsigned numberOfParticles = 1 << 18;
+    constexpr unsigned numberOfFrames = 50;
+    const FReal deltaTime = 1.0f / 60.0f;
+    const unsigned numberOfHardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    
+    std::vector<unsigned> threadCounts;
+    for (unsigned numberOfThreads = 1; numberOfThreads < numberOfHardwareThreads; numberOfThreads *= 2)
+    {
+        threadCounts.push_back(numberOfThreads);
+    }
+    threadCounts.push_back(numberOfHardwareThreads);
+    
+    std::cout << "==== World phases: " << numberOfParticles << " particles with a gravity pair each, ms per frame over " << numberOfFrames
+              << " frames and speedup over 1 thread, with " << RealName << " reals ====" << std::endl;
+    std::cout << std::left << std::setw(10) << "Threads" << std::right
+              << std::setw(14) << "startFrame" << std::setw(10) << "speedup"
+              << std::setw(14) << "Force pairs" << std::setw(10) << "speedup"
+              << std::setw(14) << "integrate" << std::setw(10) << "speedup" << std::endl;
+    double singleThreadTimes[3] = {0.0, 0.0, 0.0};
+    for (const unsigned numberOfThreads : threadCounts)
+    {
+        GE::Core::FJobSystem jobSystem{numberOfThreads - 1};
+        FParticleWorld world{64};
+        world.setJobSystem(&jobSystem);
+        
+        FParticleGravityGenerator gravity{FVector3{0.0, -9.8, 0.0}};
+        FParticleForcePairManager forcePairs;
+        forcePairs.setDispatch(EParticleForceDispatch::Bucketed);
+        std::vector<FParticle> particles;
+        particles.reserve(numberOfParticles);
+        for (unsigned index = 0; index < numberOfParticles; ++index)
+        {
+            FParticle particle = world.createParticle();
+            particle.setPosition(FVector3{(FReal) (index % 512), (FReal) (index / 512), Zero});
+            particle.setDamping(0.99f);
+            particles.push_back(particle);
+        }
+        for (FParticle& particle : particles)
+        {
+            forcePairs.add(&particle, &gravity);
+        }
+        
+        // The first frame groups the pairs and sizes the buffers, so it is not timed.
+        double times[3] = {0.0, 0.0, 0.0};
+        for (unsigned frame = 0; frame <= numberOfFrames; ++frame)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            world.startFrame();
+            const auto startFrameEnd = std::chrono::steady_clock::now();
+            forcePairs.updateForces(deltaTime, jobSystem);
+            const auto forcePairsEnd = std::chrono::steady_clock::now();
+            world.integrate<FParticleSemiImplicitEulerIntegrator>(deltaTime);
+            const auto integrateEnd = std::chrono::steady_clock::now();
+            if (frame > 0)
+            {
+                times[0] += std::chrono::duration<double, std::milli>(startFrameEnd - start).count();
+                times[1] += std::chrono::duration<double, std::milli>(forcePairsEnd - startFrameEnd).count();
+                times[2] += std::chrono::duration<double, std::milli>(integrateEnd - forcePairsEnd).count();
+            }
+        }
+        if (numberOfThreads == 1)
+        {
+            std::copy(std::begin(times), std::end(times), std::begin(singleThreadTimes));
+        }
+        
+        std::cout << std::left << std::setw(10) << numberOfThreads << std::right << std::setprecision(3);
+        for (unsigned phase = 0; phase < 3; ++phase)
+        {
+            std::cout << std::setw(14) << times[phase] / numberOfFrames << std::setw(10) << singleThreadTimes[phase] / times[phase];
+        }
+        std::cout << std::endl;
+    }
+    std::cout << "=============================================" << std::endl;
+}
+
+/**
+ * Simulates the same scene, a cloth hanging over a bed of particles, for 10000 frames in deterministic mode on 1, 2, 8 and 32 threads,
+ * and checks that the final states are bit-identical. The last run has the calling thread round upwards, which must not change the results either.
+ * It also times the frames, to compare precisions, see Precision.hpp.
+ *
+ * @return Whether all the final states are bit-identical.
+ */
+bool checkDeterminism()
+{
+    using namespace GE::Math;
+    using namespace GE::Physics;
+    
+    constexpr unsigned numberOfFrames = 10000;
+    constexpr unsigned clothWidth = 16;
+    const FReal deltaTime = 1.0f / 60.0f;
+    
+    // The scene is built with the default rounding mode, only the simulation runs with the given one.
+    auto simulate = [&](unsigned numberOfThreads, int roundingMode)
+    {
+        GE::Core::FJobSystem jobSystem{numberOfThreads - 1};
+        FParticleWorld world{64};
+        world.setJobSystem(&jobSystem);
+        world.setDeterministic(true);
+        world.setContactSolver(EParticleContactSolver::Jacobi, 8);
+        world.setContactWarmStartFactor(0.5f);
+        world.addUniformAccelerationField(FVector3{0.0, -9.8, 0.0});
+        
+        std::vector<FParticle> particles;
+        particles.reserve(clothWidth*clothWidth + 64);
+        for (unsigned y = 0; y < clothWidth; ++y)
+        {
+            for (unsigned x = 0; x < clothWidth; ++x)
+            {
+                FParticle particle = world.createParticle();
+                particle.setMass(0.1f);
+                particle.setDamping(0.99f);
+                particle.setPosition(FVector3{x*0.5f, 4.0f + y*0.05f, y*0.5f});
+                if ((y == 0) && ((x == 0) || (x + 1 == clothWidth)))
+                {
+                    // Hang the cloth by two corners.
+                    particle.setInverseMass(Zero);
+                }
+                particles.push_back(particle);
+            }
+        }
+        for (unsigned index = 0; index < 64; ++index)
+        {
+            FParticle particle = world.createParticle();
+            particle.setInverseMass(Zero);
+            particle.setPosition(FVector3{(index % 8)*1.0f + 0.3f, 0.0f, (index / 8)*1.0f + 0.3f});
+            particles.push_back(particle);
+        }
+        
+        FParticleSpringNetwork cloth;
+        for (unsigned y = 0; y < clothWidth; ++y)
+        {
+            for (unsigned x = 0; x < clothWidth; ++x)
+            {
+                const unsigned index = y*clothWidth + x;
+                if (x + 1 < clothWidth)
+                {
+                    cloth.add(particles[index], particles[index + 1], 20.0f, 0.5f);
+                }
+                if (y + 1 < clothWidth)
+                {
+                    cloth.add(particles[index], particles[index + clothWidth], 20.0f, 0.5f);
+                }
+            }
+        }
+        world.getParticleSpringNetworks().push_back(&cloth);
+        
+        FParticleHashGridCollider collider;
+        collider.RestitutionCoefficient = 0.3f;
+        for (FParticle& particle : particles)
+        {
+            collider.add(&particle, 0.2f);
+        }
+        world.getParticleContactGenerators().push_back(&collider);
+        
+        const int defaultRoundingMode = std::fegetround();
+        std::fesetround(roundingMode);
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned frame = 0; frame < numberOfFrames; ++frame)
+        {
+            world.startFrame();
+            world.runPhysics<FParticleSemiImplicitEulerIntegrator>(deltaTime);
+        }
+        const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        std::fesetround(defaultRoundingMode);
+        return std::make_pair(world.computeStateHash(), elapsed.count() / numberOfFrames);
+    };
+    
+    std::cout << "==== Determinism: state hash after " << numberOfFrames << " frames, with " << RealName << " reals ====" << std::endl;
+    std::cout << std::left << std::setw(28) << "Run" << std::setw(20) << "Hash" << std::right << std::setw(12) << "us/frame" << std::endl;
+    const std::pair<uint64_t, double> reference = simulate(1, FE_TONEAREST);
+    bool isDeterministic = true;
+    auto report = [&](const char* name, const std::pair<uint64_t, double>& result)
+    {
+        isDeterministic = isDeterministic && (result.first == reference.first);
+        std::cout << std::left << std::setw(28) << name << std::setw(20) << std::hex << result.first << std::dec
+                  << std::right << std::setw(12) << std::setprecision(4) << result.second << std::endl;
+    };
+    report("1 thread", reference);
+    report("2 threads", simulate(2, FE_TONEAREST));
+    report("8 threads", simulate(8, FE_TONEAREST));
+    report("32 threads", simulate(32, FE_TONEAREST));
+    report("8 threads, rounding upwards", simulate(8, FE_UPWARD));
+    
+    std::cout << (isDeterministic? "Bit-identical." : "MISMATCH!") << std::endl;
+    std::cout << "=============================================" << std::endl;
+    return isDeterministic;
+}
+
+void updatePhysics(bool& isPhysicsEnabled, GE::Core::FJobSystem& jobSystem)
+{
+    using namespace GE::Math;
+    using namespace GE::Physics;
+    
+    FReal timeSinceStart = 0.0f;
+    FReal deltaTime = 1.0f / 60.0f;
+    
+    // BEG - World setup.
+    const unsigned initialNumberOfContacts = 20;
+    FParticleWorld world{initialNumberOfContacts};
+    world.setJobSystem(&jobSystem);
+    
+    std::vector<FParticle> particles;
+    
+    // Add a dummy particle.
+    {
+        FParticle particle = world.createParticle();
         particle.setMass(1.0f);
-        particle.setPosition(flyingParticle->InitialPosition);
-        particle.setVelocity(flyingParticle->InitialVelocity);
+        particle.setPosition(FVector3{5.2, 2.0, 9.2});
+        particle.setVelocity(FVector3{3.0, 5.5, -4.0f});
         particles.push_back(std::move(particle));
-        flyingParticle->particleIndex = particles.size() - 1;
     }
     
     // Add a dummy particle.
     {
-        FParticle particle{};
+        FParticle particle = world.createParticle();
         particle.setInverseMass(Zero);  // Immovable particle.
         particles.push_back(std::move(particle));
     }
@@ -65,20 +1429,9 @@ void updatePhysics(bool& isPhysicsEnabled)
         debugParticle(p);
     }
     
-    // Force generators.
+    // Uniform acceleration fields.
     const FVector3 gravityVector{0.03, -10.0, 0.2};
-    FParticleGravityGenerator gravityGenerator{gravityVector};
-    
-    // BEG - World setup.
-    const unsigned maxNumberOfContacts = 20;
-    FParticleWorld world{maxNumberOfContacts};
-    std::vector<FParticle*>& worldParticles = world.getParticles();
-    
-    for (auto& p : particles)
-    {
-        worldParticles.push_back(&p);
-        world.getParticleForcePairManager().add(&p, &gravityGenerator);
-    }
+    world.addUniformAccelerationField(gravityVector);
     // END - World setup.
     
     // BEG - Run simulation.
@@ -99,28 +1452,53 @@ void updatePhysics(bool& isPhysicsEnabled)
         debugParticle(p);
     }
     
-    // Analytical solution comparison.
-    if (flyingParticle != std::nullopt)
-    {
-        auto analyticalFlightSolution = [](FVector3 pos, FVector3 vel, FVector3 acc, FReal finalTime)
-        {
-            return pos + vel*finalTime + acc*(finalTime*finalTime / (FReal)2.0);
-        };
-        
-        const FVector3 finalPositional = analyticalFlightSolution(flyingParticle->InitialPosition, flyingParticle->InitialVelocity, gravityVector, timeSinceStart);
-        const FParticle& engineFlyingParticle = particles[flyingParticle->particleIndex];
-        const FVector3 diffVector = finalPositional - engineFlyingParticle.getPosition();
-        const FReal error = diffVector.magnitude() / finalPositional.magnitude() * 100.0;
-        std::cout << "==== Comparison with analytical solution ====" << std::endl;
-        std::cout << "Analytical position: " << finalPositional << std::endl;
-        std::cout << "Relative error: " << error << "%" << std::endl;
-        assert(error < 2.0);        // Error should be below this percentage!
-        std::cout << "=============================================" << std::endl;
-    }
-    
     std::cout << "The physics engine has run for " << timeSinceStart << "s.\n";
 }
 
+/**
+ * Runs the benchmarks and checks of the physics engine, instead of the application.
+ *
+ * @return Whether all the checks passed.
+ */
+bool runBenchmarks()
+{
+    // Scheduling overhead and stress test of the job system.
+    const bool isJobSystemCorrect = benchmarkJobSystem();
+    
+    // Scaling of the parallel world phases with the number of threads.
+    benchmarkWorldScaling();
+    
+    // Scalar against batch integration of the particle store.
+    benchmarkBatchIntegrator();
+    
+    // Broadphases against brute force.
+    const bool areCollidersCorrect = benchmarkColliders();
+    
+    // Resting stacks, with and without warm starting the contacts.
+    benchmarkContactWarmStarting();
+    
+    // Packed against padded particle vectors, one build of each.
+    benchmarkParticleLayout();
+    
+    // Integration methods compared with analytical solutions.
+    benchmarkIntegrators();
+    
+    // Adding and removing force pairs while the simulation runs.
+    const bool areForcePairsCorrect = benchmarkForcePairChurn();
+    
+    // Stiff springs, substepped against integrated implicitly.
+    benchmarkSpringNetworks();
+    
+    // Batch math, scalar against packets.
+    benchmarkVector3xN();
+    benchmarkNormalization();
+    
+    // Thread-count independence of the simulation.
+    const bool isDeterministic = checkDeterminism();
+    
+    return isJobSystemCorrect && areCollidersCorrect && areForcePairsCorrect && isDeterministic;
+}
+
 template<class T = decltype(std::chrono::high_resolution_clock::now())>
 class FStopwatch
 {
@@ -149,14 +1527,22 @@ public:
     std::chrono::duration<float> Elapsed;
 };
 
-int main()
+int main(int argc, char* argv[])
 {
+    // "--benchmark" runs the physics benchmarks and checks, and fails if a check does.
+    if ((argc > 1) && (std::string_view{argv[1]} == "--benchmark"))
+    {
+        return runBenchmarks() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
     try
     {
         FStopwatch stopwatch{};
         bool isPhysicsEnabled = true;
-        std::thread physicsThread(updatePhysics, std::ref(isPhysicsEnabled));
-        GE::Vulkan::FApplication application{};
+        GE::Core::FJobSystem jobSystem{};
+        // The physics loop lasts as long as the application, so it gets its own thread rather than a job, see FJobSystem.
+        std::thread physicsThread(updatePhysics, std::ref(isPhysicsEnabled), std::ref(jobSystem));
+        GE::Vulkan::FApplication application{&jobSystem};
         application.run();
         isPhysicsEnabled = false;
         physicsThread.join();